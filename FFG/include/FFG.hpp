@@ -1,14 +1,27 @@
 #ifndef FFG_H_INCLUDED
 #define FFG_H_INCLUDED
 
+#include "FFG_CachedLayer.hpp"
 #include "FFG_Constants.hpp"
 #include "FFG_Engine.hpp"
 #include "FFG_Event.hpp"
+#include "FFG_FrameCapture.hpp"
+#include "FFG_Map.hpp"
+#include "FFG_MapHex.hpp"
+#include "FFG_Pack.hpp"
+#include "FFG_PixelOps.hpp"
+#include "FFG_QuadTree.hpp"
+#include "FFG_RawImage.hpp"
 #include "FFG_Rect.hpp"
 #include "FFG_Renderer.hpp"
+#include "FFG_SpatialGrid.hpp"
+#include "FFG_SpatialIndex.hpp"
+#include "FFG_SpriteCompositor.hpp"
 #include "FFG_State.hpp"
 #include "FFG_StateManager.hpp"
 #include "FFG_Texture.hpp"
+#include "FFG_TextureAtlas.hpp"
+#include "FFG_TextureStream.hpp"
 #include "FFG_Timer.hpp"
 
 #endif // FFG_H_INCLUDED
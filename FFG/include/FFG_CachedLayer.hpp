@@ -0,0 +1,66 @@
+#ifndef FFG_CACHEDLAYER_H_INCLUDED
+#define FFG_CACHEDLAYER_H_INCLUDED
+
+#include <functional>
+#include "FFG_Constants.hpp"
+#include "FFG_Rect.hpp"
+#include "FFG_Texture.hpp"
+class FFG_Renderer;
+
+/***************************************************************************//**
+ * Cached layer representation. Owns a draw-toable texture and a callback that
+ * redraws its contents. The layer is only redrawn when it is invalidated, so
+ * a static background or HUD panel costs one copy per frame. Layers are added
+ * to and removed from the engine using:
+ *
+ *   - FFG_Renderer::add_layer()
+ *   - FFG_Renderer::remove_layer()
+ *
+ * Added layers are composited by the engine every frame in order of their z
+ * value. Layers with a negative z are drawn before the current state renders,
+ * and so should only be used by states that do not clear the screen. The rest
+ * are drawn after the current state renders. While drawing is deferred, layers
+ * are recorded on deferred layer 0 or FFG_RENDERER_MAX_LAYER, so the state
+ * should draw on the layers between. Mark a layer as needing to be redrawn
+ * using:
+ *
+ *   - FFG_CachedLayer::invalidate()
+ *
+ * When a dirty layer is composited, its texture is made the render target and
+ * cleared to transparent before the callback is called, and the previous render
+ * target is restored afterward. All layers are invalidated when the renderer
+ * reports that the contents of render targets were lost.
+ *
+ * Example usage:
+ * -----------------------------------------------------------------------------
+ * TODO: Add example usage.
+ * -----------------------------------------------------------------------------
+ ******************************************************************************/
+class FFG_CachedLayer {
+private:
+	friend class FFG_Renderer;
+private:
+	FFG_Texture texture;
+	std::function<void()> redraw;
+	FFG_Rect area;
+	FFG_Rect moved_from;    // The area the layer was last composited at, if moved.
+	int z_p;
+	bool dirty;
+	bool moved;
+public:
+	// CONSTRUCTION:
+	FFG_CachedLayer();
+	FFG_CachedLayer(const int width, const int height, const std::function<void()>& redraw, const int z = 0);
+	// SETTERS:
+	void set(const int width, const int height, const std::function<void()>& redraw);
+	void set_position(const int x, const int y);
+	void set_z(const int z);
+	void invalidate();
+	// INFO:
+	bool is_dirty() const;
+	int z() const;
+	const FFG_Rect& get_area() const;
+	FFG_Texture& get_texture();
+};
+
+#endif // FFG_CACHEDLAYER_H_INCLUDED
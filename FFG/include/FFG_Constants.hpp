@@ -11,6 +11,60 @@
 #define FFG_RENDERER_DEFAULT_WIDTH 800
 #define FFG_RENDERER_DEFAULT_HEIGHT 600
 #define FFG_RENDERER_DEFAULT_VSYNC true
+#define FFG_RENDERER_BATCH_HINT 256
+#define FFG_RENDERER_PRIMITIVE_HINT 1024
+#define FFG_RENDERER_DEFERRED_HINT 1024
+#define FFG_RENDERER_DEFERRED_MAX_COMMANDS 0x1000000
+#define FFG_RENDERER_DEFERRED_MAX_TARGETS 255
+#define FFG_RENDERER_DEFERRED_MAX_TEXTURES 0x100000
+#define FFG_RENDERER_MAX_LAYER 255
+#define FFG_RENDERER_MAX_LOAD_THREADS 8
+#define FFG_RENDERER_DEFAULT_UPLOAD_BUDGET_US 2000
+#define FFG_RENDERER_DEFAULT_TEXTURE_BUDGET 0
+
+// Used in FFG_FrameCapture:
+
+#define FFG_CAPTURE_DEFAULT_RING_SIZE 8
+
+// Used in FFG_Pack:
+
+#define FFG_PACK_MAGIC "FFGP"
+#define FFG_PACK_VERSION 1
+#define FFG_PACK_HEADER_SIZE 16
+#define FFG_PACK_SLOT_SIZE 24
+#define FFG_PACK_ALIGNMENT 16
+
+// Used in FFG_RawImage:
+
+#define FFG_RAW_MAGIC "FFGR"
+#define FFG_RAW_VERSION 1
+#define FFG_RAW_HEADER_SIZE 24
+#define FFG_RAW_LZ4_HASH_BITS 16
+
+// Used in FFG_Map:
+
+#define FFG_MAP_DEFAULT_CHUNK_SIZE 16
+#define FFG_MAP_DEFAULT_MAX_BAKED_CHUNKS 64
+#define FFG_MAP_EMPTY_TILE -1
+
+// Used in FFG_SpatialGrid:
+
+#define FFG_SPATIAL_GRID_DEFAULT_CELL_SIZE 64
+#define FFG_SPATIAL_GRID_DEFAULT_BUCKETS 4096
+
+// Used in FFG_QuadTree:
+
+#define FFG_QUADTREE_DEFAULT_DEPTH 6
+#define FFG_QUADTREE_MAX_DEPTH 10
+
+// Used in FFG_TextureAtlas:
+
+#define FFG_ATLAS_DEFAULT_PAGE_SIZE 2048
+#define FFG_ATLAS_PADDING 1
+
+// Used in FFG_SpriteCompositor:
+
+#define FFG_COMPOSITOR_DEFAULT_CAPACITY 256
 
 // Used in FFG_Event:
 
@@ -31,7 +85,8 @@ enum FFG_EventWindowEvent {
 	FFG_EVENT_WINDOW_MAXIMIZE,
 	FFG_EVENT_WINDOW_LOSTFOCUS,
 	FFG_EVENT_WINDOW_GAINEDFOCUS,
-	FFG_EVENT_WINDOW_CLOSE
+	FFG_EVENT_WINDOW_CLOSE,
+	FFG_EVENT_WINDOW_RENDER_RESET
 };
 
 enum FFG_EventMouseButton {
@@ -63,7 +118,16 @@ enum FFG_WindowMode {
 	FFG_WINDOW_WINDOWED,
 	// FFG_WINDOW_BORDERLESS,
 	// FFG_WINDOW_FULLSCREEN,
-	FFG_WINDOW_MATCHDESKTOP
+	FFG_WINDOW_MATCHDESKTOP,
+	FFG_WINDOW_HEADLESS
+};
+
+enum FFG_RenderCommandType {
+	FFG_COMMAND_CLEAR,
+	FFG_COMMAND_SPRITE,
+	FFG_COMMAND_FILL_RECTS,
+	FFG_COMMAND_DRAW_RECTS,
+	FFG_COMMAND_LINE
 };
 
 enum FFG_WindowFlag {
@@ -73,12 +137,29 @@ enum FFG_WindowFlag {
 	FFG_WINFLAG_MOUSE_FOCUS
 };
 
+// Used in FFG_PixelOps:
+
+enum FFG_SimdLevel {
+	FFG_SIMD_SCALAR,
+	FFG_SIMD_SSE2,
+	FFG_SIMD_AVX2
+};
+
 // Used in FFG_Texture:
 
 enum FFG_TextureType {
 	FFG_TEXTURE_STR,
 	FFG_TEXTURE_MEM,
-	FFG_TEXTURE_DRAWTO
+	FFG_TEXTURE_RAW,
+	FFG_TEXTURE_DRAWTO,
+	FFG_TEXTURE_STREAMING
+};
+
+enum FFG_BlendMode {
+	FFG_BLEND_NONE,
+	FFG_BLEND_ALPHA,
+	FFG_BLEND_ADD,
+	FFG_BLEND_MOD
 };
 
 // Used in various:
@@ -1,7 +1,7 @@
 #ifndef FFG_EVENT_H_INCLUDED
 #define FFG_EVENT_H_INCLUDED
 
-#include <SDL2\SDL.h>
+#include <SDL2/SDL.h>
 #include "FFG_Constants.hpp"
 
 /***************************************************************************//**
@@ -0,0 +1,83 @@
+#ifndef FFG_FRAMECAPTURE_H_INCLUDED
+#define FFG_FRAMECAPTURE_H_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FFG_Constants.hpp"
+class FFG_Renderer;
+
+/***************************************************************************//**
+ * Frame capture representation. Is owned by FFG_Renderer. Holds a ring of
+ * preallocated frame buffers and a background thread that encodes filled
+ * buffers as .png files and writes them to disk. FFG_Renderer reads each
+ * presented frame into a free buffer and hands it to the thread, so the game
+ * loop never waits on encoding. If every buffer is still waiting to be written,
+ * the frame is dropped and counted instead. Frames are written to the path
+ * prefix followed by the frame number, such as "capture_000042.png".
+ *
+ * Capturing is controlled through FFG_Renderer using:
+ *
+ *   - FFG_Renderer::start_capture()
+ *   - FFG_Renderer::stop_capture()
+ *   - FFG_Renderer::captured_frames()
+ *   - FFG_Renderer::dropped_frames()
+ *   - FFG_Renderer::failed_frames()
+ *
+ * Example usage:
+ * -----------------------------------------------------------------------------
+ * TODO: Add example usage.
+ * -----------------------------------------------------------------------------
+ ******************************************************************************/
+class FFG_FrameCapture {
+private:
+	friend class FFG_Renderer;
+private:
+	class FFG_CaptureFrame {
+	public:
+		FFG_CaptureFrame();
+	public:
+		std::vector<Uint8> pixels;
+		int width;
+		int height;
+		unsigned long number;
+	};
+private:
+	std::string path_prefix;
+	std::vector<FFG_CaptureFrame> frames;
+	unsigned int head;                  // The next frame to fill. Main thread only.
+	unsigned int tail;                  // The next frame to write. Worker thread only.
+	unsigned int filled;                // Guarded by mutex.
+	bool running;                       // Guarded by mutex.
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::thread worker;
+	unsigned long next_number;
+	std::atomic<unsigned long> captured;
+	std::atomic<unsigned long> dropped;
+	std::atomic<unsigned long> failed;
+private:
+	FFG_CaptureFrame* acquire(int width, int height);
+	void submit();
+	void write_frames();
+	bool write_frame(const FFG_CaptureFrame& frame);
+public:
+	// CONSTRUCTION:
+	FFG_FrameCapture();
+	~FFG_FrameCapture();
+	// CONTROL:
+	bool start(const std::string& path_prefix, unsigned int ring_size, int width, int height);
+	void stop();
+	// INFO:
+	bool is_running() const;
+	unsigned long captured_frames() const;
+	unsigned long dropped_frames() const;
+	unsigned long failed_frames() const;
+};
+
+#endif // FFG_FRAMECAPTURE_H_INCLUDED
@@ -0,0 +1,84 @@
+#ifndef FFG_MAP_H_INCLUDED
+#define FFG_MAP_H_INCLUDED
+
+#include <vector>
+#include "FFG_Constants.hpp"
+#include "FFG_Rect.hpp"
+#include "FFG_Texture.hpp"
+class FFG_Renderer;
+
+/***************************************************************************//**
+ * Tile map representation. Stores the tile index of every cell in a dense
+ * array and draws tiles from a tileset, a texture holding tiles in a grid read
+ * left to right, top to bottom. The map is split into square chunks of tiles.
+ * When drawn, each chunk that intersects the camera is pre-rendered into a
+ * draw-toable texture the first time it is seen or after one of its tiles
+ * changes, and is then drawn in one copy. Set up the map using:
+ *
+ *   - FFG_Map::set()
+ *   - FFG_Map::set_tileset()
+ *   - FFG_Map::set_max_baked_chunks()
+ *
+ * Change and query tiles using:
+ *
+ *   - FFG_Map::set_tile()
+ *   - FFG_Map::get_tile()
+ *
+ * Tiles set to FFG_MAP_EMPTY_TILE are not drawn. Draw the map with
+ * FFG_Renderer::draw_map() between FFG_Renderer::load_map() and
+ * FFG_Renderer::unload_map(). Only a limited number of chunks are kept baked at
+ * once. When another is needed, the texture of the chunk least recently drawn
+ * is reused. If every baked chunk is in view, further chunks are drawn tile by
+ * tile for that frame.
+ *
+ * Example usage:
+ * -----------------------------------------------------------------------------
+ * TODO: Add example usage.
+ * -----------------------------------------------------------------------------
+ ******************************************************************************/
+class FFG_Map {
+private:
+	friend class FFG_Renderer;
+private:
+	class FFG_MapChunk {
+	public:
+		FFG_MapChunk();
+	public:
+		int slot;                       // The baked texture, or -1 if not baked.
+		bool dirty;
+		unsigned long last_drawn;
+	};
+private:
+	int width_p;
+	int height_p;
+	int tile_width_p;
+	int tile_height_p;
+	int chunk_size_p;
+	int chunks_x;
+	int chunks_y;
+	unsigned int max_baked_chunks;
+	FFG_Texture* tileset;
+	std::vector<int> tiles;
+	std::vector<FFG_MapChunk> chunks;
+	std::vector<FFG_Texture> slots;
+	std::vector<int> slot_chunks;   // The chunk using each slot, or -1 if free.
+public:
+	// CONSTRUCTION:
+	FFG_Map();
+	FFG_Map(const int width, const int height, const int tile_width, const int tile_height, const int chunk_size = FFG_MAP_DEFAULT_CHUNK_SIZE);
+	// SETTERS:
+	void set(const int width, const int height, const int tile_width, const int tile_height, const int chunk_size = FFG_MAP_DEFAULT_CHUNK_SIZE);
+	void set_tileset(FFG_Texture& tileset);
+	void set_max_baked_chunks(const unsigned int max_baked_chunks);
+	void set_tile(const int x, const int y, const int tile);
+	// INFO:
+	int get_tile(const int x, const int y) const;
+	int width() const;
+	int height() const;
+	int tile_width() const;
+	int tile_height() const;
+	int chunk_size() const;
+	bool is_loaded() const;
+};
+
+#endif // FFG_MAP_H_INCLUDED
@@ -0,0 +1,74 @@
+#ifndef FFG_MAPHEX_H_INCLUDED
+#define FFG_MAPHEX_H_INCLUDED
+
+#include <cmath>
+#include <vector>
+#include "FFG_Constants.hpp"
+#include "FFG_Rect.hpp"
+#include "FFG_Texture.hpp"
+class FFG_Renderer;
+
+/***************************************************************************//**
+ * Hex map representation. Cells are pointy-topped hexes in rows, with every
+ * odd row shifted right by half a hex. Cells are addressed by column and row
+ * and are stored row by row in a dense array. Each cell holds the index of a
+ * sprite in a tileset, a texture holding sprites in a grid read left to right,
+ * top to bottom. Set up the map using:
+ *
+ *   - FFG_MapHex::set()
+ *   - FFG_MapHex::set_tileset()
+ *
+ * Change and query cells using:
+ *
+ *   - FFG_MapHex::set_tile()
+ *   - FFG_MapHex::get_tile()
+ *
+ * Cells set to FFG_MAP_EMPTY_TILE are not drawn. Draw the map using
+ * FFG_Renderer::draw_hex_map(). The cells within the camera are found from the
+ * camera directly, one range of columns per row, and are submitted together as
+ * a single batch. Convert between cells and map pixels, such as to find the
+ * cell under the mouse, using:
+ *
+ *   - FFG_MapHex::pick()
+ *   - FFG_MapHex::get_position()
+ *
+ * Picking is exact when the row height is three quarters of the hex height,
+ * which is the default and is the spacing of regular hexes.
+ *
+ * Example usage:
+ * -----------------------------------------------------------------------------
+ * TODO: Add example usage.
+ * -----------------------------------------------------------------------------
+ ******************************************************************************/
+class FFG_MapHex {
+private:
+	friend class FFG_Renderer;
+private:
+	int width_p;
+	int height_p;
+	int hex_width_p;
+	int hex_height_p;
+	int row_height_p;
+	FFG_Texture* tileset;
+	std::vector<int> tiles;
+public:
+	// CONSTRUCTION:
+	FFG_MapHex();
+	FFG_MapHex(const int width, const int height, const int hex_width, const int hex_height, const int row_height = 0);
+	// SETTERS:
+	void set(const int width, const int height, const int hex_width, const int hex_height, const int row_height = 0);
+	void set_tileset(FFG_Texture& tileset);
+	void set_tile(const int column, const int row, const int tile);
+	// INFO:
+	int get_tile(const int column, const int row) const;
+	int width() const;
+	int height() const;
+	int hex_width() const;
+	int hex_height() const;
+	int row_height() const;
+	// COORDINATES:
+	void get_position(const int column, const int row, int* x, int* y) const;
+	bool pick(const int x, const int y, int* column, int* row) const;
+};
+
+#endif // FFG_MAPHEX_H_INCLUDED
@@ -0,0 +1,82 @@
+#ifndef FFG_PACK_H_INCLUDED
+#define FFG_PACK_H_INCLUDED
+
+#include <climits>
+#include <cstring>
+#include <SDL2/SDL.h>
+#include <string>
+#include "FFG_Constants.hpp"
+#include "FFG_Texture.hpp"
+
+/***************************************************************************//**
+ * Asset pack representation. A pack is a single file holding many assets, such
+ * as .png images, built ahead of time by the ffg_pack tool. Opening a pack maps
+ * the whole file into memory, so assets are read straight from the mapping with
+ * no copying and no further file handles.
+ *
+ * A pack starts with a header, followed by a hash table of its entries,
+ * followed by the entries' data. All values are little-endian:
+ *
+ *   - The header: "FFGP", then the version, the number of entries, and the
+ *     number of slots in the hash table, each as 32 bits.
+ *   - Each slot: the hash of the entry's name, the offset of its data from the
+ *     start of the file, and the size of its data, each as 64 bits. Empty slots
+ *     have an offset of 0.
+ *
+ * Names are hashed with 64 bit FNV-1a, and the table is probed linearly from
+ * the slot the hash selects, so entries are found in constant time. Names use
+ * '/' to separate directories. The data of each entry starts on a multiple of
+ * FFG_PACK_ALIGNMENT bytes.
+ *
+ * Open and close the pack using:
+ *
+ *   - FFG_Pack::open()
+ *   - FFG_Pack::close()
+ *   - FFG_Pack::is_open()
+ *
+ * Find entries using:
+ *
+ *   - FFG_Pack::find()
+ *   - FFG_Pack::set_texture()
+ *   - FFG_Pack::size()
+ *
+ * Textures set from a pack load from the mapped memory, so the pack must stay
+ * open while they are loaded or may be loaded again.
+ *
+ * Example usage:
+ * -----------------------------------------------------------------------------
+ * TODO: Add example usage.
+ * -----------------------------------------------------------------------------
+ ******************************************************************************/
+class FFG_Pack {
+private:
+	const Uint8* data;
+	Uint64 size_b;
+	Uint32 num_entries;
+	Uint32 capacity;
+#ifdef _WIN32
+	void* file;
+	void* mapping;
+#endif
+private:
+	static Uint32 read_32(const Uint8* p);
+	static Uint64 read_64(const Uint8* p);
+public:
+	// CONSTRUCTION:
+	FFG_Pack();
+	FFG_Pack(const FFG_Pack&) = delete;
+	FFG_Pack& operator=(const FFG_Pack&) = delete;
+	~FFG_Pack();
+	// CONTROL:
+	bool open(const std::string& path);
+	void close();
+	// LOOKUP:
+	static Uint64 hash(const std::string& name);
+	bool find(const std::string& name, const void** mem, unsigned int* size_b) const;
+	bool set_texture(const std::string& name, FFG_Texture& texture) const;
+	// INFO:
+	bool is_open() const;
+	unsigned int size() const;
+};
+
+#endif // FFG_PACK_H_INCLUDED
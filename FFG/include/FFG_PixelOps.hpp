@@ -0,0 +1,95 @@
+#ifndef FFG_PIXELOPS_H_INCLUDED
+#define FFG_PIXELOPS_H_INCLUDED
+
+#include <cstddef>
+#include <cstring>
+#include <SDL2/SDL.h>
+#include "FFG_Constants.hpp"
+
+/***************************************************************************//**
+ * CPU pixel operations. Works on pixels in any 32 bit format with 8 bit
+ * channels, such as ARGB8888 or ABGR8888, on surfaces decoded before they are
+ * uploaded, on the pixels of streaming textures, or on any other buffer. Safe
+ * to call from any thread, so operations can run in background jobs.
+ *
+ * Operate on rows of pixels using:
+ *
+ *   - FFG_PixelOps::tint()
+ *   - FFG_PixelOps::premultiply()
+ *   - FFG_PixelOps::convert()
+ *   - FFG_PixelOps::blend()
+ *
+ * Operate on whole surfaces using:
+ *
+ *   - FFG_PixelOps::tint_surface()
+ *   - FFG_PixelOps::premultiply_surface()
+ *   - FFG_PixelOps::convert_surface()
+ *
+ * Each operation has an AVX2, an SSE2 and a scalar version, all with the same
+ * results. The fastest version the CPU supports is used, which can be queried
+ * and lowered using:
+ *
+ *   - FFG_PixelOps::simd_level()
+ *   - FFG_PixelOps::set_simd_level()
+ *
+ * Multiplying two channels divides by 255 and rounds to the nearest value, as
+ * SDL's color modulation does.
+ *
+ * Example usage:
+ * -----------------------------------------------------------------------------
+ * TODO: Add example usage.
+ * -----------------------------------------------------------------------------
+ ******************************************************************************/
+class FFG_PixelOps {
+private:
+	/***********************************************************************//**
+	 * Where each channel of a format sits within a pixel, in bits, or -1 if
+	 * the format lacks the channel.
+	 **************************************************************************/
+	class FFG_PixelLayout {
+	public:
+		int shifts[4];                  // Red, green, blue, and alpha.
+		Uint32 alpha_mask;
+	public:
+		FFG_PixelLayout();
+		bool set(Uint32 format);
+	};
+private:
+	static FFG_SimdLevel supported_level;
+	static FFG_SimdLevel level;
+private:
+	static FFG_SimdLevel detect_level();
+	static Uint32 multiply(Uint32 pixel, Uint32 factors);
+	static Uint32 add_saturated(Uint32 a, Uint32 b);
+	static Uint32 alpha_factors(Uint32 pixel, const FFG_PixelLayout& layout);
+	static Uint32 convert_pixel(Uint32 pixel, const FFG_PixelLayout& from, const FFG_PixelLayout& to, Uint32 fill);
+	// KERNELS:
+	static void tint_scalar(Uint32* pixels, int count, Uint32 factors);
+	static void premultiply_scalar(Uint32* pixels, int count, const FFG_PixelLayout& layout);
+	static void convert_scalar(const Uint32* source, Uint32* destination, int count, const FFG_PixelLayout& from, const FFG_PixelLayout& to, Uint32 fill);
+	static void blend_scalar(const Uint32* source, Uint32* destination, int count, const FFG_PixelLayout& layout);
+	static int tint_sse2(Uint32* pixels, int count, Uint32 factors);
+	static int premultiply_sse2(Uint32* pixels, int count, const FFG_PixelLayout& layout);
+	static int convert_sse2(const Uint32* source, Uint32* destination, int count, const FFG_PixelLayout& from, const FFG_PixelLayout& to, Uint32 fill);
+	static int blend_sse2(const Uint32* source, Uint32* destination, int count, const FFG_PixelLayout& layout);
+	static int tint_avx2(Uint32* pixels, int count, Uint32 factors);
+	static int premultiply_avx2(Uint32* pixels, int count, const FFG_PixelLayout& layout);
+	static int convert_avx2(const Uint32* source, Uint32* destination, int count, const FFG_PixelLayout& from, const FFG_PixelLayout& to, Uint32 fill);
+	static int blend_avx2(const Uint32* source, Uint32* destination, int count, const FFG_PixelLayout& layout);
+public:
+	// DISPATCH:
+	static FFG_SimdLevel simd_level();
+	static FFG_SimdLevel set_simd_level(FFG_SimdLevel level);
+	static bool supports(Uint32 format);
+	// ROWS:
+	static bool tint(Uint32* pixels, int count, Uint32 format, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+	static bool premultiply(Uint32* pixels, int count, Uint32 format);
+	static bool convert(const Uint32* source, Uint32* destination, int count, Uint32 source_format, Uint32 destination_format);
+	static bool blend(const Uint32* source, Uint32* destination, int count, Uint32 format);
+	// SURFACES:
+	static bool tint_surface(SDL_Surface* surface, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+	static bool premultiply_surface(SDL_Surface* surface);
+	static SDL_Surface* convert_surface(SDL_Surface* surface, Uint32 format);
+};
+
+#endif // FFG_PIXELOPS_H_INCLUDED
@@ -0,0 +1,44 @@
+#ifndef FFG_QUADTREE_H_INCLUDED
+#define FFG_QUADTREE_H_INCLUDED
+
+#include <vector>
+#include "FFG_Constants.hpp"
+#include "FFG_Rect.hpp"
+#include "FFG_SpatialIndex.hpp"
+
+/***************************************************************************//**
+ * Loose quadtree spatial index. The world is split into nodes, each of which
+ * is split into four children, down to a maximum depth. Each node's loose
+ * bounds extend half its size past each of its sides, so an object is placed
+ * in the single deepest node at least as large as the object, chosen by the
+ * object's center, and is never split across nodes. Each node counts the
+ * objects beneath it, and queries skip empty branches, so sparse scenes cost
+ * little to query. Objects whose center is outside the world are kept in the
+ * root, which every query checks. See FFG_SpatialIndex.
+ *
+ * Example usage:
+ * -----------------------------------------------------------------------------
+ * TODO: Add example usage.
+ * -----------------------------------------------------------------------------
+ ******************************************************************************/
+class FFG_QuadTree : public FFG_SpatialIndex {
+private:
+	FFG_Rect world;
+	int max_depth_p;
+	std::vector<std::vector<unsigned int>> nodes;
+	std::vector<unsigned int> counts;
+private:
+	static int level_offset(int depth);
+	int place(const FFG_Rect& bounds) const;
+	void update_counts(int node, int delta);
+	void collect_node(const FFG_Rect& area, int depth, int x, int y);
+protected:
+	void add_entry(unsigned int id);
+	void remove_entry(unsigned int id);
+	void collect(const FFG_Rect& area);
+public:
+	FFG_QuadTree(const FFG_Rect& world, const int max_depth = FFG_QUADTREE_DEFAULT_DEPTH);
+	int max_depth() const;
+};
+
+#endif // FFG_QUADTREE_H_INCLUDED
@@ -0,0 +1,58 @@
+#ifndef FFG_RAWIMAGE_H_INCLUDED
+#define FFG_RAWIMAGE_H_INCLUDED
+
+#include <climits>
+#include <cstring>
+#include <SDL2/SDL.h>
+#include <vector>
+#include "FFG_Constants.hpp"
+
+/***************************************************************************//**
+ * Raw image representation. A raw image holds pixels already converted to a
+ * pixel format, so it can be uploaded to a texture with no decoding. The
+ * pixels may be compressed with LZ4, which decompresses far faster than PNG
+ * inflates. Raw images are built ahead of time by the ffg_pack tool, and are
+ * loaded by setting an FFG_Texture to their memory, which is recognized as
+ * FFG_TEXTURE_RAW.
+ *
+ * A raw image starts with a header, followed by its pixels. All values are
+ * little-endian 32 bits:
+ *
+ *   - "FFGR", then the version, the width, the height, the SDL pixel format,
+ *     and the size of the compressed pixels, or 0 if they are not compressed.
+ *
+ * Rows of pixels are tightly packed, with no padding. Compressed pixels are a
+ * single LZ4 block.
+ *
+ * Example usage:
+ * -----------------------------------------------------------------------------
+ * TODO: Add example usage.
+ * -----------------------------------------------------------------------------
+ ******************************************************************************/
+class FFG_RawImage {
+public:
+	int width;
+	int height;
+	Uint32 format;
+	int pitch;                          // The number of bytes in a row of pixels.
+	const Uint8* pixels;                // The pixels, or the compressed pixels.
+	unsigned int pixels_size;
+	bool compressed;
+private:
+	static Uint32 read_32(const Uint8* p);
+	static void write_32(std::vector<Uint8>& out, Uint32 value);
+public:
+	// CONSTRUCTION:
+	FFG_RawImage();
+	// DECODING:
+	static bool is_raw(const void* mem, unsigned int size_b);
+	bool parse(const void* mem, unsigned int size_b);
+	bool decode(Uint8* destination) const;
+	// ENCODING:
+	static bool encode(SDL_Surface* surface, bool compress, std::vector<Uint8>& out);
+	// LZ4:
+	static void lz4_compress(const Uint8* source, unsigned int source_size, std::vector<Uint8>& out);
+	static bool lz4_decompress(const Uint8* source, unsigned int source_size, Uint8* destination, unsigned int destination_size);
+};
+
+#endif // FFG_RAWIMAGE_H_INCLUDED
@@ -1,13 +1,53 @@
 #ifndef FFG_RENDERER_H_INCLUDED
 #define FFG_RENDERER_H_INCLUDED
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
 #include <cmath>
-#include <SDL2\SDL.h>
-#include <SDL2\SDL_image.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "FFG_CachedLayer.hpp"
 #include "FFG_Constants.hpp"
+#include "FFG_FrameCapture.hpp"
+#include "FFG_Map.hpp"
+#include "FFG_MapHex.hpp"
+#include "FFG_PixelOps.hpp"
+#include "FFG_RawImage.hpp"
 #include "FFG_Rect.hpp"
+#include "FFG_SpriteCompositor.hpp"
 #include "FFG_Texture.hpp"
+#include "FFG_TextureAtlas.hpp"
+#include "FFG_TextureStream.hpp"
+
+/***************************************************************************//**
+ * Progress of a bulk load started with FFG_Renderer::load_textures(). Passed
+ * to the progress callback once for each texture, as it finishes loading.
+ * Times are in microseconds. Decoding and converting happen on worker threads,
+ * and uploading happens on the thread that called
+ * FFG_Renderer::load_textures().
+ ******************************************************************************/
+class FFG_LoadProgress {
+public:
+	unsigned int index;             // The index of the texture in the list given.
+	unsigned int done;              // The number of textures finished so far, including this one.
+	unsigned int total;             // The number of textures in the list given.
+	bool failed;
+	int decode_us;
+	int convert_us;
+	int upload_us;
+};
 
 /***************************************************************************//**
  * Renderer representation. Is inherited by FFG_Engine. Handles the drawing of
@@ -18,6 +58,26 @@
  *   - FFG_Renderer::set_screen_mode()
  *   - FFG_Renderer::set_vsync()
  *
+ * Setting the screen mode to FFG_WINDOW_HEADLESS before the engine runs creates
+ * no window. SDL's dummy video driver is used, and a software renderer draws
+ * into an offscreen surface the size of the screen. The engine loop runs
+ * unchanged, so scenes can be run and timed on machines without a display.
+ * What has been drawn to the current render target is read back using:
+ *
+ *   - FFG_Renderer::read_pixels()
+ *
+ * Presented frames can be recorded to .png files without stalling the game
+ * loop using:
+ *
+ *   - FFG_Renderer::start_capture()
+ *   - FFG_Renderer::stop_capture()
+ *   - FFG_Renderer::captured_frames()
+ *   - FFG_Renderer::dropped_frames()
+ *   - FFG_Renderer::failed_frames()
+ *
+ * While capturing, each frame is read back just before it is presented and is
+ * encoded and written by a background thread. See FFG_FrameCapture.
+ *
  * If you need to query the screen's height, width, or flags, you can use:
  *
  *   - FFG_Renderer::screen_width()
@@ -29,10 +89,157 @@
  *   - FFG_Renderer::set_render_target()
  *   - FFG_Renderer::reset_render_target()
  *
+ * Loading many small images into a few large textures is done using:
+ *
+ *   - FFG_Renderer::load_atlas()
+ *   - FFG_Renderer::unload_atlas()
+ *
+ * Many textures are loaded at once using:
+ *
+ *   - FFG_Renderer::load_textures()
+ *
+ * Images are decoded and converted to the renderer's native pixel format on a
+ * pool of worker threads, while the calling thread uploads each to the GPU as
+ * soon as it is ready. Progress and per-file timings are reported through an
+ * optional callback. See FFG_LoadProgress.
+ *
+ * Decoded images can be processed before they are uploaded, such as to bake
+ * tints or premultiply alpha with FFG_PixelOps, using:
+ *
+ *   - FFG_Renderer::set_load_filter()
+ *
+ * The native pixel format is the first format with alpha the renderer reports
+ * supporting, chosen when the renderer is initialized. Textures loaded from
+ * images, draw-toable textures and atlas pages are all created in it, so the
+ * driver never converts pixels on upload. Query it using:
+ *
+ *   - FFG_Renderer::native_format()
+ *   - FFG_Texture::get_format()
+ *
+ * Textures can instead be streamed in the background using:
+ *
+ *   - FFG_Renderer::request_texture()
+ *   - FFG_Renderer::cancel_texture()
+ *   - FFG_Renderer::set_upload_budget()
+ *   - FFG_Renderer::set_placeholder()
+ *   - FFG_Renderer::streaming_textures()
+ *
+ * A requested texture is decoded on a background thread and becomes loaded in
+ * a later frame. Each frame, the engine uploads decoded textures, highest
+ * priority first, until the upload budget is spent, and carries the rest over
+ * to later frames. Until a requested texture is loaded, drawing it draws the
+ * placeholder texture in its place, or draws nothing if there is none. See
+ * FFG_TextureStream.
+ *
+ * The pixels of streaming textures, set with FFG_Texture::set_streaming(), are
+ * written from the CPU using:
+ *
+ *   - FFG_Renderer::lock_texture()
+ *   - FFG_Renderer::unlock_texture()
+ *
+ * A streaming texture keeps a copy of its pixels in memory, and has two
+ * buffers: one drawn, and one updated. Unlocking uploads the area that was
+ * locked to the buffer not being drawn, then swaps the buffers, so writing the
+ * next frame's pixels never waits on the GPU still drawing the last frame's.
+ *
+ * The memory used by loaded textures is estimated from their size and pixel
+ * format, and can be limited using:
+ *
+ *   - FFG_Renderer::set_texture_budget()
+ *   - FFG_Renderer::texture_budget()
+ *   - FFG_Renderer::texture_bytes()
+ *
+ * When loading a texture takes the total over the budget, textures loaded from
+ * images are evicted, least recently drawn first, until the total is within
+ * the budget again. Textures drawn during the current frame, draw-toable
+ * textures, and textures pinned with FFG_Texture::set_pinned() are never
+ * evicted. An evicted texture is no longer loaded, and is loaded again, with
+ * its blend mode and color modulation, the next time it is drawn.
+ *
+ * Textures shared between states can be loaded once and reference counted
+ * using:
+ *
+ *   - FFG_Renderer::acquire_texture()
+ *   - FFG_Renderer::release_texture()
+ *   - FFG_Renderer::cached_textures()
+ *
+ * Acquiring the same path, or the same memory, returns the same texture, loaded
+ * only once. Each acquire should be matched by a release, typically in the
+ * state's init() and exit(). Textures no longer held are unloaded after the
+ * engine changes states, once the next state has initialized, so textures
+ * used by both states are never loaded again.
+ *
+ * Tile maps are loaded, drawn, and unloaded using:
+ *
+ *   - FFG_Renderer::load_map()
+ *   - FFG_Renderer::draw_map()
+ *   - FFG_Renderer::unload_map()
+ *
+ * Hex maps need no loading, and are drawn using:
+ *
+ *   - FFG_Renderer::draw_hex_map()
+ *
  * Drawing textures is done using:
  * 
  *   - FFG_Renderer::draw()
  * 
+ * Many draws of the same texture can be folded into a single submission by
+ * wrapping them in:
+ *
+ *   - FFG_Renderer::begin_batch()
+ *   - FFG_Renderer::end_batch()
+ *
+ * While batching, consecutive draws of the same texture with the same blend
+ * mode are collected and submitted together. A change of texture or blend mode
+ * submits what was collected so far. Primitive drawing, clearing, changing the
+ * render target, and presenting all submit the pending batch first, so the
+ * order of drawing is preserved.
+ *
+ * Quads already laid out as vertices, such as the glyphs of a string, are drawn
+ * in one submission using:
+ *
+ *   - FFG_Renderer::draw_quads()
+ *
+ * While batching, they join the pending batch like any other draw.
+ *
+ * Drawing can be deferred until the end of the frame using:
+ *
+ *   - FFG_Renderer::set_deferred()
+ *   - FFG_Renderer::set_layer()
+ *   - FFG_Renderer::flush_deferred()
+ *
+ * While deferred, draws, primitives, and clears are recorded rather than sent
+ * to the GPU. When the frame is presented, or when flushed explicitly, the
+ * recorded commands are sorted by render target, layer, blend mode, and
+ * texture, and are then replayed with adjacent compatible commands merged.
+ * Render targets are replayed in the order they were first set during the
+ * frame, followed by the screen. Within a target, layers are drawn from lowest
+ * to highest, and a clear happens before any layer is drawn. Draws within the
+ * same layer may be reordered, so anything that must overlap in a particular
+ * order should be drawn on different layers.
+ *
+ * Parts of the screen that rarely change can be cached in layers, which are
+ * only redrawn when invalidated and are composited by the engine each frame in
+ * order of their z value, using:
+ *
+ *   - FFG_Renderer::add_layer()
+ *   - FFG_Renderer::remove_layer()
+ *
+ * While drawing is deferred, cached layers are recorded on layer 0 if behind
+ * the state and on FFG_RENDERER_MAX_LAYER if in front of it, so states should
+ * only draw on layers 1 to FFG_RENDERER_MAX_LAYER - 1 while layers are in use.
+ *
+ * See FFG_CachedLayer.
+ *
+ * Sprites made of several tinted layers can be baked into single images, keyed
+ * by their tints, using:
+ *
+ *   - FFG_Renderer::load_compositor()
+ *   - FFG_Renderer::unload_compositor()
+ *   - FFG_Renderer::draw_composite()
+ *
+ * See FFG_SpriteCompositor.
+ *
  * Primitive drawing is done using:
  *
  *   - FFG_Renderer::set_draw_color()
@@ -45,6 +252,34 @@
  *   - FFG_Renderer::draw_ellipse()
  *   - FFG_Renderer::render_clear()
  *
+ * The renderer remembers the draw color, blend mode, and render target it last
+ * gave SDL, and textures remember their color modulation, alpha modulation,
+ * and blend mode. Calls that would not change any of these are skipped. The
+ * number of skipped calls can be queried using:
+ *
+ *   - FFG_Renderer::elided_calls()
+ *   - FFG_Renderer::reset_elided_calls()
+ *
+ * States that change only part of the screen each frame can avoid redrawing
+ * the rest using:
+ *
+ *   - FFG_Renderer::set_dirty_rendering()
+ *   - FFG_Renderer::add_damage()
+ *   - FFG_Renderer::damage_all()
+ *   - FFG_Renderer::is_damaged()
+ *
+ * While dirty rendering is enabled, the screen is kept in a persistent back
+ * buffer. States report the areas that change by adding damage, typically
+ * during update(). The state is only rendered if there is damage, and while it
+ * renders, drawing to the screen goes to the back buffer and is clipped to the
+ * bounding rectangle of the damage, so everything else keeps what was drawn
+ * before. FFG_Renderer::render_clear() only clears the damaged area. States can
+ * skip drawing anything FFG_Renderer::is_damaged() reports as undamaged. The
+ * back buffer is then copied to the screen in a single draw, since the screen's
+ * contents are undefined after each present. The whole screen is damaged when
+ * dirty rendering is enabled, when the state changes, and when the screen size
+ * changes.
+ *
  * In all cases, before rendering, you should call FFG_Renderer::render_clear()
  * while the screen is the current render target. This will clear the screen to
  * the current draw color set using FFG_Renderer::set_draw_color().
@@ -58,19 +293,152 @@ class FFG_Renderer {
 private:
 	// INTERNAL:
 	SDL_Renderer* renderer;
+	Uint32 texture_format;
+	std::function<void(FFG_Texture&, SDL_Surface*)> load_filter;
 	// WINDOW:
 	SDL_Window* window;
+	SDL_Surface* headless_surface;
 	std::string window_title;
 	int screen_width_p;
 	int screen_height_p;
 	FFG_WindowMode window_mode;
 	bool vsync_p;
+	// RENDER TARGET:
+	FFG_Texture* current_target;
+	// STATE CACHE:
+	SDL_Texture* applied_target;
+	SDL_BlendMode applied_blend_mode;
+	SDL_Color applied_color;
+	bool applied_color_valid;
+	unsigned long elided_calls_p;
+	// BATCHING:
+	bool batching;
+	FFG_Texture* batch_texture;
+	SDL_Texture* batch_buffer;          // The buffer of batch_texture drawn from.
+	FFG_BlendMode batch_blend_mode;
+	SDL_Rect batch_first_source;
+	SDL_Rect batch_first_destination;
+	std::vector<SDL_Vertex> batch_vertices;
+	std::vector<int> batch_indices;
+	// PRIMITIVES:
+	SDL_Color draw_color;
+	std::vector<SDL_Rect> rect_buffer;
+	std::vector<int> span_buffer;
+	// DEFERRED RENDERING:
+	class FFG_RenderCommand {
+	public:
+		FFG_RenderCommand(FFG_RenderCommandType type, const SDL_Color& color);
+	public:
+		FFG_RenderCommandType type;
+		SDL_Color color;            // The draw color, or the texture's color modulation for sprites.
+		FFG_Texture* texture;       // Sprites only.
+		FFG_BlendMode blend_mode;   // Sprites only. The texture's blend mode when recorded.
+		SDL_Texture* buffer;        // Sprites only. The texture's buffer when recorded.
+		SDL_Rect source;            // Sprites only.
+		SDL_Rect destination;       // Sprites, or the two endpoints of a line as x, y, w, h.
+		unsigned int first;         // Rectangles only. The first rectangle in deferred_rects.
+		unsigned int count;         // Rectangles only. The number of rectangles.
+	};
+	bool deferred;
+	unsigned long deferred_frame;
+	unsigned int deferred_layer;
+	unsigned int deferred_target;
+	unsigned int deferred_next_slot;
+	std::vector<FFG_RenderCommand> deferred_commands;
+	std::vector<Uint64> deferred_keys;
+	std::vector<Uint64> deferred_keys_swap;
+	std::vector<SDL_Rect> deferred_rects;
+	std::vector<FFG_Texture*> deferred_targets;
+	std::vector<SDL_Texture*> retired_buffers;     // Buffers to destroy once replayed.
+	std::deque<FFG_Texture> retired_textures;      // Stand-ins for textures unloaded since they were drawn.
+	// FRAME CAPTURE:
+	FFG_FrameCapture capture;
+	// DIRTY RECTANGLES:
+	bool dirty_rendering;
+	bool dirty_frame;               // The current state is drawing to the back buffer.
+	FFG_Texture back_buffer;
+	bool damaged;
+	SDL_Rect pending_damage;        // Damage added for the next frame.
+	SDL_Rect frame_damage;          // Damage being drawn this frame.
+	// CACHED LAYERS:
+	std::vector<FFG_CachedLayer*> layers;
+	// SPRITE COMPOSITING:
+	std::vector<FFG_SpriteCompositor*> compositors;
+	// MAPS:
+	std::vector<FFG_Map*> maps;
+	// STREAMING:
+	FFG_TextureStream stream;
+	int upload_budget_us;
+	FFG_Texture* placeholder;
+	// RESIDENCY:
+	std::vector<FFG_Texture*> resident;
+	std::vector<FFG_Texture*> eviction_candidates;
+	std::size_t resident_bytes;
+	std::size_t texture_budget_p;
+	// TEXTURE CACHE:
+	std::unordered_map<std::string, FFG_Texture> cache_paths;
+	std::map<std::pair<void*, unsigned int>, FFG_Texture> cache_memory;
+	// RAW IMAGES:
+	std::vector<Uint8> raw_buffer;
+private:
+	friend class FFG_Texture;
+	friend class FFG_TextureStream;
+private:
+	static SDL_Surface* load_surface(FFG_Texture& texture);
+	static SDL_Surface* prepare_surface(FFG_Texture& texture, Uint32 format, const std::function<void(FFG_Texture&, SDL_Surface*)>& filter);
+	bool query_texture(FFG_Texture& texture);
+	void choose_texture_format();
+	bool upload_surface(FFG_Texture& texture, SDL_Surface* surface);
+	static void extrude_edges(SDL_Surface* surface, const SDL_Rect& area, int padding);
+	bool upload_raw(FFG_Texture& texture);
+	bool create_streaming(FFG_Texture& texture);
+	bool upload_pixels(FFG_Texture& texture, SDL_Texture* buffer, const SDL_Rect& area);
+	void track_texture(FFG_Texture& texture, Uint32 format);
+	void untrack_texture(FFG_Texture& texture);
+	void retire_texture(FFG_Texture& texture);
+	void enforce_texture_budget();
+	bool use_texture(FFG_Texture& texture);
+	FFG_Texture* acquire_cached(FFG_Texture& texture);
+	bool target_size(int* width, int* height);
+	bool batch_quad(FFG_Texture& texture, const SDL_Rect& source, const SDL_Rect& destination, const SDL_Color& color, FFG_BlendMode blend_mode, SDL_Texture* buffer);
+	bool flush_batch();
+	static void quad_rects(const FFG_Texture& texture, const SDL_Vertex* quad, SDL_Rect& source, SDL_Rect& destination);
+	bool apply_draw_color(const SDL_Color& color);
+	bool apply_render_target(SDL_Texture* texture);
+	void init_headless();
+	void capture_frame();
+	SDL_Texture* screen_texture() const;
+	bool clear_target();
+	bool redraw_layer(FFG_CachedLayer& layer);
+	bool bake_composite(FFG_SpriteCompositor& compositor, unsigned int slot, const std::vector<SDL_Color>& tints);
+	bool draw_layers(FFG_SpriteCompositor& compositor, const std::vector<SDL_Color>& tints, int screen_x, int screen_y);
+	bool draw_placeholder(FFG_Texture& texture, const SDL_Rect* destination);
+	bool draw_clipped(FFG_Texture& texture, const SDL_Rect& source, const SDL_Rect& area, const SDL_Rect& camera, int screen_x, int screen_y);
+	int acquire_map_slot(FFG_Map& map, int chunk);
+	bool bake_map_chunk(FFG_Map& map, int chunk);
+	bool draw_map_tiles(FFG_Map& map, int chunk, const SDL_Rect& camera, int screen_x, int screen_y);
+	void push_h_line(int y, int x1, int x2);
+	void circle_spans(int r);
+	void ellipse_spans(int rx, int ry);
+	void push_spans(int x, int y, bool filled);
+	bool flush_rects();
+	bool record_command(const FFG_RenderCommand& command);
+	bool record_sprite(FFG_Texture& texture, const SDL_Rect& source, const SDL_Rect& destination, const SDL_Color& color);
+	bool record_rects(FFG_RenderCommandType type);
+	void sort_deferred();
+	bool replay_deferred();
 protected:
 	// CONTROL:
 	FFG_Renderer();
 	void init();
 	void exit();
 	void present();
+	bool begin_frame();
+	void end_frame();
+	bool composite_layers(bool front);
+	void invalidate_targets();
+	void upload_streamed();
+	void collect_textures();
 public:
 	// WINDOW:
 	void set_window_title(const std::string& window_title);
@@ -79,18 +447,78 @@ public:
 	int screen_width() const;
 	int screen_height() const;
 	bool check_window_flag(FFG_WindowFlag window_flag);
+	bool read_pixels(std::vector<Uint8>& pixels, int* width, int* height);
+	// FRAME CAPTURE:
+	bool start_capture(const std::string& path_prefix, unsigned int ring_size = FFG_CAPTURE_DEFAULT_RING_SIZE);
+	void stop_capture();
+	unsigned long captured_frames() const;
+	unsigned long dropped_frames() const;
+	unsigned long failed_frames() const;
 	// TEXTURE LOADING & UNLOADING:
 	bool load_texture(FFG_Texture& texture);
 	void unload_texture(FFG_Texture& texture);
+	bool load_textures(const std::vector<FFG_Texture*>& textures, const std::function<void(const FFG_LoadProgress&)>& progress = nullptr);
+	bool load_atlas(FFG_TextureAtlas& atlas);
+	void unload_atlas(FFG_TextureAtlas& atlas);
+	Uint32 native_format() const;
+	void set_load_filter(const std::function<void(FFG_Texture&, SDL_Surface*)>& filter);
+	// STREAMING:
+	bool request_texture(FFG_Texture& texture, int priority = 0);
+	void cancel_texture(FFG_Texture& texture);
+	void set_upload_budget(int us);
+	void set_placeholder(FFG_Texture* texture);
+	unsigned int streaming_textures();
+	// PIXEL ACCESS:
+	bool lock_texture(FFG_Texture& texture, const FFG_Rect* area, Uint8** pixels, int* pitch);
+	bool unlock_texture(FFG_Texture& texture);
+	// RESIDENCY:
+	void set_texture_budget(std::size_t bytes);
+	std::size_t texture_budget() const;
+	std::size_t texture_bytes() const;
+	// TEXTURE CACHE:
+	FFG_Texture* acquire_texture(const std::string& path);
+	FFG_Texture* acquire_texture(void* const mem, const unsigned int size_b);
+	void release_texture(FFG_Texture* texture);
+	unsigned int cached_textures() const;
+	// MAPS:
+	bool load_map(FFG_Map& map);
+	void unload_map(FFG_Map& map);
+	bool draw_map(FFG_Map& map, const FFG_Rect& camera, int screen_x, int screen_y);
+	bool draw_hex_map(FFG_MapHex& map, const FFG_Rect& camera, int screen_x, int screen_y);
 	// RENDER TARGET:
 	bool set_render_target(FFG_Texture& texture);
 	bool reset_render_target();
+	FFG_Texture* get_render_target() const;
 	// TEXTURE DRAWING:
-	bool draw(FFG_Texture& texture) const;
-	bool draw(FFG_Texture& texture, FFG_Rect& source, int screen_x, int screen_y) const;
-	bool draw(FFG_Texture& texture, FFG_Rect& source, FFG_Rect& destination) const;
+	bool draw(FFG_Texture& texture);
+	bool draw(FFG_Texture& texture, FFG_Rect& source, int screen_x, int screen_y);
+	bool draw(FFG_Texture& texture, FFG_Rect& source, FFG_Rect& destination);
+	bool draw_quads(FFG_Texture& texture, const SDL_Vertex* vertices, int num_quads);
+	// CACHED LAYERS:
+	bool add_layer(FFG_CachedLayer& layer);
+	void remove_layer(FFG_CachedLayer& layer);
+	// SPRITE COMPOSITING:
+	bool load_compositor(FFG_SpriteCompositor& compositor);
+	void unload_compositor(FFG_SpriteCompositor& compositor);
+	bool draw_composite(FFG_SpriteCompositor& compositor, const std::vector<SDL_Color>& tints, int screen_x, int screen_y);
+	// DIRTY RECTANGLES:
+	void set_dirty_rendering(bool dirty_rendering);
+	void add_damage(const FFG_Rect& rect);
+	void damage_all();
+	bool is_damaged(const FFG_Rect& rect) const;
+	// STATE CACHE:
+	unsigned long elided_calls() const;
+	void reset_elided_calls();
+	// BATCHING:
+	void begin_batch();
+	bool end_batch();
+	// DEFERRED RENDERING:
+	bool set_deferred(bool deferred);
+	void set_layer(unsigned int layer);
+	bool flush_deferred();
 	// PRIMITIVE DRAWING:
 	bool set_draw_color(int r, int g, int b, int a);
+	SDL_Color get_draw_color() const;
 	bool draw_pixel(int x, int y);
 	bool draw_h_line(int y, int x1, int x2);
 	bool draw_v_line(int x, int y1, int y2);
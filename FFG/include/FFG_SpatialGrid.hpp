@@ -0,0 +1,40 @@
+#ifndef FFG_SPATIALGRID_H_INCLUDED
+#define FFG_SPATIALGRID_H_INCLUDED
+
+#include <vector>
+#include "FFG_Constants.hpp"
+#include "FFG_Rect.hpp"
+#include "FFG_SpatialIndex.hpp"
+
+/***************************************************************************//**
+ * Uniform hash grid spatial index. Space is split into square cells of a fixed
+ * size, with no bounds, and each object is listed in every cell its bounding
+ * rectangle overlaps. Cells are hashed into a fixed number of buckets, so
+ * memory does not depend on the size of the world. Suits dense scenes of
+ * similarly sized objects, where the cell size is around the size of a typical
+ * object. Objects that would overlap more cells than there are buckets are
+ * kept in a separate list that every query checks. See FFG_SpatialIndex.
+ *
+ * Example usage:
+ * -----------------------------------------------------------------------------
+ * TODO: Add example usage.
+ * -----------------------------------------------------------------------------
+ ******************************************************************************/
+class FFG_SpatialGrid : public FFG_SpatialIndex {
+private:
+	int cell_size_p;
+	std::vector<std::vector<unsigned int>> buckets;
+	std::vector<unsigned int> oversized;
+private:
+	std::vector<unsigned int>& bucket(int cell_x, int cell_y);
+	long long cell_range(const FFG_Rect& rect, int* x0, int* y0, int* x1, int* y1) const;
+protected:
+	void add_entry(unsigned int id);
+	void remove_entry(unsigned int id);
+	void collect(const FFG_Rect& area);
+public:
+	FFG_SpatialGrid(const int cell_size = FFG_SPATIAL_GRID_DEFAULT_CELL_SIZE, const unsigned int num_buckets = FFG_SPATIAL_GRID_DEFAULT_BUCKETS);
+	int cell_size() const;
+};
+
+#endif // FFG_SPATIALGRID_H_INCLUDED
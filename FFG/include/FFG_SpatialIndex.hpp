@@ -0,0 +1,93 @@
+#ifndef FFG_SPATIALINDEX_H_INCLUDED
+#define FFG_SPATIALINDEX_H_INCLUDED
+
+#include <vector>
+#include "FFG_Constants.hpp"
+#include "FFG_Rect.hpp"
+
+/***************************************************************************//**
+ * Spatial index interface. Tracks the bounding rectangles of objects so that
+ * the objects within an area can be found without testing every object. Is
+ * implemented by FFG_SpatialGrid, for dense scenes, and FFG_QuadTree, for
+ * sparse ones. Objects are tracked using:
+ *
+ *   - FFG_SpatialIndex::insert()
+ *   - FFG_SpatialIndex::move()
+ *   - FFG_SpatialIndex::remove()
+ *
+ * Each inserted object is given an ID, which can be reused after the object is
+ * removed. Objects are found using:
+ *
+ *   - FFG_SpatialIndex::query_rect()
+ *   - FFG_SpatialIndex::query_point()
+ *   - FFG_SpatialIndex::query_radius()
+ *
+ * Queries write the IDs they find into a buffer given by the caller and never
+ * allocate. Each object is reported at most once per query, in no particular
+ * order. Typical uses are querying the camera's area to cull objects before
+ * drawing them, and querying the point of a mouse event from FFG_Event to find
+ * the objects under the mouse.
+ *
+ * Example usage:
+ * -----------------------------------------------------------------------------
+ * TODO: Add example usage.
+ * -----------------------------------------------------------------------------
+ ******************************************************************************/
+class FFG_SpatialIndex {
+protected:
+	class FFG_SpatialEntry {
+	public:
+		FFG_SpatialEntry();
+	public:
+		FFG_Rect bounds;
+		unsigned long stamp;            // The last query that reported the object.
+		int node;                       // Used by the implementation.
+		bool used;
+	};
+	enum FFG_SpatialQuery {
+		FFG_SPATIAL_QUERY_RECT,
+		FFG_SPATIAL_QUERY_POINT,
+		FFG_SPATIAL_QUERY_RADIUS
+	};
+private:
+	std::vector<unsigned int> free_ids;
+	unsigned int num_objects;
+	// QUERY:
+	unsigned long query_stamp;
+	FFG_SpatialQuery query_type;
+	FFG_Rect query_area;
+	int query_x;
+	int query_y;
+	long long query_radius_sq;
+	unsigned int* query_results;
+	unsigned int query_max_results;
+	unsigned int query_count;
+private:
+	unsigned int run_query(const FFG_Rect& area, unsigned int* results, unsigned int max_results);
+protected:
+	std::vector<FFG_SpatialEntry> entries;
+protected:
+	FFG_SpatialIndex();
+	void test(unsigned int id);
+	static int floor_div(int a, int b);
+	virtual void add_entry(unsigned int id) = 0;
+	virtual void remove_entry(unsigned int id) = 0;
+	virtual void collect(const FFG_Rect& area) = 0;
+public:
+	virtual ~FFG_SpatialIndex();
+	// OBJECTS:
+	unsigned int insert(const FFG_Rect& bounds);
+	bool move(unsigned int id, const FFG_Rect& bounds);
+	bool remove(unsigned int id);
+	void clear();
+	// QUERIES:
+	unsigned int query_rect(const FFG_Rect& area, unsigned int* results, unsigned int max_results);
+	unsigned int query_point(int x, int y, unsigned int* results, unsigned int max_results);
+	unsigned int query_radius(int x, int y, int radius, unsigned int* results, unsigned int max_results);
+	// INFO:
+	unsigned int size() const;
+	bool contains(unsigned int id) const;
+	const FFG_Rect& get_bounds(unsigned int id) const;
+};
+
+#endif // FFG_SPATIALINDEX_H_INCLUDED
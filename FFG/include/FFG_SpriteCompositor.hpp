@@ -0,0 +1,101 @@
+#ifndef FFG_SPRITECOMPOSITOR_H_INCLUDED
+#define FFG_SPRITECOMPOSITOR_H_INCLUDED
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "FFG_Constants.hpp"
+#include "FFG_Rect.hpp"
+#include "FFG_Texture.hpp"
+class FFG_Renderer;
+
+/***************************************************************************//**
+ * Sprite compositor representation. Bakes sprites made of several tinted
+ * layers, such as a character's skin, clothes and equipment, into slots of a
+ * single draw-toable texture, so that each sprite is drawn as one quad rather
+ * than one draw and one color modulation change per layer. Sprites are keyed by
+ * the tint of each layer, so units with identical colors share a slot, and
+ * draws from the same compositor batch together.
+ *
+ * Set the size of the sprites, the number of slots, and the layers, bottom
+ * first, using:
+ *
+ *   - FFG_SpriteCompositor::set()
+ *   - FFG_SpriteCompositor::add_layer()
+ *   - FFG_SpriteCompositor::clear_layers()
+ *
+ * Load, draw and unload the compositor using:
+ *
+ *   - FFG_Renderer::load_compositor()
+ *   - FFG_Renderer::draw_composite()
+ *   - FFG_Renderer::unload_compositor()
+ *
+ * The first time a combination of tints is drawn it is baked into a free slot,
+ * or else into the least recently drawn slot. Slots drawn during the current
+ * frame are never reused, so if every slot is in use, the layers are drawn
+ * directly instead. Changing the layers forgets every baked sprite. Query how
+ * well the slots are reused using:
+ *
+ *   - FFG_SpriteCompositor::hits()
+ *   - FFG_SpriteCompositor::misses()
+ *   - FFG_SpriteCompositor::evictions()
+ *   - FFG_SpriteCompositor::baked()
+ *
+ * The layer textures must stay valid while the compositor is loaded, and must
+ * be the size of the sprites, or are stretched to it.
+ *
+ * Example usage:
+ * -----------------------------------------------------------------------------
+ * TODO: Add example usage.
+ * -----------------------------------------------------------------------------
+ ******************************************************************************/
+class FFG_SpriteCompositor {
+private:
+	friend class FFG_Renderer;
+private:
+	class FFG_CompositeSlot {
+	public:
+		FFG_CompositeSlot();
+	public:
+		std::string key;                // The tints of the sprite baked into the slot.
+		unsigned long used_frame;
+		bool baked;
+	};
+private:
+	std::vector<FFG_Texture*> layers;
+	FFG_Texture page;
+	int sprite_width;
+	int sprite_height;
+	unsigned int capacity_p;
+	int columns;
+	std::vector<FFG_CompositeSlot> slots;
+	std::unordered_map<std::string, unsigned int> lookup;
+	std::string key_buffer;
+	unsigned int baked_p;
+	unsigned long hits_p;
+	unsigned long misses_p;
+	unsigned long evictions_p;
+private:
+	void forget();
+	FFG_Rect slot_rect(unsigned int slot) const;
+public:
+	// CONSTRUCTION:
+	FFG_SpriteCompositor();
+	FFG_SpriteCompositor(const int width, const int height, const unsigned int capacity = FFG_COMPOSITOR_DEFAULT_CAPACITY);
+	// SETTERS:
+	void set(const int width, const int height, const unsigned int capacity = FFG_COMPOSITOR_DEFAULT_CAPACITY);
+	void add_layer(FFG_Texture& texture);
+	void clear_layers();
+	void reset_counters();
+	// INFO:
+	bool is_loaded() const;
+	unsigned int num_layers() const;
+	unsigned int capacity() const;
+	unsigned int baked() const;
+	unsigned long hits() const;
+	unsigned long misses() const;
+	unsigned long evictions() const;
+};
+
+#endif // FFG_SPRITECOMPOSITOR_H_INCLUDED
@@ -1,12 +1,14 @@
 #ifndef FFG_TEXTURE_H_INCLUDED
 #define FFG_TEXTURE_H_INCLUDED
 
-#include <SDL2\SDL.h>
-#include <SDL2\SDL_image.h>
+#include <cstddef>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
 #include <string>
 #include <vector>
 #include "FFG_Constants.hpp"
 class FFG_Renderer;
+class FFG_TextureStream;
 
 /***************************************************************************//**
  * Texture representation. Used with FFG_Renderer to draw images to the screen
@@ -17,13 +19,39 @@ class FFG_Renderer;
  *   - FFG_Texture::get_width()
  *   - FFG_Texture::get_height()
  *
+ * Query the pixel format the texture was loaded in using:
+ *
+ *   - FFG_Texture::get_format()
+ *
  * See if the texture is loaded using:
  *
  *   - FFG_Texture::is_loaded()
+ *   - FFG_Texture::is_streaming()
  *
- * Set the color modulation of the texture using:
+ * Set the color modulation and blend mode of the texture using:
  *
  *	 - FFG_Texture::set_mod_color()
+ *	 - FFG_Texture::set_mod_alpha()
+ *	 - FFG_Texture::set_blend_mode()
+ *
+ * Setting any of these to the value they already have does not call SDL.
+ *
+ * A streaming texture's pixels are written from the CPU, such as for minimaps,
+ * fog masks or video frames, using:
+ *
+ *   - FFG_Texture::set_streaming()
+ *   - FFG_Renderer::lock_texture()
+ *   - FFG_Renderer::unlock_texture()
+ *
+ * Copying a texture copies what it loads, not the loaded texture, so the copy
+ * starts unloaded. Moving a loaded texture moves the loaded texture with it,
+ * but moving a texture that is streaming cancels its request. A texture that
+ * is destroyed while loaded or streaming is unloaded first.
+ *
+ * Keep the texture loaded when the renderer's texture budget is exceeded using:
+ *
+ *   - FFG_Texture::set_pinned()
+ *   - FFG_Texture::is_pinned()
  *
  * Example usage:
  * -----------------------------------------------------------------------------
@@ -33,6 +61,9 @@ class FFG_Renderer;
 class FFG_Texture {
 private:
 	friend class FFG_Renderer;
+	friend class FFG_TextureStream;
+private:
+	static unsigned long elided_calls;
 private:
 	FFG_TextureType type;
 	std::string path;
@@ -43,21 +74,64 @@ private:
 	SDL_Texture* texture;
 	int loaded_width;
 	int loaded_height;
+	Uint32 format;
+	FFG_BlendMode blend_mode;
+	Uint8 mod_r;
+	Uint8 mod_g;
+	Uint8 mod_b;
+	Uint8 mod_a;
+	unsigned long deferred_frame;
+	unsigned int deferred_slot;
+	unsigned long deferred_target_frame;
+	unsigned int deferred_target_slot;
+	unsigned long stream_ticket;        // Nonzero while requested from FFG_Renderer and not yet loaded.
+	unsigned long used_frame;
+	std::size_t resident_bytes;
+	int resident_slot;                  // The index in FFG_Renderer's resident textures, or -1.
+	bool pinned;
+	bool evicted;
+	bool cached;                        // Owned by FFG_Renderer's texture cache.
+	unsigned int cache_references;
+	SDL_Texture* back_texture;          // The buffer of a streaming texture not being drawn.
+	std::vector<Uint8> lock_pixels;     // Every pixel of a streaming texture, as last written.
+	int lock_pitch;
+	SDL_Rect lock_rect;
+	bool locked;
+	SDL_Rect back_damage;               // The area the back buffer has not been updated with yet.
+	unsigned long swap_frame;           // The deferred frame the buffers were last swapped during.
+	FFG_Renderer* owner;                // The renderer the texture was last loaded or requested with.
+private:
+	static SDL_BlendMode sdl_blend_mode(FFG_BlendMode mode);
+	void copy_source(const FFG_Texture& other);
+	void take(FFG_Texture& other);
+	void release();
 public:
 	// CONSTRUCTION:
 	FFG_Texture();
 	FFG_Texture(const std::string& path);
 	FFG_Texture(void* const mem, const unsigned int size_b);
 	FFG_Texture(const int width, const int height);
+	FFG_Texture(const FFG_Texture& other);
+	FFG_Texture(FFG_Texture&& other) noexcept;
+	FFG_Texture& operator=(const FFG_Texture& other);
+	FFG_Texture& operator=(FFG_Texture&& other) noexcept;
+	~FFG_Texture();
 	// SETTERS:
 	void set(const std::string& path);
 	void set(void* const mem, const unsigned int size_b);
 	void set(const int width, const int height);
+	void set_streaming(const int width, const int height);
 	// INFO & MODIFICATION:
 	bool is_loaded() const;
+	bool is_streaming() const;
 	int get_width() const;
 	int get_height() const;
+	Uint32 get_format() const;
 	bool set_mod_color(int r, int g, int b);
+	bool set_mod_alpha(int a);
+	bool set_blend_mode(FFG_BlendMode mode);
+	void set_pinned(bool pinned);
+	bool is_pinned() const;
 };
 
 #endif // FFG_TEXTURE_H_INCLUDED
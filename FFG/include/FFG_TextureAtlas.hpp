@@ -0,0 +1,80 @@
+#ifndef FFG_TEXTUREATLAS_H_INCLUDED
+#define FFG_TEXTUREATLAS_H_INCLUDED
+
+#include <string>
+#include <vector>
+#include "FFG_Constants.hpp"
+#include "FFG_Rect.hpp"
+#include "FFG_Texture.hpp"
+class FFG_Renderer;
+
+/***************************************************************************//**
+ * Texture atlas representation. Packs many small images into one or a few
+ * large textures, called pages, when loaded with FFG_Renderer::load_atlas().
+ * Drawing several images that share a page does not require a texture switch,
+ * which allows their draws to be batched.
+ *
+ * Add images to the atlas before it is loaded using:
+ *
+ *   - FFG_TextureAtlas::add()
+ *
+ * Each call returns the ID of the image. Once the atlas is loaded, the page and
+ * the area of the page holding the image are retrieved using:
+ *
+ *   - FFG_TextureAtlas::get_texture()
+ *   - FFG_TextureAtlas::get_source()
+ *
+ * These can be passed directly to FFG_Renderer::draw(). Images are packed onto
+ * shelves, tallest first, and each is bordered by FFG_ATLAS_PADDING pixels
+ * copied from its edges, except where it meets the edge of a page. Pages are no
+ * larger than the page size given on construction or the largest texture size
+ * supported by the renderer, whichever is smaller.
+ *
+ * Example usage:
+ * -----------------------------------------------------------------------------
+ * TODO: Add example usage.
+ * -----------------------------------------------------------------------------
+ ******************************************************************************/
+class FFG_TextureAtlas {
+private:
+	friend class FFG_Renderer;
+private:
+	class FFG_AtlasShelf {
+	public:
+		FFG_AtlasShelf(int page, int y, int height);
+	public:
+		int page;
+		int y;
+		int height;
+		int x;
+	};
+	class FFG_AtlasEntry {
+	public:
+		FFG_AtlasEntry();
+	public:
+		FFG_Texture source;
+		int page;
+		FFG_Rect rect;
+	};
+private:
+	int page_size;
+	std::vector<FFG_AtlasEntry> entries;
+	std::vector<FFG_Texture> pages;
+	std::vector<FFG_Rect> page_extents;
+private:
+	bool pack(int max_page_size);
+public:
+	// CONSTRUCTION:
+	FFG_TextureAtlas(const int page_size = FFG_ATLAS_DEFAULT_PAGE_SIZE);
+	// SETTERS:
+	unsigned int add(const std::string& path);
+	unsigned int add(void* const mem, const unsigned int size_b);
+	// INFO:
+	bool is_loaded() const;
+	unsigned int size() const;
+	unsigned int num_pages() const;
+	FFG_Texture& get_texture(unsigned int id);
+	FFG_Rect& get_source(unsigned int id);
+};
+
+#endif // FFG_TEXTUREATLAS_H_INCLUDED
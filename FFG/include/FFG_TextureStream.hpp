@@ -0,0 +1,80 @@
+#ifndef FFG_TEXTURESTREAM_H_INCLUDED
+#define FFG_TEXTURESTREAM_H_INCLUDED
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <SDL2/SDL.h>
+#include <thread>
+#include <vector>
+#include "FFG_Constants.hpp"
+#include "FFG_Texture.hpp"
+class FFG_Renderer;
+
+/***************************************************************************//**
+ * Texture streaming representation. Is owned by FFG_Renderer. Holds a queue of
+ * requested textures and a background thread that decodes them, highest
+ * priority first, and converts them to the renderer's native pixel format.
+ * Decoded images wait until FFG_Renderer uploads them, which the engine does
+ * once per frame for as long as its upload budget allows, so that many
+ * requests never stall a single frame. Requests of equal priority are handled
+ * in the order they were made.
+ *
+ * Streaming is controlled through FFG_Renderer using:
+ *
+ *   - FFG_Renderer::request_texture()
+ *   - FFG_Renderer::cancel_texture()
+ *   - FFG_Renderer::set_upload_budget()
+ *   - FFG_Renderer::set_placeholder()
+ *   - FFG_Renderer::streaming_textures()
+ *
+ * Example usage:
+ * -----------------------------------------------------------------------------
+ * TODO: Add example usage.
+ * -----------------------------------------------------------------------------
+ ******************************************************************************/
+class FFG_TextureStream {
+private:
+	friend class FFG_Renderer;
+private:
+	class FFG_StreamRequest {
+	public:
+		FFG_StreamRequest();
+	public:
+		FFG_Texture* texture;
+		unsigned long ticket;           // Orders requests of equal priority.
+		int priority;
+		SDL_Surface* surface;           // Once decoded. Stays nullptr if decoding failed.
+	};
+private:
+	Uint32 format;
+	std::vector<FFG_StreamRequest> pending;     // Guarded by mutex.
+	std::vector<FFG_StreamRequest> ready;       // Guarded by mutex.
+	FFG_Texture* decoding;                      // Guarded by mutex.
+	bool decoding_cancelled;                    // Guarded by mutex.
+	bool running;                               // Guarded by mutex.
+	std::function<void(FFG_Texture&, SDL_Surface*)> filter;  // Guarded by mutex.
+	unsigned long next_ticket;                  // Main thread only.
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::thread worker;
+private:
+	static unsigned int first(const std::vector<FFG_StreamRequest>& requests);
+	void decode_requests();
+	void request(FFG_Texture& texture, int priority);
+	void cancel(FFG_Texture& texture);
+	bool take_ready(FFG_StreamRequest& request);
+	void set_filter(const std::function<void(FFG_Texture&, SDL_Surface*)>& filter);
+public:
+	// CONSTRUCTION:
+	FFG_TextureStream();
+	~FFG_TextureStream();
+	// CONTROL:
+	bool start(Uint32 format);
+	void stop();
+	// INFO:
+	bool is_running() const;
+	unsigned int size();
+};
+
+#endif // FFG_TEXTURESTREAM_H_INCLUDED
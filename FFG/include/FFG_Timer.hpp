@@ -2,7 +2,7 @@
 #define FFG_TIMER_H_INCLUDED
 
 #include <chrono>
-#include <SDL2/Sdl.h>
+#include <SDL2/SDL.h>
 #include <thread>
 #include "FFG_Constants.hpp"
 
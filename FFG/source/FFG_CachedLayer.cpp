@@ -0,0 +1,110 @@
+#include "FFG_CachedLayer.hpp"
+
+/***************************************************************************//**
+ * Constructor.
+ ******************************************************************************/
+FFG_CachedLayer::FFG_CachedLayer() {
+	area = { 0, 0, 0, 0 };
+	moved_from = { 0, 0, 0, 0 };
+	z_p = 0;
+	dirty = true;
+	moved = false;
+}
+
+/***************************************************************************//**
+ * Setting constructor. Refer to set.
+ * @param width The width of the layer.
+ * @param height The height of the layer.
+ * @param redraw Called to redraw the layer onto the current render target.
+ * @param z The z value of the layer.
+ ******************************************************************************/
+FFG_CachedLayer::FFG_CachedLayer(const int width, const int height, const std::function<void()>& redraw, const int z) : FFG_CachedLayer() {
+	set(width, height, redraw);
+	z_p = z;
+}
+
+/***************************************************************************//**
+ * Sets the size of the layer and the callback that redraws it. Should only be
+ * called while the layer is not added to the renderer.
+ * @param width The width of the layer.
+ * @param height The height of the layer.
+ * @param redraw Called to redraw the layer onto the current render target.
+ ******************************************************************************/
+void FFG_CachedLayer::set(const int width, const int height, const std::function<void()>& redraw) {
+	texture.set(width, height);
+	area.w = width;
+	area.h = height;
+	this->redraw = redraw;
+	dirty = true;
+}
+
+/***************************************************************************//**
+ * Sets where the top left of the layer is drawn on the screen. With dirty
+ * rendering on, both the area the layer moved from and the area it moved to are
+ * damaged on the next frame.
+ * @param x The x-coordinate.
+ * @param y The y-coordinate.
+ ******************************************************************************/
+void FFG_CachedLayer::set_position(const int x, const int y) {
+	if (x == area.x && y == area.y) return;
+	if (!moved) {
+		moved_from = area;
+		moved = true;
+	}
+	area.x = x;
+	area.y = y;
+}
+
+/***************************************************************************//**
+ * Sets the z value of the layer. Layers are composited from lowest to highest
+ * z. Layers with the same z are composited in the order they were added. With
+ * dirty rendering on, the layer's area is damaged on the next frame.
+ * @param z The z value.
+ ******************************************************************************/
+void FFG_CachedLayer::set_z(const int z) {
+	if (z == z_p) return;
+	if (!moved) {
+		moved_from = area;
+		moved = true;
+	}
+	z_p = z;
+}
+
+/***************************************************************************//**
+ * Marks the layer to be redrawn the next time it is composited.
+ ******************************************************************************/
+void FFG_CachedLayer::invalidate() {
+	dirty = true;
+}
+
+/***************************************************************************//**
+ * Indicates if the layer will be redrawn the next time it is composited.
+ * @return True if the layer is dirty, otherwise false.
+ ******************************************************************************/
+bool FFG_CachedLayer::is_dirty() const {
+	return dirty;
+}
+
+/***************************************************************************//**
+ * Returns the z value of the layer.
+ * @return The z value.
+ ******************************************************************************/
+int FFG_CachedLayer::z() const {
+	return z_p;
+}
+
+/***************************************************************************//**
+ * Returns the area of the screen the layer is drawn to.
+ * @return The area of the screen.
+ ******************************************************************************/
+const FFG_Rect& FFG_CachedLayer::get_area() const {
+	return area;
+}
+
+/***************************************************************************//**
+ * Returns the texture holding the layer's contents.
+ * @return The texture.
+ ******************************************************************************/
+FFG_Texture& FFG_CachedLayer::get_texture() {
+	return texture;
+}
@@ -41,6 +41,10 @@ void FFG_Engine::handle() {
 				is_quit = true;
 				return;
 			}
+			// The contents of render targets were lost, so cached layers must be redrawn:
+			if (FFG_Event::window_type == FFG_EVENT_WINDOW_RENDER_RESET) {
+				FFG_Renderer::invalidate_targets();
+			}
 		}
 		FFG_StateManager::handle();
 	}
@@ -55,12 +59,21 @@ void FFG_Engine::update() {
 }
 
 /***************************************************************************//**
- * Private. Renders the current state if the window is in focus. The buffer is
- * automatically presented. If the window is out of focus, will delay.
+ * Private. Renders the current state if the window is in focus, along with the
+ * cached layers behind and in front of it. The buffer is automatically
+ * presented. If the window is out of focus, will delay. With
+ * dirty rendering, the state is only rendered if part of the screen is damaged.
+ * Streamed textures are uploaded first, within the upload budget.
  * NOTE: This method is core loop critical.
  ******************************************************************************/
 void FFG_Engine::render() {
-	FFG_StateManager::render();
+	FFG_Renderer::upload_streamed();
+	if (FFG_Renderer::begin_frame()) {
+		FFG_Renderer::composite_layers(false);
+		FFG_StateManager::render();
+		FFG_Renderer::composite_layers(true);
+	}
+	FFG_Renderer::end_frame();
 	if (!FFG_StateManager::next_state_set() && !is_quit) {
 		FFG_Renderer::present();
 	}
@@ -97,6 +110,10 @@ int FFG_Engine::run() {
 				break;
 			}
 		}
+		// Unload cached textures the new state did not acquire:
+		FFG_Renderer::collect_textures();
+		// A new state draws the whole screen:
+		FFG_Renderer::damage_all();
 		// Quit if indicated to do so by state init or exit:
 		if (is_quit) break;
 		while (true) {
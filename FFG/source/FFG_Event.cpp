@@ -158,6 +158,10 @@ bool FFG_Event::poll_event() {
 		} else if (event.window.event == SDL_WINDOWEVENT_FOCUS_GAINED) {
 			window_type = FFG_EVENT_WINDOW_GAINEDFOCUS;
 		}
+	} else if (event.type == SDL_RENDER_TARGETS_RESET) {
+		// RENDER TARGETS RESET:
+		type = FFG_EVENT_WINDOW_EVENT;
+		window_type = FFG_EVENT_WINDOW_RENDER_RESET;
 	} else if (event.type == SDL_QUIT) {
 		// QUIT EVENT:
 		type = FFG_EVENT_WINDOW_EVENT;
@@ -0,0 +1,187 @@
+#include <cstdio>
+#include "FFG_FrameCapture.hpp"
+
+/***************************************************************************//**
+ * Constructor.
+ ******************************************************************************/
+FFG_FrameCapture::FFG_CaptureFrame::FFG_CaptureFrame() {
+	width = 0;
+	height = 0;
+	number = 0;
+}
+
+/***************************************************************************//**
+ * Private. Returns the next free frame buffer, sized for a frame. Buffers only
+ * allocate if the frame is larger than any frame they have held before. Called
+ * from the main thread only.
+ * NOTE: This method is core loop critical.
+ * @param width The width of the frame.
+ * @param height The height of the frame.
+ * @return The frame buffer, or nullptr if every buffer is waiting to be
+ * written.
+ ******************************************************************************/
+FFG_FrameCapture::FFG_CaptureFrame* FFG_FrameCapture::acquire(int width, int height) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (filled == frames.size()) {
+			dropped++;
+			next_number++;
+			return nullptr;
+		}
+	}
+	// The buffer at head is not touched by the worker until it is submitted:
+	FFG_CaptureFrame& frame = frames[head];
+	frame.width = width;
+	frame.height = height;
+	frame.number = next_number++;
+	frame.pixels.resize((std::size_t)width * height * 4);
+	return &frame;
+}
+
+/***************************************************************************//**
+ * Private. Hands the frame buffer last returned by acquire() to the worker
+ * thread. Called from the main thread only.
+ * NOTE: This method is core loop critical.
+ ******************************************************************************/
+void FFG_FrameCapture::submit() {
+	head = (head + 1) % frames.size();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		filled++;
+	}
+	condition.notify_one();
+	captured++;
+}
+
+/***************************************************************************//**
+ * Private. Body of the worker thread. Writes filled frames in order until
+ * stopped, then writes any frames still waiting before returning.
+ ******************************************************************************/
+void FFG_FrameCapture::write_frames() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		condition.wait(lock, [this]() { return filled > 0 || !running; });
+		if (filled == 0) break;
+		// Encode without holding the lock, so the main thread is never blocked on it:
+		lock.unlock();
+		if (write_frame(frames[tail])) failed++;
+		tail = (tail + 1) % frames.size();
+		lock.lock();
+		filled--;
+	}
+}
+
+/***************************************************************************//**
+ * Private. Encodes a frame as a .png and writes it to disk. Called from the
+ * worker thread only.
+ * @param frame The frame to write.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_FrameCapture::write_frame(const FFG_CaptureFrame& frame) {
+	if (frame.pixels.empty()) return true;
+	char number[32];
+	std::snprintf(number, sizeof(number), "%06lu", frame.number);
+	const std::string path = path_prefix + number + ".png";
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom((void*)frame.pixels.data(), frame.width, frame.height, 32, frame.width * 4, SDL_PIXELFORMAT_RGBA32);
+	if (!surface) return true;
+	const bool failed = IMG_SavePNG(surface, path.c_str());
+	SDL_FreeSurface(surface);
+	return failed;
+}
+
+/***************************************************************************//**
+ * Constructor.
+ ******************************************************************************/
+FFG_FrameCapture::FFG_FrameCapture() {
+	head = 0;
+	tail = 0;
+	filled = 0;
+	running = false;
+	next_number = 0;
+	captured = 0;
+	dropped = 0;
+	failed = 0;
+}
+
+/***************************************************************************//**
+ * Destructor. Stops capturing, waiting for any frames still being written.
+ ******************************************************************************/
+FFG_FrameCapture::~FFG_FrameCapture() {
+	stop();
+}
+
+/***************************************************************************//**
+ * Starts capturing. Allocates the frame buffers and starts the worker thread.
+ * Resets the frame number and counters.
+ * @param path_prefix The path each frame's number and extension are added to.
+ * @param ring_size The number of frame buffers. At least one is used.
+ * @param width The expected width of a frame.
+ * @param height The expected height of a frame.
+ * @return False on success. Otherwise true, if already capturing.
+ ******************************************************************************/
+bool FFG_FrameCapture::start(const std::string& path_prefix, unsigned int ring_size, int width, int height) {
+	if (is_running()) return true;
+	if (ring_size < 1) ring_size = 1;
+	if (width < 0) width = 0;
+	if (height < 0) height = 0;
+	this->path_prefix = path_prefix;
+	frames.resize(ring_size);
+	for (FFG_CaptureFrame& frame : frames) frame.pixels.resize((std::size_t)width * height * 4);
+	head = 0;
+	tail = 0;
+	filled = 0;
+	next_number = 0;
+	captured = 0;
+	dropped = 0;
+	failed = 0;
+	running = true;
+	worker = std::thread(&FFG_FrameCapture::write_frames, this);
+	return false;
+}
+
+/***************************************************************************//**
+ * Stops capturing. Waits for the frames already captured to be written. Does
+ * nothing if not capturing.
+ ******************************************************************************/
+void FFG_FrameCapture::stop() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		running = false;
+	}
+	condition.notify_one();
+	if (worker.joinable()) worker.join();
+}
+
+/***************************************************************************//**
+ * Indicates if capturing.
+ * @return True if capturing, otherwise false.
+ ******************************************************************************/
+bool FFG_FrameCapture::is_running() const {
+	return worker.joinable();
+}
+
+/***************************************************************************//**
+ * Returns the number of frames handed to the worker thread since capturing
+ * started.
+ * @return The number of frames captured.
+ ******************************************************************************/
+unsigned long FFG_FrameCapture::captured_frames() const {
+	return captured;
+}
+
+/***************************************************************************//**
+ * Returns the number of frames dropped because every buffer was still waiting
+ * to be written.
+ * @return The number of frames dropped.
+ ******************************************************************************/
+unsigned long FFG_FrameCapture::dropped_frames() const {
+	return dropped;
+}
+
+/***************************************************************************//**
+ * Returns the number of captured frames that failed to be encoded or written.
+ * @return The number of frames that failed.
+ ******************************************************************************/
+unsigned long FFG_FrameCapture::failed_frames() const {
+	return failed;
+}
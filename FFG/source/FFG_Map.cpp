@@ -0,0 +1,153 @@
+#include "FFG_Map.hpp"
+
+/***************************************************************************//**
+ * Constructor.
+ ******************************************************************************/
+FFG_Map::FFG_MapChunk::FFG_MapChunk() {
+	slot = -1;
+	dirty = true;
+	last_drawn = 0;
+}
+
+/***************************************************************************//**
+ * Constructor.
+ ******************************************************************************/
+FFG_Map::FFG_Map() {
+	width_p = 0;
+	height_p = 0;
+	tile_width_p = 1;
+	tile_height_p = 1;
+	chunk_size_p = FFG_MAP_DEFAULT_CHUNK_SIZE;
+	chunks_x = 0;
+	chunks_y = 0;
+	max_baked_chunks = FFG_MAP_DEFAULT_MAX_BAKED_CHUNKS;
+	tileset = nullptr;
+}
+
+/***************************************************************************//**
+ * Setting constructor. Refer to set.
+ * @param width The width of the map, in tiles.
+ * @param height The height of the map, in tiles.
+ * @param tile_width The width of a tile, in pixels.
+ * @param tile_height The height of a tile, in pixels.
+ * @param chunk_size The width and height of a chunk, in tiles.
+ ******************************************************************************/
+FFG_Map::FFG_Map(const int width, const int height, const int tile_width, const int tile_height, const int chunk_size) : FFG_Map() {
+	set(width, height, tile_width, tile_height, chunk_size);
+}
+
+/***************************************************************************//**
+ * Sets the size of the map and its tiles. Every tile is set to
+ * FFG_MAP_EMPTY_TILE. Should only be called while the map is not loaded.
+ * @param width The width of the map, in tiles.
+ * @param height The height of the map, in tiles.
+ * @param tile_width The width of a tile, in pixels.
+ * @param tile_height The height of a tile, in pixels.
+ * @param chunk_size The width and height of a chunk, in tiles.
+ ******************************************************************************/
+void FFG_Map::set(const int width, const int height, const int tile_width, const int tile_height, const int chunk_size) {
+	width_p = (width < 0) ? 0 : width;
+	height_p = (height < 0) ? 0 : height;
+	tile_width_p = (tile_width < 1) ? 1 : tile_width;
+	tile_height_p = (tile_height < 1) ? 1 : tile_height;
+	chunk_size_p = (chunk_size < 1) ? 1 : chunk_size;
+	chunks_x = (width_p + chunk_size_p - 1) / chunk_size_p;
+	chunks_y = (height_p + chunk_size_p - 1) / chunk_size_p;
+	tiles.assign(width_p * height_p, FFG_MAP_EMPTY_TILE);
+	chunks.assign(chunks_x * chunks_y, FFG_MapChunk());
+}
+
+/***************************************************************************//**
+ * Sets the texture tiles are drawn from. The tileset must be loaded before the
+ * map is drawn, and must remain valid while the map is in use. Every chunk is
+ * redrawn.
+ * @param tileset The tileset.
+ ******************************************************************************/
+void FFG_Map::set_tileset(FFG_Texture& tileset) {
+	this->tileset = &tileset;
+	for (FFG_MapChunk& chunk : chunks) chunk.dirty = true;
+}
+
+/***************************************************************************//**
+ * Sets the largest number of chunks kept baked at once. Should only be called
+ * while the map is not loaded.
+ * @param max_baked_chunks The number of chunks. At least one is used.
+ ******************************************************************************/
+void FFG_Map::set_max_baked_chunks(const unsigned int max_baked_chunks) {
+	this->max_baked_chunks = (max_baked_chunks < 1) ? 1 : max_baked_chunks;
+}
+
+/***************************************************************************//**
+ * Sets the tile at a cell. The chunk holding the cell is redrawn the next time
+ * it is drawn. Cells outside the map are ignored.
+ * @param x The x-coordinate of the cell.
+ * @param y The y-coordinate of the cell.
+ * @param tile The index of the tile in the tileset, or FFG_MAP_EMPTY_TILE.
+ ******************************************************************************/
+void FFG_Map::set_tile(const int x, const int y, const int tile) {
+	if (x < 0 || y < 0 || x >= width_p || y >= height_p) return;
+	int& cell = tiles[y * width_p + x];
+	if (cell == tile) return;
+	cell = tile;
+	chunks[(y / chunk_size_p) * chunks_x + (x / chunk_size_p)].dirty = true;
+}
+
+/***************************************************************************//**
+ * Returns the tile at a cell.
+ * @param x The x-coordinate of the cell.
+ * @param y The y-coordinate of the cell.
+ * @return The index of the tile, or FFG_MAP_EMPTY_TILE if the cell is empty or
+ * outside the map.
+ ******************************************************************************/
+int FFG_Map::get_tile(const int x, const int y) const {
+	if (x < 0 || y < 0 || x >= width_p || y >= height_p) return FFG_MAP_EMPTY_TILE;
+	return tiles[y * width_p + x];
+}
+
+/***************************************************************************//**
+ * Returns the width of the map.
+ * @return The width of the map, in tiles.
+ ******************************************************************************/
+int FFG_Map::width() const {
+	return width_p;
+}
+
+/***************************************************************************//**
+ * Returns the height of the map.
+ * @return The height of the map, in tiles.
+ ******************************************************************************/
+int FFG_Map::height() const {
+	return height_p;
+}
+
+/***************************************************************************//**
+ * Returns the width of a tile.
+ * @return The width of a tile, in pixels.
+ ******************************************************************************/
+int FFG_Map::tile_width() const {
+	return tile_width_p;
+}
+
+/***************************************************************************//**
+ * Returns the height of a tile.
+ * @return The height of a tile, in pixels.
+ ******************************************************************************/
+int FFG_Map::tile_height() const {
+	return tile_height_p;
+}
+
+/***************************************************************************//**
+ * Returns the width and height of a chunk.
+ * @return The width and height of a chunk, in tiles.
+ ******************************************************************************/
+int FFG_Map::chunk_size() const {
+	return chunk_size_p;
+}
+
+/***************************************************************************//**
+ * Indicates if the map is loaded.
+ * @return True if the map is loaded, otherwise false.
+ ******************************************************************************/
+bool FFG_Map::is_loaded() const {
+	return !slots.empty();
+}
@@ -0,0 +1,169 @@
+#include "FFG_MapHex.hpp"
+
+/***************************************************************************//**
+ * Constructor.
+ ******************************************************************************/
+FFG_MapHex::FFG_MapHex() {
+	width_p = 0;
+	height_p = 0;
+	hex_width_p = 1;
+	hex_height_p = 1;
+	row_height_p = 1;
+	tileset = nullptr;
+}
+
+/***************************************************************************//**
+ * Setting constructor. Refer to set.
+ * @param width The width of the map, in cells.
+ * @param height The height of the map, in rows.
+ * @param hex_width The width of a hex, in pixels.
+ * @param hex_height The height of a hex, in pixels.
+ * @param row_height The distance between rows, in pixels, or 0 for three
+ * quarters of the hex height.
+ ******************************************************************************/
+FFG_MapHex::FFG_MapHex(const int width, const int height, const int hex_width, const int hex_height, const int row_height) : FFG_MapHex() {
+	set(width, height, hex_width, hex_height, row_height);
+}
+
+/***************************************************************************//**
+ * Sets the size of the map and its hexes. Every cell is set to
+ * FFG_MAP_EMPTY_TILE.
+ * @param width The width of the map, in cells.
+ * @param height The height of the map, in rows.
+ * @param hex_width The width of a hex, in pixels.
+ * @param hex_height The height of a hex, in pixels.
+ * @param row_height The distance between rows, in pixels, or 0 for three
+ * quarters of the hex height.
+ ******************************************************************************/
+void FFG_MapHex::set(const int width, const int height, const int hex_width, const int hex_height, const int row_height) {
+	width_p = (width < 0) ? 0 : width;
+	height_p = (height < 0) ? 0 : height;
+	hex_width_p = (hex_width < 1) ? 1 : hex_width;
+	hex_height_p = (hex_height < 1) ? 1 : hex_height;
+	row_height_p = (row_height < 1) ? (hex_height_p * 3) / 4 : row_height;
+	if (row_height_p < 1) row_height_p = 1;
+	tiles.assign(width_p * height_p, FFG_MAP_EMPTY_TILE);
+}
+
+/***************************************************************************//**
+ * Sets the texture sprites are drawn from. The tileset must be loaded before
+ * the map is drawn, and must remain valid while the map is in use.
+ * @param tileset The tileset.
+ ******************************************************************************/
+void FFG_MapHex::set_tileset(FFG_Texture& tileset) {
+	this->tileset = &tileset;
+}
+
+/***************************************************************************//**
+ * Sets the sprite of a cell. Cells outside the map are ignored.
+ * @param column The column of the cell.
+ * @param row The row of the cell.
+ * @param tile The index of the sprite in the tileset, or FFG_MAP_EMPTY_TILE.
+ ******************************************************************************/
+void FFG_MapHex::set_tile(const int column, const int row, const int tile) {
+	if (column < 0 || row < 0 || column >= width_p || row >= height_p) return;
+	tiles[row * width_p + column] = tile;
+}
+
+/***************************************************************************//**
+ * Returns the sprite of a cell.
+ * @param column The column of the cell.
+ * @param row The row of the cell.
+ * @return The index of the sprite, or FFG_MAP_EMPTY_TILE if the cell is empty
+ * or outside the map.
+ ******************************************************************************/
+int FFG_MapHex::get_tile(const int column, const int row) const {
+	if (column < 0 || row < 0 || column >= width_p || row >= height_p) return FFG_MAP_EMPTY_TILE;
+	return tiles[row * width_p + column];
+}
+
+/***************************************************************************//**
+ * Returns the width of the map.
+ * @return The width of the map, in cells.
+ ******************************************************************************/
+int FFG_MapHex::width() const {
+	return width_p;
+}
+
+/***************************************************************************//**
+ * Returns the height of the map.
+ * @return The height of the map, in rows.
+ ******************************************************************************/
+int FFG_MapHex::height() const {
+	return height_p;
+}
+
+/***************************************************************************//**
+ * Returns the width of a hex.
+ * @return The width of a hex, in pixels.
+ ******************************************************************************/
+int FFG_MapHex::hex_width() const {
+	return hex_width_p;
+}
+
+/***************************************************************************//**
+ * Returns the height of a hex.
+ * @return The height of a hex, in pixels.
+ ******************************************************************************/
+int FFG_MapHex::hex_height() const {
+	return hex_height_p;
+}
+
+/***************************************************************************//**
+ * Returns the distance between rows.
+ * @return The distance between rows, in pixels.
+ ******************************************************************************/
+int FFG_MapHex::row_height() const {
+	return row_height_p;
+}
+
+/***************************************************************************//**
+ * Retrieves where the top left of a cell's sprite is on the map. The cell does
+ * not need to be within the map.
+ * @param column The column of the cell.
+ * @param row The row of the cell.
+ * @param x Set to the x-coordinate, in map pixels.
+ * @param y Set to the y-coordinate, in map pixels.
+ ******************************************************************************/
+void FFG_MapHex::get_position(const int column, const int row, int* x, int* y) const {
+	*x = column * hex_width_p + (row & 1) * (hex_width_p / 2);
+	*y = row * row_height_p;
+}
+
+/***************************************************************************//**
+ * Finds the cell a point on the map is in. The point is converted to
+ * fractional axial coordinates relative to the center of the first cell, which
+ * are rounded to the nearest hex in cube coordinates and then converted back to
+ * a column and row.
+ * NOTE: This method is core loop critical.
+ * @param x The x-coordinate, in map pixels.
+ * @param y The y-coordinate, in map pixels.
+ * @param column Set to the column of the cell.
+ * @param row Set to the row of the cell.
+ * @return False on success. Otherwise true, if the cell is outside the map, in
+ * which case the column and row are still set.
+ ******************************************************************************/
+bool FFG_MapHex::pick(const int x, const int y, int* column, int* row) const {
+	// Fractional axial coordinates, where centers are at x = w * (q + r / 2), y = h * r:
+	const double fr = (y - hex_height_p * 0.5) / row_height_p;
+	const double fq = (x - hex_width_p * 0.5) / hex_width_p - fr * 0.5;
+	const double fs = -fq - fr;
+	// Round in cube coordinates, fixing up the component that moved the most:
+	double q = std::round(fq);
+	double r = std::round(fr);
+	double s = std::round(fs);
+	const double dq = std::fabs(q - fq);
+	const double dr = std::fabs(r - fr);
+	const double ds = std::fabs(s - fs);
+	if (dq > dr && dq > ds) {
+		q = -r - s;
+	} else if (dr > ds) {
+		r = -q - s;
+	}
+	// Axial to odd row offset coordinates:
+	const int axial_q = (int)q;
+	const int axial_r = (int)r;
+	*row = axial_r;
+	*column = axial_q + (axial_r - (axial_r & 1)) / 2;
+	return *column < 0 || *row < 0 || *column >= width_p || *row >= height_p;
+}
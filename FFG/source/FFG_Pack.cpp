@@ -0,0 +1,190 @@
+#include "FFG_Pack.hpp"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/***************************************************************************//**
+ * Private. Reads a little-endian 32 bit value.
+ * @param p The first byte of the value.
+ * @return The value.
+ ******************************************************************************/
+Uint32 FFG_Pack::read_32(const Uint8* p) {
+	return (Uint32)p[0] | ((Uint32)p[1] << 8) | ((Uint32)p[2] << 16) | ((Uint32)p[3] << 24);
+}
+
+/***************************************************************************//**
+ * Private. Reads a little-endian 64 bit value.
+ * @param p The first byte of the value.
+ * @return The value.
+ ******************************************************************************/
+Uint64 FFG_Pack::read_64(const Uint8* p) {
+	return (Uint64)read_32(p) | ((Uint64)read_32(p + 4) << 32);
+}
+
+/***************************************************************************//**
+ * Constructor.
+ ******************************************************************************/
+FFG_Pack::FFG_Pack() {
+	data = nullptr;
+	size_b = 0;
+	num_entries = 0;
+	capacity = 0;
+#ifdef _WIN32
+	file = INVALID_HANDLE_VALUE;
+	mapping = nullptr;
+#endif
+}
+
+/***************************************************************************//**
+ * Destructor. Closes the pack.
+ ******************************************************************************/
+FFG_Pack::~FFG_Pack() {
+	close();
+}
+
+/***************************************************************************//**
+ * Opens a pack, mapping the file into memory. Closes the pack already open, if
+ * any. Fails if the file is not a pack of the current version.
+ * @param path The path to the pack.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Pack::open(const std::string& path) {
+	close();
+#ifdef _WIN32
+	file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return true;
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart < FFG_PACK_HEADER_SIZE) {
+		close();
+		return true;
+	}
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		close();
+		return true;
+	}
+	data = (const Uint8*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!data) {
+		close();
+		return true;
+	}
+	size_b = file_size.QuadPart;
+#else
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) return true;
+	struct stat info;
+	if (fstat(fd, &info) || info.st_size < FFG_PACK_HEADER_SIZE) {
+		::close(fd);
+		return true;
+	}
+	void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping stays valid after the file is closed:
+	::close(fd);
+	if (mapped == MAP_FAILED) return true;
+	data = (const Uint8*)mapped;
+	size_b = info.st_size;
+#endif
+	// Check the header and that the table fits in the file:
+	num_entries = read_32(data + 8);
+	capacity = read_32(data + 12);
+	if (std::memcmp(data, FFG_PACK_MAGIC, 4) || read_32(data + 4) != FFG_PACK_VERSION || capacity == 0 || (capacity & (capacity - 1)) || num_entries > capacity || FFG_PACK_HEADER_SIZE + (Uint64)capacity * FFG_PACK_SLOT_SIZE > size_b) {
+		close();
+		return true;
+	}
+	return false;
+}
+
+/***************************************************************************//**
+ * Closes the pack, unmapping the file. Does nothing if no pack is open.
+ ******************************************************************************/
+void FFG_Pack::close() {
+#ifdef _WIN32
+	if (data) UnmapViewOfFile(data);
+	if (mapping) CloseHandle(mapping);
+	if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+	mapping = nullptr;
+	file = INVALID_HANDLE_VALUE;
+#else
+	if (data) munmap((void*)data, size_b);
+#endif
+	data = nullptr;
+	size_b = 0;
+	num_entries = 0;
+	capacity = 0;
+}
+
+/***************************************************************************//**
+ * Hashes a name with 64 bit FNV-1a, as the pack's table does.
+ * @param name The name.
+ * @return The hash.
+ ******************************************************************************/
+Uint64 FFG_Pack::hash(const std::string& name) {
+	Uint64 h = 14695981039346656037ULL;
+	for (unsigned char c : name) {
+		h ^= c;
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+/***************************************************************************//**
+ * Finds an entry. The data is returned in place, in the mapped file, and stays
+ * valid until the pack is closed.
+ * @param name The name of the entry.
+ * @param mem Set to the entry's data.
+ * @param size_b Set to the size of the entry's data.
+ * @return False on success. Otherwise true, if there is no such entry.
+ ******************************************************************************/
+bool FFG_Pack::find(const std::string& name, const void** mem, unsigned int* size_b) const {
+	if (!data) return true;
+	const Uint64 h = hash(name);
+	const Uint32 mask = capacity - 1;
+	for (Uint32 probe = 0, i = (Uint32)h & mask; probe < capacity; probe++, i = (i + 1) & mask) {
+		const Uint8* slot = data + FFG_PACK_HEADER_SIZE + (Uint64)i * FFG_PACK_SLOT_SIZE;
+		const Uint64 offset = read_64(slot + 8);
+		if (offset == 0) return true;
+		if (read_64(slot) != h) continue;
+		const Uint64 entry_size = read_64(slot + 16);
+		if (offset > this->size_b || entry_size > this->size_b - offset || entry_size > UINT_MAX) return true;
+		*mem = data + offset;
+		*size_b = (unsigned int)entry_size;
+		return false;
+	}
+	return true;
+}
+
+/***************************************************************************//**
+ * Sets a texture to load from an entry's data in place, with no copying. The
+ * pack must stay open while the texture is loaded, or may be loaded again.
+ * @param name The name of the entry, which must be a .png image.
+ * @param texture The texture to set.
+ * @return False on success. Otherwise true, if there is no such entry.
+ ******************************************************************************/
+bool FFG_Pack::set_texture(const std::string& name, FFG_Texture& texture) const {
+	const void* mem;
+	unsigned int entry_size;
+	if (find(name, &mem, &entry_size)) return true;
+	texture.set(const_cast<void*>(mem), entry_size);
+	return false;
+}
+
+/***************************************************************************//**
+ * Indicates if a pack is open.
+ * @return True if a pack is open, otherwise false.
+ ******************************************************************************/
+bool FFG_Pack::is_open() const {
+	return data != nullptr;
+}
+
+/***************************************************************************//**
+ * Returns the number of entries in the pack.
+ * @return The number of entries, or 0 if no pack is open.
+ ******************************************************************************/
+unsigned int FFG_Pack::size() const {
+	return num_entries;
+}
@@ -0,0 +1,590 @@
+#include "FFG_PixelOps.hpp"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FFG_PIXELOPS_X86
+#include <immintrin.h>
+#define FFG_TARGET_SSE2 __attribute__((target("sse2")))
+#define FFG_TARGET_AVX2 __attribute__((target("avx2")))
+
+/***************************************************************************//**
+ * Multiplies each byte of two vectors, dividing by 255 and rounding. Bytes are
+ * widened to 16 bits, where (t + 128 + ((t + 128) >> 8)) >> 8 is exactly the
+ * rounded quotient of t / 255 for any product of two bytes.
+ * NOTE: This method is core loop critical.
+ ******************************************************************************/
+static inline FFG_TARGET_SSE2 __m128i multiply_sse2(__m128i pixels, __m128i factors) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i half = _mm_set1_epi16(128);
+	__m128i low = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), _mm_unpacklo_epi8(factors, zero)), half);
+	__m128i high = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), _mm_unpackhi_epi8(factors, zero)), half);
+	low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+	high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+	return _mm_packus_epi16(low, high);
+}
+
+/***************************************************************************//**
+ * Spreads the alpha of each pixel over all four of its bytes, then sets the
+ * alpha byte to 255, giving the factors that premultiply the pixel.
+ * NOTE: This method is core loop critical.
+ ******************************************************************************/
+static inline FFG_TARGET_SSE2 __m128i alpha_sse2(__m128i pixels, int shift, __m128i alpha_mask) {
+	__m128i alpha = _mm_and_si128(_mm_srl_epi32(pixels, _mm_cvtsi32_si128(shift)), _mm_set1_epi32(0xFF));
+	alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 8));
+	alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+	return _mm_or_si128(alpha, alpha_mask);
+}
+
+/***************************************************************************//**
+ * The AVX2 version of multiply_sse2(). Unpacking and packing both work within
+ * each 128 bit lane, so the pixels keep their order.
+ * NOTE: This method is core loop critical.
+ ******************************************************************************/
+static inline FFG_TARGET_AVX2 __m256i multiply_avx2(__m256i pixels, __m256i factors) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i half = _mm256_set1_epi16(128);
+	__m256i low = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(pixels, zero), _mm256_unpacklo_epi8(factors, zero)), half);
+	__m256i high = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(pixels, zero), _mm256_unpackhi_epi8(factors, zero)), half);
+	low = _mm256_srli_epi16(_mm256_add_epi16(low, _mm256_srli_epi16(low, 8)), 8);
+	high = _mm256_srli_epi16(_mm256_add_epi16(high, _mm256_srli_epi16(high, 8)), 8);
+	return _mm256_packus_epi16(low, high);
+}
+
+/***************************************************************************//**
+ * The AVX2 version of alpha_sse2().
+ * NOTE: This method is core loop critical.
+ ******************************************************************************/
+static inline FFG_TARGET_AVX2 __m256i alpha_avx2(__m256i pixels, int shift, __m256i alpha_mask) {
+	__m256i alpha = _mm256_and_si256(_mm256_srl_epi32(pixels, _mm_cvtsi32_si128(shift)), _mm256_set1_epi32(0xFF));
+	alpha = _mm256_or_si256(alpha, _mm256_slli_epi32(alpha, 8));
+	alpha = _mm256_or_si256(alpha, _mm256_slli_epi32(alpha, 16));
+	return _mm256_or_si256(alpha, alpha_mask);
+}
+#endif
+
+FFG_SimdLevel FFG_PixelOps::supported_level = FFG_PixelOps::detect_level();
+FFG_SimdLevel FFG_PixelOps::level = FFG_PixelOps::supported_level;
+
+/***************************************************************************//**
+ * Constructor.
+ ******************************************************************************/
+FFG_PixelOps::FFG_PixelLayout::FFG_PixelLayout() {
+	for (int c = 0; c < 4; c++) shifts[c] = -1;
+	alpha_mask = 0;
+}
+
+/***************************************************************************//**
+ * Finds where each channel of a format sits.
+ * @param format The pixel format.
+ * @return False on success. Otherwise true, if the format is not a 32 bit
+ * format with 8 bit red, green and blue channels.
+ ******************************************************************************/
+bool FFG_PixelOps::FFG_PixelLayout::set(Uint32 format) {
+	for (int c = 0; c < 4; c++) shifts[c] = -1;
+	alpha_mask = 0;
+	if (SDL_ISPIXELFORMAT_FOURCC(format) || SDL_BYTESPERPIXEL(format) != 4) return true;
+	int bpp;
+	Uint32 masks[4];
+	if (!SDL_PixelFormatEnumToMasks(format, &bpp, &masks[0], &masks[1], &masks[2], &masks[3])) return true;
+	for (int c = 0; c < 4; c++) {
+		// Only alpha may be missing:
+		if (!masks[c] && c == 3) continue;
+		for (int byte = 0; byte < 4; byte++) {
+			if (masks[c] == 0xFFu << (8 * byte)) shifts[c] = 8 * byte;
+		}
+		if (shifts[c] < 0) return true;
+	}
+	alpha_mask = masks[3];
+	return false;
+}
+
+/***************************************************************************//**
+ * Private. Finds the fastest version of the operations the CPU supports.
+ * @return The SIMD level.
+ ******************************************************************************/
+FFG_SimdLevel FFG_PixelOps::detect_level() {
+#ifdef FFG_PIXELOPS_X86
+	if (SDL_HasAVX2()) return FFG_SIMD_AVX2;
+	if (SDL_HasSSE2()) return FFG_SIMD_SSE2;
+#endif
+	return FFG_SIMD_SCALAR;
+}
+
+/***************************************************************************//**
+ * Private. Multiplies each byte of a pixel by the matching byte of the factors,
+ * dividing by 255 and rounding.
+ * NOTE: This method is core loop critical.
+ * @param pixel The pixel.
+ * @param factors The factors.
+ * @return The product.
+ ******************************************************************************/
+Uint32 FFG_PixelOps::multiply(Uint32 pixel, Uint32 factors) {
+	Uint32 result = 0;
+	for (int shift = 0; shift < 32; shift += 8) {
+		const Uint32 t = ((pixel >> shift) & 0xFF) * ((factors >> shift) & 0xFF) + 128;
+		result |= ((t + (t >> 8)) >> 8) << shift;
+	}
+	return result;
+}
+
+/***************************************************************************//**
+ * Private. Adds each byte of two pixels, saturating at 255.
+ * NOTE: This method is core loop critical.
+ * @param a The first pixel.
+ * @param b The second pixel.
+ * @return The sum.
+ ******************************************************************************/
+Uint32 FFG_PixelOps::add_saturated(Uint32 a, Uint32 b) {
+	Uint32 result = 0;
+	for (int shift = 0; shift < 32; shift += 8) {
+		const Uint32 sum = ((a >> shift) & 0xFF) + ((b >> shift) & 0xFF);
+		result |= (sum > 255 ? 255 : sum) << shift;
+	}
+	return result;
+}
+
+/***************************************************************************//**
+ * Private. Spreads the alpha of a pixel over all four of its bytes, then sets
+ * the alpha byte to 255, giving the factors that premultiply the pixel.
+ * NOTE: This method is core loop critical.
+ * @param pixel The pixel, in a format with alpha.
+ * @param layout The layout of the format.
+ * @return The factors.
+ ******************************************************************************/
+Uint32 FFG_PixelOps::alpha_factors(Uint32 pixel, const FFG_PixelLayout& layout) {
+	return (((pixel >> layout.shifts[3]) & 0xFF) * 0x01010101u) | layout.alpha_mask;
+}
+
+/***************************************************************************//**
+ * Private. Moves each channel of a pixel to where another format keeps it.
+ * NOTE: This method is core loop critical.
+ * @param pixel The pixel.
+ * @param from The layout of the pixel's format.
+ * @param to The layout of the format to convert to.
+ * @param fill The bits to set in every pixel, for an alpha channel the pixel
+ * lacks.
+ * @return The converted pixel.
+ ******************************************************************************/
+Uint32 FFG_PixelOps::convert_pixel(Uint32 pixel, const FFG_PixelLayout& from, const FFG_PixelLayout& to, Uint32 fill) {
+	Uint32 result = fill;
+	for (int c = 0; c < 4; c++) {
+		if (from.shifts[c] >= 0 && to.shifts[c] >= 0) result |= ((pixel >> from.shifts[c]) & 0xFF) << to.shifts[c];
+	}
+	return result;
+}
+
+/***************************************************************************//**
+ * Private. Scalar kernel. Multiplies each pixel by the factors.
+ * NOTE: This method is core loop critical.
+ ******************************************************************************/
+void FFG_PixelOps::tint_scalar(Uint32* pixels, int count, Uint32 factors) {
+	for (int i = 0; i < count; i++) pixels[i] = multiply(pixels[i], factors);
+}
+
+/***************************************************************************//**
+ * Private. Scalar kernel. Multiplies the color of each pixel by its alpha.
+ * NOTE: This method is core loop critical.
+ ******************************************************************************/
+void FFG_PixelOps::premultiply_scalar(Uint32* pixels, int count, const FFG_PixelLayout& layout) {
+	for (int i = 0; i < count; i++) pixels[i] = multiply(pixels[i], alpha_factors(pixels[i], layout));
+}
+
+/***************************************************************************//**
+ * Private. Scalar kernel. Converts each pixel to another format.
+ * NOTE: This method is core loop critical.
+ ******************************************************************************/
+void FFG_PixelOps::convert_scalar(const Uint32* source, Uint32* destination, int count, const FFG_PixelLayout& from, const FFG_PixelLayout& to, Uint32 fill) {
+	for (int i = 0; i < count; i++) destination[i] = convert_pixel(source[i], from, to, fill);
+}
+
+/***************************************************************************//**
+ * Private. Scalar kernel. Blends each source pixel over each destination
+ * pixel.
+ * NOTE: This method is core loop critical.
+ ******************************************************************************/
+void FFG_PixelOps::blend_scalar(const Uint32* source, Uint32* destination, int count, const FFG_PixelLayout& layout) {
+	for (int i = 0; i < count; i++) {
+		const Uint32 spread = ((source[i] >> layout.shifts[3]) & 0xFF) * 0x01010101u;
+		destination[i] = add_saturated(multiply(source[i], spread | layout.alpha_mask), multiply(destination[i], ~spread));
+	}
+}
+
+/***************************************************************************//**
+ * Private. SSE2 kernel. Multiplies pixels by the factors, four at a time.
+ * NOTE: This method is core loop critical.
+ * @return The number of pixels done. The rest are left to the scalar kernel.
+ ******************************************************************************/
+#ifdef FFG_PIXELOPS_X86
+FFG_TARGET_SSE2
+#endif
+int FFG_PixelOps::tint_sse2(Uint32* pixels, int count, Uint32 factors) {
+	int i = 0;
+#ifdef FFG_PIXELOPS_X86
+	const __m128i f = _mm_set1_epi32(factors);
+	for (; i + 4 <= count; i += 4) {
+		__m128i* p = (__m128i*)(pixels + i);
+		_mm_storeu_si128(p, multiply_sse2(_mm_loadu_si128(p), f));
+	}
+#endif
+	return i;
+}
+
+/***************************************************************************//**
+ * Private. SSE2 kernel. Premultiplies pixels, four at a time.
+ * NOTE: This method is core loop critical.
+ * @return The number of pixels done. The rest are left to the scalar kernel.
+ ******************************************************************************/
+#ifdef FFG_PIXELOPS_X86
+FFG_TARGET_SSE2
+#endif
+int FFG_PixelOps::premultiply_sse2(Uint32* pixels, int count, const FFG_PixelLayout& layout) {
+	int i = 0;
+#ifdef FFG_PIXELOPS_X86
+	const __m128i alpha_mask = _mm_set1_epi32(layout.alpha_mask);
+	for (; i + 4 <= count; i += 4) {
+		__m128i* p = (__m128i*)(pixels + i);
+		const __m128i v = _mm_loadu_si128(p);
+		_mm_storeu_si128(p, multiply_sse2(v, alpha_sse2(v, layout.shifts[3], alpha_mask)));
+	}
+#endif
+	return i;
+}
+
+/***************************************************************************//**
+ * Private. SSE2 kernel. Converts pixels, four at a time.
+ * NOTE: This method is core loop critical.
+ * @return The number of pixels done. The rest are left to the scalar kernel.
+ ******************************************************************************/
+#ifdef FFG_PIXELOPS_X86
+FFG_TARGET_SSE2
+#endif
+int FFG_PixelOps::convert_sse2(const Uint32* source, Uint32* destination, int count, const FFG_PixelLayout& from, const FFG_PixelLayout& to, Uint32 fill) {
+	int i = 0;
+#ifdef FFG_PIXELOPS_X86
+	const __m128i byte_mask = _mm_set1_epi32(0xFF);
+	const __m128i fill_bits = _mm_set1_epi32(fill);
+	for (; i + 4 <= count; i += 4) {
+		const __m128i v = _mm_loadu_si128((const __m128i*)(source + i));
+		__m128i result = fill_bits;
+		for (int c = 0; c < 4; c++) {
+			if (from.shifts[c] < 0 || to.shifts[c] < 0) continue;
+			const __m128i channel = _mm_and_si128(_mm_srl_epi32(v, _mm_cvtsi32_si128(from.shifts[c])), byte_mask);
+			result = _mm_or_si128(result, _mm_sll_epi32(channel, _mm_cvtsi32_si128(to.shifts[c])));
+		}
+		_mm_storeu_si128((__m128i*)(destination + i), result);
+	}
+#endif
+	return i;
+}
+
+/***************************************************************************//**
+ * Private. SSE2 kernel. Blends pixels, four at a time.
+ * NOTE: This method is core loop critical.
+ * @return The number of pixels done. The rest are left to the scalar kernel.
+ ******************************************************************************/
+#ifdef FFG_PIXELOPS_X86
+FFG_TARGET_SSE2
+#endif
+int FFG_PixelOps::blend_sse2(const Uint32* source, Uint32* destination, int count, const FFG_PixelLayout& layout) {
+	int i = 0;
+#ifdef FFG_PIXELOPS_X86
+	const __m128i alpha_mask = _mm_set1_epi32(layout.alpha_mask);
+	const __m128i ones = _mm_set1_epi32(-1);
+	for (; i + 4 <= count; i += 4) {
+		const __m128i s = _mm_loadu_si128((const __m128i*)(source + i));
+		__m128i* d = (__m128i*)(destination + i);
+		const __m128i spread = alpha_sse2(s, layout.shifts[3], _mm_setzero_si128());
+		const __m128i over = multiply_sse2(s, _mm_or_si128(spread, alpha_mask));
+		const __m128i under = multiply_sse2(_mm_loadu_si128(d), _mm_xor_si128(spread, ones));
+		_mm_storeu_si128(d, _mm_adds_epu8(over, under));
+	}
+#endif
+	return i;
+}
+
+/***************************************************************************//**
+ * Private. AVX2 kernel. Multiplies pixels by the factors, eight at a time.
+ * NOTE: This method is core loop critical.
+ * @return The number of pixels done. The rest are left to the scalar kernel.
+ ******************************************************************************/
+#ifdef FFG_PIXELOPS_X86
+FFG_TARGET_AVX2
+#endif
+int FFG_PixelOps::tint_avx2(Uint32* pixels, int count, Uint32 factors) {
+	int i = 0;
+#ifdef FFG_PIXELOPS_X86
+	const __m256i f = _mm256_set1_epi32(factors);
+	for (; i + 8 <= count; i += 8) {
+		__m256i* p = (__m256i*)(pixels + i);
+		_mm256_storeu_si256(p, multiply_avx2(_mm256_loadu_si256(p), f));
+	}
+#endif
+	return i;
+}
+
+/***************************************************************************//**
+ * Private. AVX2 kernel. Premultiplies pixels, eight at a time.
+ * NOTE: This method is core loop critical.
+ * @return The number of pixels done. The rest are left to the scalar kernel.
+ ******************************************************************************/
+#ifdef FFG_PIXELOPS_X86
+FFG_TARGET_AVX2
+#endif
+int FFG_PixelOps::premultiply_avx2(Uint32* pixels, int count, const FFG_PixelLayout& layout) {
+	int i = 0;
+#ifdef FFG_PIXELOPS_X86
+	const __m256i alpha_mask = _mm256_set1_epi32(layout.alpha_mask);
+	for (; i + 8 <= count; i += 8) {
+		__m256i* p = (__m256i*)(pixels + i);
+		const __m256i v = _mm256_loadu_si256(p);
+		_mm256_storeu_si256(p, multiply_avx2(v, alpha_avx2(v, layout.shifts[3], alpha_mask)));
+	}
+#endif
+	return i;
+}
+
+/***************************************************************************//**
+ * Private. AVX2 kernel. Converts pixels, eight at a time.
+ * NOTE: This method is core loop critical.
+ * @return The number of pixels done. The rest are left to the scalar kernel.
+ ******************************************************************************/
+#ifdef FFG_PIXELOPS_X86
+FFG_TARGET_AVX2
+#endif
+int FFG_PixelOps::convert_avx2(const Uint32* source, Uint32* destination, int count, const FFG_PixelLayout& from, const FFG_PixelLayout& to, Uint32 fill) {
+	int i = 0;
+#ifdef FFG_PIXELOPS_X86
+	const __m256i byte_mask = _mm256_set1_epi32(0xFF);
+	const __m256i fill_bits = _mm256_set1_epi32(fill);
+	for (; i + 8 <= count; i += 8) {
+		const __m256i v = _mm256_loadu_si256((const __m256i*)(source + i));
+		__m256i result = fill_bits;
+		for (int c = 0; c < 4; c++) {
+			if (from.shifts[c] < 0 || to.shifts[c] < 0) continue;
+			const __m256i channel = _mm256_and_si256(_mm256_srl_epi32(v, _mm_cvtsi32_si128(from.shifts[c])), byte_mask);
+			result = _mm256_or_si256(result, _mm256_sll_epi32(channel, _mm_cvtsi32_si128(to.shifts[c])));
+		}
+		_mm256_storeu_si256((__m256i*)(destination + i), result);
+	}
+#endif
+	return i;
+}
+
+/***************************************************************************//**
+ * Private. AVX2 kernel. Blends pixels, eight at a time.
+ * NOTE: This method is core loop critical.
+ * @return The number of pixels done. The rest are left to the scalar kernel.
+ ******************************************************************************/
+#ifdef FFG_PIXELOPS_X86
+FFG_TARGET_AVX2
+#endif
+int FFG_PixelOps::blend_avx2(const Uint32* source, Uint32* destination, int count, const FFG_PixelLayout& layout) {
+	int i = 0;
+#ifdef FFG_PIXELOPS_X86
+	const __m256i alpha_mask = _mm256_set1_epi32(layout.alpha_mask);
+	const __m256i ones = _mm256_set1_epi32(-1);
+	for (; i + 8 <= count; i += 8) {
+		const __m256i s = _mm256_loadu_si256((const __m256i*)(source + i));
+		__m256i* d = (__m256i*)(destination + i);
+		const __m256i spread = alpha_avx2(s, layout.shifts[3], _mm256_setzero_si256());
+		const __m256i over = multiply_avx2(s, _mm256_or_si256(spread, alpha_mask));
+		const __m256i under = multiply_avx2(_mm256_loadu_si256(d), _mm256_xor_si256(spread, ones));
+		_mm256_storeu_si256(d, _mm256_adds_epu8(over, under));
+	}
+#endif
+	return i;
+}
+
+/***************************************************************************//**
+ * Returns the version of the operations in use.
+ * @return The SIMD level.
+ ******************************************************************************/
+FFG_SimdLevel FFG_PixelOps::simd_level() {
+	return level;
+}
+
+/***************************************************************************//**
+ * Sets the version of the operations to use, such as to compare the versions.
+ * Levels the CPU does not support are lowered to the highest it does. Not safe
+ * to call while operations run on other threads.
+ * @param level The SIMD level.
+ * @return The SIMD level now in use.
+ ******************************************************************************/
+FFG_SimdLevel FFG_PixelOps::set_simd_level(FFG_SimdLevel level) {
+	FFG_PixelOps::level = (level > supported_level) ? supported_level : level;
+	return FFG_PixelOps::level;
+}
+
+/***************************************************************************//**
+ * Indicates if a pixel format can be operated on: 32 bit formats with 8 bit
+ * red, green and blue channels, and optionally an 8 bit alpha channel.
+ * @param format The pixel format.
+ * @return True if the format can be operated on, otherwise false.
+ ******************************************************************************/
+bool FFG_PixelOps::supports(Uint32 format) {
+	FFG_PixelLayout layout;
+	return !layout.set(format);
+}
+
+/***************************************************************************//**
+ * Multiplies each channel of each pixel by a tint, as color modulation does
+ * when drawing, so the tint can be baked in ahead of time. Channels the format
+ * lacks are ignored.
+ * NOTE: This method is core loop critical.
+ * @param pixels The pixels.
+ * @param count The number of pixels.
+ * @param format The pixel format.
+ * @param r The red tint, where 255 leaves red unchanged.
+ * @param g The green tint.
+ * @param b The blue tint.
+ * @param a The alpha tint.
+ * @return False on success. Otherwise true, if the format is not supported.
+ ******************************************************************************/
+bool FFG_PixelOps::tint(Uint32* pixels, int count, Uint32 format, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+	FFG_PixelLayout layout;
+	if (layout.set(format)) return true;
+	const Uint8 tints[4] = { r, g, b, a };
+	Uint32 factors = 0xFFFFFFFF;
+	for (int c = 0; c < 4; c++) {
+		if (layout.shifts[c] >= 0) factors = (factors & ~(0xFFu << layout.shifts[c])) | ((Uint32)tints[c] << layout.shifts[c]);
+	}
+	int done = 0;
+	if (level == FFG_SIMD_AVX2) done = tint_avx2(pixels, count, factors);
+	else if (level == FFG_SIMD_SSE2) done = tint_sse2(pixels, count, factors);
+	tint_scalar(pixels + done, count - done, factors);
+	return false;
+}
+
+/***************************************************************************//**
+ * Multiplies the color of each pixel by its alpha. Premultiplied pixels
+ * filter and blend without dark fringes. Pixels in formats without alpha are
+ * left unchanged.
+ * NOTE: This method is core loop critical.
+ * @param pixels The pixels.
+ * @param count The number of pixels.
+ * @param format The pixel format.
+ * @return False on success. Otherwise true, if the format is not supported.
+ ******************************************************************************/
+bool FFG_PixelOps::premultiply(Uint32* pixels, int count, Uint32 format) {
+	FFG_PixelLayout layout;
+	if (layout.set(format)) return true;
+	if (layout.shifts[3] < 0) return false;
+	int done = 0;
+	if (level == FFG_SIMD_AVX2) done = premultiply_avx2(pixels, count, layout);
+	else if (level == FFG_SIMD_SSE2) done = premultiply_sse2(pixels, count, layout);
+	premultiply_scalar(pixels + done, count - done, layout);
+	return false;
+}
+
+/***************************************************************************//**
+ * Converts pixels to another format. Converting from a format without alpha
+ * to one with alpha makes every pixel opaque. The source and destination may
+ * be the same.
+ * NOTE: This method is core loop critical.
+ * @param source The pixels to convert.
+ * @param destination The buffer to write the converted pixels to.
+ * @param count The number of pixels.
+ * @param source_format The pixel format of the source.
+ * @param destination_format The pixel format to convert to.
+ * @return False on success. Otherwise true, if either format is not supported.
+ ******************************************************************************/
+bool FFG_PixelOps::convert(const Uint32* source, Uint32* destination, int count, Uint32 source_format, Uint32 destination_format) {
+	FFG_PixelLayout from, to;
+	if (from.set(source_format) || to.set(destination_format)) return true;
+	const Uint32 fill = (from.shifts[3] < 0) ? to.alpha_mask : 0;
+	int done = 0;
+	if (level == FFG_SIMD_AVX2) done = convert_avx2(source, destination, count, from, to, fill);
+	else if (level == FFG_SIMD_SSE2) done = convert_sse2(source, destination, count, from, to, fill);
+	convert_scalar(source + done, destination + done, count - done, from, to, fill);
+	return false;
+}
+
+/***************************************************************************//**
+ * Blends pixels over others, as SDL's alpha blending does: each color becomes
+ * the source color times the source alpha, plus the destination color times
+ * one minus the source alpha, and the alpha becomes the source alpha plus the
+ * destination alpha times one minus the source alpha. In formats without alpha
+ * the source is opaque, and is copied.
+ * NOTE: This method is core loop critical.
+ * @param source The pixels to blend.
+ * @param destination The pixels to blend over, which are overwritten.
+ * @param count The number of pixels.
+ * @param format The pixel format of both.
+ * @return False on success. Otherwise true, if the format is not supported.
+ ******************************************************************************/
+bool FFG_PixelOps::blend(const Uint32* source, Uint32* destination, int count, Uint32 format) {
+	FFG_PixelLayout layout;
+	if (layout.set(format)) return true;
+	if (layout.shifts[3] < 0) {
+		std::memmove(destination, source, (std::size_t)count * 4);
+		return false;
+	}
+	int done = 0;
+	if (level == FFG_SIMD_AVX2) done = blend_avx2(source, destination, count, layout);
+	else if (level == FFG_SIMD_SSE2) done = blend_sse2(source, destination, count, layout);
+	blend_scalar(source + done, destination + done, count - done, layout);
+	return false;
+}
+
+/***************************************************************************//**
+ * Tints every pixel of a surface. See tint().
+ * @param surface The surface.
+ * @param r The red tint, where 255 leaves red unchanged.
+ * @param g The green tint.
+ * @param b The blue tint.
+ * @param a The alpha tint.
+ * @return False on success. Otherwise true, if the surface's format is not
+ * supported.
+ ******************************************************************************/
+bool FFG_PixelOps::tint_surface(SDL_Surface* surface, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+	if (!surface || !supports(surface->format->format) || SDL_LockSurface(surface)) return true;
+	for (int y = 0; y < surface->h; y++) tint((Uint32*)((Uint8*)surface->pixels + (std::size_t)y * surface->pitch), surface->w, surface->format->format, r, g, b, a);
+	SDL_UnlockSurface(surface);
+	return false;
+}
+
+/***************************************************************************//**
+ * Premultiplies every pixel of a surface. See premultiply().
+ * @param surface The surface.
+ * @return False on success. Otherwise true, if the surface's format is not
+ * supported.
+ ******************************************************************************/
+bool FFG_PixelOps::premultiply_surface(SDL_Surface* surface) {
+	if (!surface || !supports(surface->format->format) || SDL_LockSurface(surface)) return true;
+	for (int y = 0; y < surface->h; y++) premultiply((Uint32*)((Uint8*)surface->pixels + (std::size_t)y * surface->pitch), surface->w, surface->format->format);
+	SDL_UnlockSurface(surface);
+	return false;
+}
+
+/***************************************************************************//**
+ * Converts a surface to a pixel format, freeing the surface. A surface already
+ * in the format is returned as it is, with no copying. Conversions between
+ * supported formats use convert(), and any other conversion is left to SDL.
+ * @param surface The surface to convert. Freed, unless it is returned.
+ * @param format The pixel format to convert to.
+ * @return The surface in the format on success, which must be freed.
+ * Otherwise nullptr.
+ ******************************************************************************/
+SDL_Surface* FFG_PixelOps::convert_surface(SDL_Surface* surface, Uint32 format) {
+	if (!surface) return nullptr;
+	const Uint32 source_format = surface->format->format;
+	if (source_format == format) return surface;
+	SDL_Surface* converted = nullptr;
+	if (!supports(source_format) || !supports(format)) {
+		converted = SDL_ConvertSurfaceFormat(surface, format, 0);
+		SDL_FreeSurface(surface);
+		return converted;
+	}
+	converted = SDL_CreateRGBSurfaceWithFormat(0, surface->w, surface->h, 32, format);
+	if (converted && !SDL_LockSurface(surface)) {
+		for (int y = 0; y < surface->h; y++) {
+			const Uint32* in = (const Uint32*)((const Uint8*)surface->pixels + (std::size_t)y * surface->pitch);
+			Uint32* out = (Uint32*)((Uint8*)converted->pixels + (std::size_t)y * converted->pitch);
+			convert(in, out, surface->w, source_format, format);
+		}
+		SDL_UnlockSurface(surface);
+	} else if (converted) {
+		SDL_FreeSurface(converted);
+		converted = nullptr;
+	}
+	SDL_FreeSurface(surface);
+	return converted;
+}
@@ -0,0 +1,142 @@
+#include "FFG_QuadTree.hpp"
+
+/***************************************************************************//**
+ * Private. Returns the index of the first node at a depth. Nodes are stored
+ * level by level, and row by row within a level.
+ * @param depth The depth.
+ * @return The index of the first node at the depth.
+ ******************************************************************************/
+int FFG_QuadTree::level_offset(int depth) {
+	return ((1 << (2 * depth)) - 1) / 3;
+}
+
+/***************************************************************************//**
+ * Private. Finds the node an object belongs in: the deepest node at least as
+ * wide and as tall as the object, holding the object's center.
+ * @param bounds The bounding rectangle of the object.
+ * @return The index of the node.
+ ******************************************************************************/
+int FFG_QuadTree::place(const FFG_Rect& bounds) const {
+	const long long center_x = (long long)bounds.x + bounds.w / 2;
+	const long long center_y = (long long)bounds.y + bounds.h / 2;
+	if (center_x < world.x || center_y < world.y || center_x >= (long long)world.x + world.w || center_y >= (long long)world.y + world.h) return 0;
+	int depth = max_depth_p;
+	while (depth > 0 && (bounds.w > (world.w >> depth) || bounds.h > (world.h >> depth))) depth--;
+	const int side = 1 << depth;
+	const int x = (int)((center_x - world.x) * side / world.w);
+	const int y = (int)((center_y - world.y) * side / world.h);
+	return level_offset(depth) + y * side + x;
+}
+
+/***************************************************************************//**
+ * Private. Adds to the object counts of a node and every node above it.
+ * @param node The index of the node.
+ * @param delta The amount to add.
+ ******************************************************************************/
+void FFG_QuadTree::update_counts(int node, int delta) {
+	int depth = 0;
+	while (depth < max_depth_p && node >= level_offset(depth + 1)) depth++;
+	const int side = 1 << depth;
+	int x = (node - level_offset(depth)) % side;
+	int y = (node - level_offset(depth)) / side;
+	for (; depth >= 0; depth--) {
+		counts[level_offset(depth) + y * (1 << depth) + x] += delta;
+		x >>= 1;
+		y >>= 1;
+	}
+}
+
+/***************************************************************************//**
+ * Private. Tests the objects in a node and the nodes beneath it whose loose
+ * bounds intersect an area, skipping nodes with no objects beneath them.
+ * NOTE: This method is core loop critical.
+ * @param area The area.
+ * @param depth The depth of the node.
+ * @param x The column of the node within its depth.
+ * @param y The row of the node within its depth.
+ ******************************************************************************/
+void FFG_QuadTree::collect_node(const FFG_Rect& area, int depth, int x, int y) {
+	const int node = level_offset(depth) + y * (1 << depth) + x;
+	if (counts[node] == 0) return;
+	// The root holds objects outside the world, so it is always tested:
+	if (depth > 0) {
+		const long long side = 1LL << depth;
+		const long long left = world.x + x * world.w / side;
+		const long long top = world.y + y * world.h / side;
+		const long long right = world.x + (x + 1) * world.w / side;
+		const long long bottom = world.y + (y + 1) * world.h / side;
+		// Half the node's size, rounded up, plus a pixel for rounding the node's sides:
+		const long long half_w = (right - left + 1) / 2 + 1;
+		const long long half_h = (bottom - top + 1) / 2 + 1;
+		if (area.x >= right + half_w || (long long)area.x + area.w <= left - half_w) return;
+		if (area.y >= bottom + half_h || (long long)area.y + area.h <= top - half_h) return;
+	}
+	for (unsigned int id : nodes[node]) test(id);
+	if (depth == max_depth_p) return;
+	for (int child = 0; child < 4; child++) collect_node(area, depth + 1, 2 * x + (child & 1), 2 * y + (child >> 1));
+}
+
+/***************************************************************************//**
+ * Protected. Places an object in its node.
+ * @param id The ID of the object.
+ ******************************************************************************/
+void FFG_QuadTree::add_entry(unsigned int id) {
+	FFG_SpatialEntry& entry = entries[id];
+	entry.node = -1;
+	if (entry.bounds.w <= 0 || entry.bounds.h <= 0) return;
+	entry.node = place(entry.bounds);
+	nodes[entry.node].push_back(id);
+	update_counts(entry.node, 1);
+}
+
+/***************************************************************************//**
+ * Protected. Removes an object from its node.
+ * @param id The ID of the object.
+ ******************************************************************************/
+void FFG_QuadTree::remove_entry(unsigned int id) {
+	FFG_SpatialEntry& entry = entries[id];
+	if (entry.node < 0) return;
+	std::vector<unsigned int>& list = nodes[entry.node];
+	for (unsigned int i = 0; i < list.size(); i++) {
+		if (list[i] == id) {
+			list[i] = list.back();
+			list.pop_back();
+			break;
+		}
+	}
+	update_counts(entry.node, -1);
+	entry.node = -1;
+}
+
+/***************************************************************************//**
+ * Protected. Tests the objects in every node whose loose bounds intersect an
+ * area.
+ * NOTE: This method is core loop critical.
+ * @param area The area.
+ ******************************************************************************/
+void FFG_QuadTree::collect(const FFG_Rect& area) {
+	collect_node(area, 0, 0, 0);
+}
+
+/***************************************************************************//**
+ * Constructor.
+ * @param world The area objects are expected to be within.
+ * @param max_depth The depth of the smallest nodes, from 0 to
+ * FFG_QUADTREE_MAX_DEPTH.
+ ******************************************************************************/
+FFG_QuadTree::FFG_QuadTree(const FFG_Rect& world, const int max_depth) {
+	this->world = world;
+	if (this->world.w < 1) this->world.w = 1;
+	if (this->world.h < 1) this->world.h = 1;
+	max_depth_p = (max_depth < 0) ? 0 : (max_depth > FFG_QUADTREE_MAX_DEPTH) ? FFG_QUADTREE_MAX_DEPTH : max_depth;
+	nodes.resize(level_offset(max_depth_p + 1));
+	counts.resize(nodes.size(), 0);
+}
+
+/***************************************************************************//**
+ * Returns the depth of the smallest nodes.
+ * @return The depth of the smallest nodes.
+ ******************************************************************************/
+int FFG_QuadTree::max_depth() const {
+	return max_depth_p;
+}
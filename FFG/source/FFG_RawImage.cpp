@@ -0,0 +1,220 @@
+#include "FFG_RawImage.hpp"
+
+/***************************************************************************//**
+ * Private. Reads a little-endian 32 bit value.
+ * @param p The first byte of the value.
+ * @return The value.
+ ******************************************************************************/
+Uint32 FFG_RawImage::read_32(const Uint8* p) {
+	return (Uint32)p[0] | ((Uint32)p[1] << 8) | ((Uint32)p[2] << 16) | ((Uint32)p[3] << 24);
+}
+
+/***************************************************************************//**
+ * Private. Appends a little-endian 32 bit value.
+ * @param out The buffer to append to.
+ * @param value The value.
+ ******************************************************************************/
+void FFG_RawImage::write_32(std::vector<Uint8>& out, Uint32 value) {
+	for (int i = 0; i < 4; i++) out.push_back((Uint8)(value >> (8 * i)));
+}
+
+/***************************************************************************//**
+ * Constructor.
+ ******************************************************************************/
+FFG_RawImage::FFG_RawImage() {
+	width = 0;
+	height = 0;
+	format = SDL_PIXELFORMAT_UNKNOWN;
+	pitch = 0;
+	pixels = nullptr;
+	pixels_size = 0;
+	compressed = false;
+}
+
+/***************************************************************************//**
+ * Indicates if memory holds a raw image, rather than an encoded image.
+ * @param mem The memory.
+ * @param size_b The size of the memory.
+ * @return True if the memory starts with a raw image's header, otherwise false.
+ ******************************************************************************/
+bool FFG_RawImage::is_raw(const void* mem, unsigned int size_b) {
+	return mem && size_b >= FFG_RAW_HEADER_SIZE && !std::memcmp(mem, FFG_RAW_MAGIC, 4);
+}
+
+/***************************************************************************//**
+ * Reads a raw image's header. The pixels are left in place, and stay valid as
+ * long as the memory does.
+ * @param mem The memory holding the raw image.
+ * @param size_b The size of the memory.
+ * @return False on success. Otherwise true, if the memory is not a valid raw
+ * image of the current version.
+ ******************************************************************************/
+bool FFG_RawImage::parse(const void* mem, unsigned int size_b) {
+	if (!is_raw(mem, size_b)) return true;
+	const Uint8* bytes = (const Uint8*)mem;
+	if (read_32(bytes + 4) != FFG_RAW_VERSION) return true;
+	const Uint32 w = read_32(bytes + 8);
+	const Uint32 h = read_32(bytes + 12);
+	format = read_32(bytes + 16);
+	const Uint32 compressed_size = read_32(bytes + 20);
+	if (w == 0 || h == 0 || w > INT_MAX || h > INT_MAX || SDL_ISPIXELFORMAT_FOURCC(format) || SDL_BYTESPERPIXEL(format) == 0) return true;
+	const Uint64 row = (Uint64)w * SDL_BYTESPERPIXEL(format);
+	if (row > INT_MAX || row * h > UINT_MAX) return true;
+	width = w;
+	height = h;
+	pitch = row;
+	compressed = compressed_size != 0;
+	pixels = bytes + FFG_RAW_HEADER_SIZE;
+	pixels_size = compressed ? compressed_size : (unsigned int)(row * h);
+	return pixels_size > size_b - FFG_RAW_HEADER_SIZE;
+}
+
+/***************************************************************************//**
+ * Writes the pixels of a parsed raw image, decompressing them if needed.
+ * @param destination The buffer to write to, of at least pitch * height bytes.
+ * @return False on success. Otherwise true, if the compressed pixels are
+ * corrupt.
+ ******************************************************************************/
+bool FFG_RawImage::decode(Uint8* destination) const {
+	const unsigned int size_b = (unsigned int)pitch * height;
+	if (!compressed) {
+		std::memcpy(destination, pixels, size_b);
+		return false;
+	}
+	return lz4_decompress(pixels, pixels_size, destination, size_b);
+}
+
+/***************************************************************************//**
+ * Builds a raw image from a surface, keeping the surface's pixel format.
+ * Convert the surface first to choose the format.
+ * @param surface The surface.
+ * @param compress If true, the pixels are compressed with LZ4.
+ * @param out The buffer to write the raw image to.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_RawImage::encode(SDL_Surface* surface, bool compress, std::vector<Uint8>& out) {
+	if (!surface || SDL_ISPIXELFORMAT_FOURCC(surface->format->format)) return true;
+	const int row = surface->w * surface->format->BytesPerPixel;
+	std::vector<Uint8> packed((std::size_t)row * surface->h);
+	if (SDL_LockSurface(surface)) return true;
+	for (int y = 0; y < surface->h; y++) std::memcpy(packed.data() + (std::size_t)y * row, (const Uint8*)surface->pixels + (std::size_t)y * surface->pitch, row);
+	SDL_UnlockSurface(surface);
+	std::vector<Uint8> compressed;
+	if (compress) lz4_compress(packed.data(), packed.size(), compressed);
+	// Compression only pays off if it saves space:
+	const bool use_compressed = compress && compressed.size() < packed.size();
+	out.clear();
+	out.insert(out.end(), FFG_RAW_MAGIC, FFG_RAW_MAGIC + 4);
+	write_32(out, FFG_RAW_VERSION);
+	write_32(out, surface->w);
+	write_32(out, surface->h);
+	write_32(out, surface->format->format);
+	write_32(out, use_compressed ? compressed.size() : 0);
+	const std::vector<Uint8>& payload = use_compressed ? compressed : packed;
+	out.insert(out.end(), payload.begin(), payload.end());
+	return false;
+}
+
+/***************************************************************************//**
+ * Compresses data as a single LZ4 block. Matches are found greedily through a
+ * hash table of the last position each four bytes were seen at.
+ * @param source The data.
+ * @param source_size The size of the data.
+ * @param out The buffer to write the block to.
+ ******************************************************************************/
+void FFG_RawImage::lz4_compress(const Uint8* source, unsigned int source_size, std::vector<Uint8>& out) {
+	// The block format requires the last five bytes be literals, and that no
+	// match start within the last twelve:
+	const unsigned int last_literals = 5;
+	const unsigned int match_limit = 12;
+	std::vector<int> table(1 << FFG_RAW_LZ4_HASH_BITS, -1);
+	out.clear();
+	auto put_length = [&out](unsigned int length) {
+		while (length >= 255) {
+			out.push_back(255);
+			length -= 255;
+		}
+		out.push_back((Uint8)length);
+	};
+	auto read = [source](unsigned int at) {
+		Uint32 value;
+		std::memcpy(&value, source + at, 4);
+		return value;
+	};
+	unsigned int anchor = 0;
+	unsigned int i = 0;
+	while (i + match_limit < source_size) {
+		const Uint32 sequence = read(i);
+		const unsigned int h = (sequence * 2654435761u) >> (32 - FFG_RAW_LZ4_HASH_BITS);
+		const int candidate = table[h];
+		table[h] = i;
+		if (candidate < 0 || i - candidate > 65535 || read(candidate) != sequence) {
+			i++;
+			continue;
+		}
+		unsigned int length = 4;
+		while (i + length < source_size - last_literals && source[candidate + length] == source[i + length]) length++;
+		const unsigned int literals = i - anchor;
+		out.push_back((Uint8)(((literals < 15 ? literals : 15) << 4) | (length - 4 < 15 ? length - 4 : 15)));
+		if (literals >= 15) put_length(literals - 15);
+		out.insert(out.end(), source + anchor, source + i);
+		out.push_back((Uint8)((i - candidate) & 0xFF));
+		out.push_back((Uint8)((i - candidate) >> 8));
+		if (length - 4 >= 15) put_length(length - 4 - 15);
+		i += length;
+		anchor = i;
+	}
+	const unsigned int literals = source_size - anchor;
+	out.push_back((Uint8)((literals < 15 ? literals : 15) << 4));
+	if (literals >= 15) put_length(literals - 15);
+	out.insert(out.end(), source + anchor, source + source_size);
+}
+
+/***************************************************************************//**
+ * Decompresses a single LZ4 block. Every read and write is bounds checked, so
+ * corrupt data fails rather than overrunning either buffer.
+ * @param source The block.
+ * @param source_size The size of the block.
+ * @param destination The buffer to write the data to.
+ * @param destination_size The exact size of the data.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_RawImage::lz4_decompress(const Uint8* source, unsigned int source_size, Uint8* destination, unsigned int destination_size) {
+	const Uint8* in = source;
+	const Uint8* const in_end = source + source_size;
+	Uint8* out = destination;
+	Uint8* const out_end = destination + destination_size;
+	auto get_length = [&in, in_end](std::size_t& length) {
+		Uint8 byte;
+		do {
+			if (in >= in_end) return true;
+			byte = *in++;
+			length += byte;
+		} while (byte == 255);
+		return false;
+	};
+	while (in < in_end) {
+		const Uint8 token = *in++;
+		std::size_t literals = token >> 4;
+		if (literals == 15 && get_length(literals)) return true;
+		if (literals > (std::size_t)(in_end - in) || literals > (std::size_t)(out_end - out)) return true;
+		std::memcpy(out, in, literals);
+		in += literals;
+		out += literals;
+		// The last sequence has literals only:
+		if (in == in_end) break;
+		if (in_end - in < 2) return true;
+		const std::size_t offset = in[0] | (in[1] << 8);
+		in += 2;
+		if (offset == 0 || offset > (std::size_t)(out - destination)) return true;
+		std::size_t length = token & 15;
+		if (length == 15 && get_length(length)) return true;
+		length += 4;
+		if (length > (std::size_t)(out_end - out)) return true;
+		// Matches may overlap the bytes they produce, so copy forward a byte at a time:
+		const Uint8* match = out - offset;
+		for (std::size_t j = 0; j < length; j++) out[j] = match[j];
+		out += length;
+	}
+	return out != out_end;
+}
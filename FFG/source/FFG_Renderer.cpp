@@ -1,16 +1,827 @@
 #include "FFG_Renderer.hpp"
 
+/***************************************************************************//**
+ * Constructor.
+ * @param type The type of command.
+ * @param color The draw color, or the texture's color modulation for sprites.
+ ******************************************************************************/
+FFG_Renderer::FFG_RenderCommand::FFG_RenderCommand(FFG_RenderCommandType type, const SDL_Color& color) {
+	this->type = type;
+	this->color = color;
+	texture = nullptr;
+	blend_mode = FFG_BLEND_NONE;
+	buffer = nullptr;
+	source = { 0, 0, 0, 0 };
+	destination = { 0, 0, 0, 0 };
+	first = 0;
+	count = 0;
+}
+
 /***************************************************************************//**
  * Protected. Constructor.
  ******************************************************************************/
 FFG_Renderer::FFG_Renderer() {
 	window = nullptr;
+	headless_surface = nullptr;
 	renderer = nullptr;
+	texture_format = SDL_PIXELFORMAT_ARGB8888;
+	upload_budget_us = FFG_RENDERER_DEFAULT_UPLOAD_BUDGET_US;
+	placeholder = nullptr;
+	resident_bytes = 0;
+	texture_budget_p = FFG_RENDERER_DEFAULT_TEXTURE_BUDGET;
 	window_title = FFG_RENDERER_DEFAULT_NAME;
 	screen_width_p = FFG_RENDERER_DEFAULT_WIDTH;
 	screen_height_p = FFG_RENDERER_DEFAULT_HEIGHT;
 	vsync_p = FFG_RENDERER_DEFAULT_VSYNC;
 	window_mode = FFG_WINDOW_WINDOWED;
+	current_target = nullptr;
+	applied_target = nullptr;
+	applied_blend_mode = SDL_BLENDMODE_INVALID;
+	applied_color = { 0, 0, 0, 0 };
+	applied_color_valid = false;
+	elided_calls_p = 0;
+	batching = false;
+	batch_texture = nullptr;
+	batch_buffer = nullptr;
+	batch_blend_mode = FFG_BLEND_NONE;
+	batch_vertices.reserve(FFG_RENDERER_BATCH_HINT * 4);
+	batch_indices.reserve(FFG_RENDERER_BATCH_HINT * 6);
+	draw_color = { 0, 0, 0, 255 };
+	rect_buffer.reserve(FFG_RENDERER_PRIMITIVE_HINT);
+	deferred = false;
+	deferred_frame = 1;
+	deferred_layer = 0;
+	deferred_target = FFG_RENDERER_DEFERRED_MAX_TARGETS;
+	deferred_next_slot = 0;
+	deferred_commands.reserve(FFG_RENDERER_DEFERRED_HINT);
+	deferred_keys.reserve(FFG_RENDERER_DEFERRED_HINT);
+	dirty_rendering = false;
+	dirty_frame = false;
+	damaged = false;
+	pending_damage = { 0, 0, 0, 0 };
+	frame_damage = { 0, 0, 0, 0 };
+}
+
+/***************************************************************************//**
+ * Private. Decodes the image a texture is set to load from into a surface. Safe
+ * to call from any thread.
+ * @param texture The texture to decode the image of.
+ * @return The surface on success, which must be freed. Otherwise nullptr.
+ ******************************************************************************/
+SDL_Surface* FFG_Renderer::load_surface(FFG_Texture& texture) {
+	SDL_Surface* loaded_surface = nullptr;
+	SDL_RWops* rw = nullptr;
+	switch (texture.type) {
+		case FFG_TEXTURE_STR:
+			// From path:
+			loaded_surface = IMG_Load(texture.path.c_str());
+			break;
+		case FFG_TEXTURE_MEM:
+			// From memory:
+			rw = SDL_RWFromConstMem(texture.mem, texture.size_b);
+			if (!rw) return nullptr;
+			loaded_surface = IMG_LoadPNG_RW(rw);
+			SDL_RWclose(rw);
+			break;
+		case FFG_TEXTURE_RAW: {
+			// From pixels in memory, decompressed straight into the surface when its rows are not padded:
+			FFG_RawImage raw;
+			if (raw.parse(texture.mem, texture.size_b)) return nullptr;
+			loaded_surface = SDL_CreateRGBSurfaceWithFormat(0, raw.width, raw.height, SDL_BITSPERPIXEL(raw.format), raw.format);
+			if (!loaded_surface) return nullptr;
+			bool failed;
+			if (loaded_surface->pitch == raw.pitch) {
+				failed = raw.decode((Uint8*)loaded_surface->pixels);
+			} else {
+				std::vector<Uint8> pixels((std::size_t)raw.pitch * raw.height);
+				failed = raw.decode(pixels.data());
+				for (int y = 0; y < raw.height && !failed; y++) std::memcpy((Uint8*)loaded_surface->pixels + (std::size_t)y * loaded_surface->pitch, pixels.data() + (std::size_t)y * raw.pitch, raw.pitch);
+			}
+			if (failed) {
+				SDL_FreeSurface(loaded_surface);
+				return nullptr;
+			}
+			break;
+		}
+		default:
+			break;
+	}
+	return loaded_surface;
+}
+
+/***************************************************************************//**
+ * Private. Decodes the image a texture is set to load from, converts it to a
+ * pixel format, and passes it through a filter. Safe to call from any thread.
+ * @param texture The texture to decode the image of.
+ * @param format The pixel format to convert to.
+ * @param filter The filter, or an empty function.
+ * @return The surface on success, which must be freed. Otherwise nullptr.
+ ******************************************************************************/
+SDL_Surface* FFG_Renderer::prepare_surface(FFG_Texture& texture, Uint32 format, const std::function<void(FFG_Texture&, SDL_Surface*)>& filter) {
+	SDL_Surface* surface = FFG_PixelOps::convert_surface(load_surface(texture), format);
+	if (surface && filter) filter(texture, surface);
+	return surface;
+}
+
+/***************************************************************************//**
+ * Private. Records the attributes of a newly created texture, and counts it
+ * against the texture budget.
+ * @param texture The texture to query.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::query_texture(FFG_Texture& texture) {
+	if (!texture.texture) return true;
+	if (SDL_QueryTexture(texture.texture, &texture.format, nullptr, &texture.loaded_width, &texture.loaded_height)) return true;
+	SDL_BlendMode blend_mode;
+	if (SDL_GetTextureBlendMode(texture.texture, &blend_mode)) return true;
+	texture.blend_mode = (blend_mode == SDL_BLENDMODE_BLEND) ? FFG_BLEND_ALPHA : FFG_BLEND_NONE;
+	texture.mod_r = 255;
+	texture.mod_g = 255;
+	texture.mod_b = 255;
+	texture.mod_a = 255;
+	track_texture(texture, texture.format);
+	enforce_texture_budget();
+	return false;
+}
+
+/***************************************************************************//**
+ * Private. Adds a newly loaded texture to the resident textures. It counts as
+ * drawn during the current frame, so it is not evicted before it is used.
+ * @param texture The texture.
+ * @param format The pixel format of the texture.
+ ******************************************************************************/
+void FFG_Renderer::track_texture(FFG_Texture& texture, Uint32 format) {
+	if (texture.resident_slot >= 0) untrack_texture(texture);
+	const int bytes_per_pixel = SDL_ISPIXELFORMAT_FOURCC(format) ? 4 : SDL_BYTESPERPIXEL(format);
+	texture.resident_bytes = (std::size_t)texture.loaded_width * texture.loaded_height * bytes_per_pixel;
+	// Streaming textures have two buffers:
+	if (texture.type == FFG_TEXTURE_STREAMING) texture.resident_bytes *= 2;
+	texture.resident_slot = resident.size();
+	texture.used_frame = deferred_frame;
+	texture.evicted = false;
+	texture.owner = this;
+	resident.push_back(&texture);
+	resident_bytes += texture.resident_bytes;
+}
+
+/***************************************************************************//**
+ * Private. Removes a texture from the resident textures, if it is there.
+ * @param texture The texture.
+ ******************************************************************************/
+void FFG_Renderer::untrack_texture(FFG_Texture& texture) {
+	if (texture.resident_slot < 0) return;
+	resident[texture.resident_slot] = resident.back();
+	resident[texture.resident_slot]->resident_slot = texture.resident_slot;
+	resident.pop_back();
+	resident_bytes -= texture.resident_bytes;
+	texture.resident_bytes = 0;
+	texture.resident_slot = -1;
+}
+
+/***************************************************************************//**
+ * Private. Evicts the least recently drawn textures until the resident
+ * textures fit within the texture budget. Only textures loaded from images can
+ * be loaded again, so only they are evicted, and only if they are not pinned
+ * and were not drawn during the current frame, since pending batched or
+ * deferred draws may still use them.
+ ******************************************************************************/
+void FFG_Renderer::enforce_texture_budget() {
+	if (texture_budget_p == 0 || resident_bytes <= texture_budget_p) return;
+	eviction_candidates.clear();
+	for (FFG_Texture* texture : resident) {
+		if (texture->type == FFG_TEXTURE_DRAWTO || texture->type == FFG_TEXTURE_STREAMING || texture->pinned || texture->used_frame == deferred_frame) continue;
+		eviction_candidates.push_back(texture);
+	}
+	std::sort(eviction_candidates.begin(), eviction_candidates.end(), [](const FFG_Texture* a, const FFG_Texture* b) { return a->used_frame < b->used_frame; });
+	for (FFG_Texture* texture : eviction_candidates) {
+		if (resident_bytes <= texture_budget_p) break;
+		untrack_texture(*texture);
+		SDL_DestroyTexture(texture->texture);
+		texture->texture = nullptr;
+		texture->evicted = true;
+	}
+}
+
+/***************************************************************************//**
+ * Private. Marks a texture as drawn during the current frame, loading it again
+ * first if it was evicted. The blend mode and color modulation it had, or that
+ * were set while it was evicted, are restored.
+ * NOTE: This method is core loop critical.
+ * @param texture The texture.
+ * @return False if the texture is loaded. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::use_texture(FFG_Texture& texture) {
+	texture.used_frame = deferred_frame;
+	if (texture.texture) return false;
+	if (!texture.evicted || texture.stream_ticket) return true;
+	const FFG_BlendMode blend_mode = texture.blend_mode;
+	const SDL_Color mod = { texture.mod_r, texture.mod_g, texture.mod_b, texture.mod_a };
+	if (load_texture(texture)) return true;
+	texture.set_blend_mode(blend_mode);
+	texture.set_mod_color(mod.r, mod.g, mod.b);
+	texture.set_mod_alpha(mod.a);
+	return false;
+}
+
+/***************************************************************************//**
+ * Private. Chooses the pixel format decoded images are converted to: the first
+ * format with alpha the renderer supports natively, so that uploading needs no
+ * further conversion.
+ ******************************************************************************/
+void FFG_Renderer::choose_texture_format() {
+	texture_format = SDL_PIXELFORMAT_ARGB8888;
+	SDL_RendererInfo info;
+	if (SDL_GetRendererInfo(renderer, &info)) return;
+	for (Uint32 i = 0; i < info.num_texture_formats; i++) {
+		const Uint32 format = info.texture_formats[i];
+		if (!SDL_ISPIXELFORMAT_FOURCC(format) && SDL_ISPIXELFORMAT_ALPHA(format)) {
+			texture_format = format;
+			return;
+		}
+	}
+}
+
+/***************************************************************************//**
+ * Private. Creates a texture from a surface already in the native format. The
+ * texture blends, as textures created from images with alpha do.
+ * @param texture The texture to create.
+ * @param surface The surface, in the native format.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::upload_surface(FFG_Texture& texture, SDL_Surface* surface) {
+	texture.texture = SDL_CreateTexture(renderer, texture_format, SDL_TEXTUREACCESS_STATIC, surface->w, surface->h);
+	if (!texture.texture) return true;
+	if (SDL_UpdateTexture(texture.texture, nullptr, surface->pixels, surface->pitch) || SDL_SetTextureBlendMode(texture.texture, SDL_BLENDMODE_BLEND)) {
+		SDL_DestroyTexture(texture.texture);
+		texture.texture = nullptr;
+		return true;
+	}
+	return query_texture(texture);
+}
+
+/***************************************************************************//**
+ * Private. Creates a texture from a raw image. When the raw image is in the
+ * native pixel format, uncompressed pixels are uploaded straight from the
+ * image's memory, and compressed pixels are decompressed into a scratch buffer
+ * first, with no surface created either way. Otherwise, or if there is a load
+ * filter, the pixels are decoded into a surface and prepared like any image.
+ * @param texture The texture to create, set to a raw image.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::upload_raw(FFG_Texture& texture) {
+	FFG_RawImage raw;
+	if (raw.parse(texture.mem, texture.size_b)) return true;
+	if (raw.format != texture_format || load_filter) {
+		SDL_Surface* converted = prepare_surface(texture, texture_format, load_filter);
+		if (!converted) return true;
+		const bool failed = upload_surface(texture, converted);
+		SDL_FreeSurface(converted);
+		return failed;
+	}
+	const Uint8* pixels = raw.pixels;
+	if (raw.compressed) {
+		raw_buffer.resize((std::size_t)raw.pitch * raw.height);
+		if (raw.decode(raw_buffer.data())) return true;
+		pixels = raw_buffer.data();
+	}
+	texture.texture = SDL_CreateTexture(renderer, texture_format, SDL_TEXTUREACCESS_STATIC, raw.width, raw.height);
+	if (!texture.texture) return true;
+	if (SDL_UpdateTexture(texture.texture, nullptr, pixels, raw.pitch) || SDL_SetTextureBlendMode(texture.texture, SDL_BLENDMODE_BLEND)) {
+		SDL_DestroyTexture(texture.texture);
+		texture.texture = nullptr;
+		return true;
+	}
+	return query_texture(texture);
+}
+
+/***************************************************************************//**
+ * Private. Creates both buffers of a streaming texture, along with the copy of
+ * its pixels, all transparent. The buffer created first is drawn first.
+ * @param texture The texture to create, set to stream.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::create_streaming(FFG_Texture& texture) {
+	if (texture.drawto_width <= 0 || texture.drawto_height <= 0) return true;
+	texture.lock_pitch = texture.drawto_width * SDL_BYTESPERPIXEL(texture_format);
+	texture.lock_pixels.assign((std::size_t)texture.lock_pitch * texture.drawto_height, 0);
+	texture.locked = false;
+	texture.back_damage = { 0, 0, 0, 0 };
+	const SDL_Rect area = { 0, 0, texture.drawto_width, texture.drawto_height };
+	SDL_Texture* buffers[2] = { nullptr, nullptr };
+	bool failed = false;
+	for (SDL_Texture*& buffer : buffers) {
+		buffer = SDL_CreateTexture(renderer, texture_format, SDL_TEXTUREACCESS_STREAMING, texture.drawto_width, texture.drawto_height);
+		if (!buffer || SDL_SetTextureBlendMode(buffer, SDL_BLENDMODE_BLEND) || upload_pixels(texture, buffer, area)) {
+			failed = true;
+			break;
+		}
+	}
+	if (failed) {
+		for (SDL_Texture* buffer : buffers) {
+			if (buffer) SDL_DestroyTexture(buffer);
+		}
+		texture.lock_pixels.clear();
+		return true;
+	}
+	texture.texture = buffers[0];
+	texture.back_texture = buffers[1];
+	return false;
+}
+
+/***************************************************************************//**
+ * Private. Copies an area of a streaming texture's pixels to one of its
+ * buffers.
+ * @param texture The texture.
+ * @param buffer The buffer to copy to.
+ * @param area The area to copy, within the texture.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::upload_pixels(FFG_Texture& texture, SDL_Texture* buffer, const SDL_Rect& area) {
+	void* locked;
+	int locked_pitch;
+	if (SDL_LockTexture(buffer, &area, &locked, &locked_pitch)) return true;
+	const int bytes_per_pixel = SDL_BYTESPERPIXEL(texture_format);
+	const std::size_t row = (std::size_t)area.w * bytes_per_pixel;
+	const Uint8* source = texture.lock_pixels.data() + (std::size_t)area.y * texture.lock_pitch + (std::size_t)area.x * bytes_per_pixel;
+	for (int y = 0; y < area.h; y++) std::memcpy((Uint8*)locked + (std::size_t)y * locked_pitch, source + (std::size_t)y * texture.lock_pitch, row);
+	SDL_UnlockTexture(buffer);
+	return false;
+}
+
+/***************************************************************************//**
+ * Private. Adds a horizontal line, as a one pixel tall rectangle, to the
+ * rectangle scratch buffer.
+ * NOTE: This method is core loop critical.
+ * @param y The y-coordinate of both endpoints.
+ * @param x1 The x-coordinate of the left endpoint.
+ * @param x2 The x-coordinate of the right endpoint.
+ ******************************************************************************/
+void FFG_Renderer::push_h_line(int y, int x1, int x2) {
+	rect_buffer.push_back({ x1, y, x2 - x1 + 1, 1 });
+}
+
+/***************************************************************************//**
+ * Private. Fills the span scratch buffer with the half-widths of each row of a
+ * circle, from the center row to the top row, using the midpoint algorithm.
+ * NOTE: This method is core loop critical.
+ * @param r The radius of the circle. Must be positive.
+ ******************************************************************************/
+void FFG_Renderer::circle_spans(int r) {
+	span_buffer.assign(r + 1, 0);
+	int px = r;
+	int py = 0;
+	int error = 1 - r;
+	while (px >= py) {
+		// Each step yields a point in both octants of the quadrant:
+		if (span_buffer[py] < px) span_buffer[py] = px;
+		if (span_buffer[px] < py) span_buffer[px] = py;
+		py++;
+		if (error < 0) {
+			error += 2 * py + 1;
+		} else {
+			px--;
+			error += 2 * (py - px) + 1;
+		}
+	}
+}
+
+/***************************************************************************//**
+ * Private. Fills the span scratch buffer with the half-widths of each row of an
+ * ellipse, from the center row to the top row, using the midpoint algorithm.
+ * The decision variables are scaled by four to stay in integers.
+ * NOTE: This method is core loop critical.
+ * @param rx The x radius of the ellipse. Must be positive.
+ * @param ry The y radius of the ellipse. Must be positive.
+ ******************************************************************************/
+void FFG_Renderer::ellipse_spans(int rx, int ry) {
+	span_buffer.assign(ry + 1, 0);
+	const long long rx2 = (long long)rx * rx;
+	const long long ry2 = (long long)ry * ry;
+	long long px = 0;
+	long long py = ry;
+	long long dx = 0;
+	long long dy = 2 * rx2 * py;
+	// Region 1, where the slope is shallower than -1:
+	long long decision = 4 * ry2 - 4 * rx2 * ry + rx2;
+	while (dx < dy) {
+		span_buffer[py] = px;
+		px++;
+		dx += 2 * ry2;
+		if (decision < 0) {
+			decision += 4 * (dx + ry2);
+		} else {
+			py--;
+			dy -= 2 * rx2;
+			decision += 4 * (dx - dy + ry2);
+		}
+	}
+	// Region 2, where the slope is steeper than -1:
+	decision = ry2 * (2 * px + 1) * (2 * px + 1) + 4 * rx2 * (py - 1) * (py - 1) - 4 * rx2 * ry2;
+	while (py >= 0) {
+		if (span_buffer[py] < px) span_buffer[py] = px;
+		py--;
+		dy -= 2 * rx2;
+		if (decision > 0) {
+			decision += 4 * (rx2 - dy);
+		} else {
+			px++;
+			dx += 2 * ry2;
+			decision += 4 * (dx - dy + rx2);
+		}
+	}
+	// Very flat ellipses leave region 2 before reaching the end of the center row:
+	span_buffer[0] = rx;
+}
+
+/***************************************************************************//**
+ * Private. Converts the half-widths in the span scratch buffer into horizontal
+ * lines in the rectangle scratch buffer, mirrored about the center. A filled
+ * shape gets one line per row. An outline gets, on each side of each row, the
+ * run of pixels between the edge of the row above and the edge of the row,
+ * which leaves no gaps. No pixel is covered twice.
+ * NOTE: This method is core loop critical.
+ * @param x The x-coordinate of the center.
+ * @param y The y-coordinate of the center.
+ * @param filled If the shape should be filled or not.
+ ******************************************************************************/
+void FFG_Renderer::push_spans(int x, int y, bool filled) {
+	const int top = span_buffer.size() - 1;
+	for (int dy = 0; dy <= top; dy++) {
+		const int half_width = span_buffer[dy];
+		int inner = 0;
+		if (!filled && dy < top) inner = std::min(span_buffer[dy + 1] + 1, half_width);
+		if (inner <= 0) {
+			push_h_line(y + dy, x - half_width, x + half_width);
+			if (dy) push_h_line(y - dy, x - half_width, x + half_width);
+		} else {
+			push_h_line(y + dy, x + inner, x + half_width);
+			push_h_line(y + dy, x - half_width, x - inner);
+			if (dy) {
+				push_h_line(y - dy, x + inner, x + half_width);
+				push_h_line(y - dy, x - half_width, x - inner);
+			}
+		}
+	}
+}
+
+/***************************************************************************//**
+ * Private. Fills every rectangle in the rectangle scratch buffer with a single
+ * call, then empties it.
+ * @return False on success, otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::flush_rects() {
+	if (rect_buffer.empty()) return false;
+	if (deferred) return record_rects(FFG_COMMAND_FILL_RECTS);
+	bool failed = SDL_RenderFillRects(renderer, rect_buffer.data(), rect_buffer.size());
+	rect_buffer.clear();
+	return failed;
+}
+
+/***************************************************************************//**
+ * Private. Records a command to be replayed when the deferred commands are
+ * flushed. The command's sort key is built from, most significant first: the
+ * render target (8 bits, the screen being last), the layer (8 bits), the kind
+ * of command (2 bits, clears first), the blend mode (2 bits), the texture
+ * (20 bits), and the index of the command (24 bits).
+ * NOTE: This method is core loop critical.
+ * @param command The command.
+ * @return False on success. Otherwise true, if the buffer is full.
+ ******************************************************************************/
+bool FFG_Renderer::record_command(const FFG_RenderCommand& command) {
+	if (deferred_commands.size() >= FFG_RENDERER_DEFERRED_MAX_COMMANDS) return true;
+	Uint64 layer = deferred_layer;
+	Uint64 kind = 1;
+	Uint64 blend_mode = (command.color.a == 255) ? FFG_BLEND_NONE : FFG_BLEND_ALPHA;
+	Uint64 slot = 0;
+	if (command.type == FFG_COMMAND_CLEAR) {
+		layer = 0;
+		kind = 0;
+	} else if (command.type == FFG_COMMAND_SPRITE) {
+		kind = 2;
+		blend_mode = command.blend_mode;
+		slot = command.texture->deferred_slot;
+	}
+	deferred_keys.push_back(((Uint64)deferred_target << 56) | (layer << 48) | (kind << 46) | (blend_mode << 44) | (slot << 24) | deferred_commands.size());
+	deferred_commands.push_back(command);
+	return false;
+}
+
+/***************************************************************************//**
+ * Private. Records a textured quad. Textures are numbered in the order they are
+ * first drawn during the frame, so that draws of the same texture sort next to
+ * each other. The texture's blend mode and buffer are recorded along with the
+ * quad, so that changing the blend mode or unlocking a streaming texture later
+ * in the frame does not affect earlier draws.
+ * NOTE: This method is core loop critical.
+ * @param texture The texture to draw from.
+ * @param source The area on the source texture to draw from.
+ * @param destination The area on the current target to draw to.
+ * @param color The color modulation of the quad.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::record_sprite(FFG_Texture& texture, const SDL_Rect& source, const SDL_Rect& destination, const SDL_Color& color) {
+	if (texture.deferred_frame != deferred_frame) {
+		texture.deferred_frame = deferred_frame;
+		texture.deferred_slot = deferred_next_slot;
+		if (deferred_next_slot < FFG_RENDERER_DEFERRED_MAX_TEXTURES - 1) deferred_next_slot++;
+	}
+	FFG_RenderCommand command(FFG_COMMAND_SPRITE, color);
+	command.texture = &texture;
+	command.blend_mode = texture.blend_mode;
+	command.buffer = texture.texture;
+	command.source = source;
+	command.destination = destination;
+	return record_command(command);
+}
+
+/***************************************************************************//**
+ * Private. Records the rectangles in the rectangle scratch buffer as a single
+ * command, then empties it.
+ * @param type Either FFG_COMMAND_FILL_RECTS or FFG_COMMAND_DRAW_RECTS.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::record_rects(FFG_RenderCommandType type) {
+	FFG_RenderCommand command(type, draw_color);
+	command.first = deferred_rects.size();
+	command.count = rect_buffer.size();
+	deferred_rects.insert(deferred_rects.end(), rect_buffer.begin(), rect_buffer.end());
+	rect_buffer.clear();
+	return record_command(command);
+}
+
+/***************************************************************************//**
+ * Private. Sorts the deferred commands by their keys. This is a stable least
+ * significant digit radix sort over the bytes above the command index, which
+ * skips any byte that is the same for every key.
+ ******************************************************************************/
+void FFG_Renderer::sort_deferred() {
+	const unsigned int num_keys = deferred_keys.size();
+	deferred_keys_swap.resize(num_keys);
+	for (int shift = 24; shift < 64; shift += 8) {
+		unsigned int offsets[256] = { 0 };
+		for (Uint64 key : deferred_keys) offsets[(key >> shift) & 0xFF]++;
+		if (offsets[(deferred_keys[0] >> shift) & 0xFF] == num_keys) continue;
+		unsigned int total = 0;
+		for (unsigned int& offset : offsets) {
+			const unsigned int count = offset;
+			offset = total;
+			total += count;
+		}
+		for (Uint64 key : deferred_keys) deferred_keys_swap[offsets[(key >> shift) & 0xFF]++] = key;
+		deferred_keys.swap(deferred_keys_swap);
+	}
+}
+
+/***************************************************************************//**
+ * Private. Replays the sorted deferred commands. Adjacent sprites of the same
+ * texture are submitted as a batch, and adjacent filled rectangles of the same
+ * color are submitted with a single call.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::replay_deferred() {
+	bool failed = false;
+	unsigned int target = FFG_RENDERER_DEFERRED_MAX_TARGETS + 1;
+	bool skipping = false;
+	SDL_Color rects_color = { 0, 0, 0, 0 };
+	for (Uint64 key : deferred_keys) {
+		const FFG_RenderCommand& command = deferred_commands[key & 0xFFFFFF];
+		const unsigned int command_target = key >> 56;
+		const bool same_rects = command.type == FFG_COMMAND_FILL_RECTS && command.color.r == rects_color.r && command.color.g == rects_color.g && command.color.b == rects_color.b && command.color.a == rects_color.a;
+		// Submit whatever is pending that the command cannot be merged with:
+		if (command_target != target || command.type != FFG_COMMAND_SPRITE) {
+			if (flush_batch()) failed = true;
+		}
+		if (command_target != target || !same_rects) {
+			if (flush_rects()) failed = true;
+		}
+		if (command_target != target) {
+			target = command_target;
+			// Draws onto a target unloaded since they were recorded are dropped:
+			skipping = target != FFG_RENDERER_DEFERRED_MAX_TARGETS && !deferred_targets[target];
+			if (!skipping) {
+				SDL_Texture* texture = (target == FFG_RENDERER_DEFERRED_MAX_TARGETS) ? screen_texture() : deferred_targets[target]->texture;
+				if (apply_render_target(texture)) failed = true;
+			}
+		}
+		if (skipping) continue;
+		switch (command.type) {
+			case FFG_COMMAND_CLEAR:
+				if (apply_draw_color(command.color) || clear_target()) failed = true;
+				break;
+			case FFG_COMMAND_SPRITE:
+				if (!command.texture->texture) break;
+				if (batch_quad(*command.texture, command.source, command.destination, command.color, command.blend_mode, command.buffer)) failed = true;
+				break;
+			case FFG_COMMAND_FILL_RECTS:
+				if (rect_buffer.empty()) {
+					if (apply_draw_color(command.color)) failed = true;
+					rects_color = command.color;
+				}
+				rect_buffer.insert(rect_buffer.end(), deferred_rects.begin() + command.first, deferred_rects.begin() + command.first + command.count);
+				break;
+			case FFG_COMMAND_DRAW_RECTS:
+				if (apply_draw_color(command.color) || SDL_RenderDrawRects(renderer, &deferred_rects[command.first], command.count)) failed = true;
+				break;
+			case FFG_COMMAND_LINE:
+				if (apply_draw_color(command.color)) failed = true;
+				if (SDL_RenderDrawLine(renderer, command.destination.x, command.destination.y, command.destination.w, command.destination.h)) failed = true;
+				break;
+		}
+	}
+	if (flush_batch()) failed = true;
+	if (flush_rects()) failed = true;
+	return failed;
+}
+
+/***************************************************************************//**
+ * Private. Retrieves the size of the current render target.
+ * @param width Set to the width of the current target.
+ * @param height Set to the height of the current target.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::target_size(int* width, int* height) {
+	if (!current_target) return SDL_GetRendererOutputSize(renderer, width, height);
+	*width = current_target->loaded_width;
+	*height = current_target->loaded_height;
+	return false;
+}
+
+/***************************************************************************//**
+ * Private. Adds a textured quad to the pending batch. If the texture, its
+ * buffer or the blend mode differs from that of the pending batch, the pending
+ * batch is submitted first. The texture's color modulation is stored in the
+ * vertices, since geometry submission does not apply it.
+ * NOTE: This method is core loop critical.
+ * @param texture The texture to draw from.
+ * @param source The area on the source texture to draw from.
+ * @param destination The area on the current target to draw to.
+ * @param color The color modulation of the quad.
+ * @param blend_mode The blend mode to draw the quad with.
+ * @param buffer The SDL texture to draw from, which is the texture's own unless
+ * it is a streaming texture unlocked since the quad was recorded.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::batch_quad(FFG_Texture& texture, const SDL_Rect& source, const SDL_Rect& destination, const SDL_Color& color, FFG_BlendMode blend_mode, SDL_Texture* buffer) {
+	if (batch_texture != &texture || batch_buffer != buffer || batch_blend_mode != blend_mode) {
+		if (flush_batch()) return true;
+		batch_texture = &texture;
+		batch_buffer = buffer;
+		batch_blend_mode = blend_mode;
+		batch_first_source = source;
+		batch_first_destination = destination;
+	}
+	const float inv_width = 1.0f / (float)texture.loaded_width;
+	const float inv_height = 1.0f / (float)texture.loaded_height;
+	const float u1 = (float)source.x * inv_width;
+	const float v1 = (float)source.y * inv_height;
+	const float u2 = (float)(source.x + source.w) * inv_width;
+	const float v2 = (float)(source.y + source.h) * inv_height;
+	const float x1 = (float)destination.x;
+	const float y1 = (float)destination.y;
+	const float x2 = (float)(destination.x + destination.w);
+	const float y2 = (float)(destination.y + destination.h);
+	batch_vertices.push_back({ { x1, y1 }, color, { u1, v1 } });
+	batch_vertices.push_back({ { x2, y1 }, color, { u2, v1 } });
+	batch_vertices.push_back({ { x1, y2 }, color, { u1, v2 } });
+	batch_vertices.push_back({ { x2, y2 }, color, { u2, v2 } });
+	return false;
+}
+
+/***************************************************************************//**
+ * Private. Submits the pending batch, if any. A batch of a single quad whose
+ * color matches its texture's color modulation is submitted as a plain copy,
+ * otherwise the batch is submitted as one piece of geometry. If the texture's
+ * blend mode changed since the batch began, or the batch draws from a buffer
+ * the texture swapped out, the batch's blend mode is applied for the
+ * submission only.
+ * NOTE: This method is core loop critical.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::flush_batch() {
+	if (!batch_texture) return false;
+	FFG_Texture& texture = *batch_texture;
+	const int num_quads = batch_vertices.size() / 4;
+	const SDL_Color& color = batch_vertices[0].color;
+	// A buffer swapped out keeps the color modulation it had, so it is only drawn as geometry:
+	const bool front = batch_buffer == texture.texture;
+	// SDL takes the blend mode when the draw is queued, so it can be put back right after:
+	const bool blend_changed = !front || texture.blend_mode != batch_blend_mode;
+	if (blend_changed && SDL_SetTextureBlendMode(batch_buffer, FFG_Texture::sdl_blend_mode(batch_blend_mode))) {
+		batch_vertices.clear();
+		batch_texture = nullptr;
+		return true;
+	}
+	bool failed;
+	if (front && num_quads == 1 && color.r == texture.mod_r && color.g == texture.mod_g && color.b == texture.mod_b && color.a == texture.mod_a) {
+		failed = SDL_RenderCopy(renderer, batch_buffer, &batch_first_source, &batch_first_destination);
+	} else {
+		// The index pattern is the same for every quad, so it is only ever extended:
+		for (int i = batch_indices.size() / 6; i < num_quads; i++) {
+			const int base = i * 4;
+			batch_indices.push_back(base);
+			batch_indices.push_back(base + 1);
+			batch_indices.push_back(base + 2);
+			batch_indices.push_back(base + 2);
+			batch_indices.push_back(base + 1);
+			batch_indices.push_back(base + 3);
+		}
+		failed = SDL_RenderGeometry(renderer, batch_buffer, batch_vertices.data(), batch_vertices.size(), batch_indices.data(), num_quads * 6);
+	}
+	if (blend_changed && SDL_SetTextureBlendMode(batch_buffer, FFG_Texture::sdl_blend_mode(texture.blend_mode))) failed = true;
+	batch_vertices.clear();
+	batch_texture = nullptr;
+	return failed;
+}
+
+/***************************************************************************//**
+ * Private. Recovers the source and destination areas of a quad laid out as
+ * vertices, in the order FFG_Renderer::draw_quads() takes them.
+ * @param texture The texture the quad draws from.
+ * @param quad The four vertices of the quad.
+ * @param source Set to the area on the texture the quad draws from.
+ * @param destination Set to the area on the target the quad draws to.
+ ******************************************************************************/
+void FFG_Renderer::quad_rects(const FFG_Texture& texture, const SDL_Vertex* quad, SDL_Rect& source, SDL_Rect& destination) {
+	source.x = (int)std::lround(quad[0].tex_coord.x * texture.loaded_width);
+	source.y = (int)std::lround(quad[0].tex_coord.y * texture.loaded_height);
+	source.w = (int)std::lround(quad[3].tex_coord.x * texture.loaded_width) - source.x;
+	source.h = (int)std::lround(quad[3].tex_coord.y * texture.loaded_height) - source.y;
+	destination.x = (int)std::lround(quad[0].position.x);
+	destination.y = (int)std::lround(quad[0].position.y);
+	destination.w = (int)std::lround(quad[3].position.x) - destination.x;
+	destination.h = (int)std::lround(quad[3].position.y) - destination.y;
+}
+
+/***************************************************************************//**
+ * Private. Sends a draw color to SDL. Opaque colors are drawn without blending.
+ * The blend mode and color SDL was last given are remembered, and calls that
+ * would not change them are skipped.
+ * NOTE: This method is core loop critical.
+ * @param color The color.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::apply_draw_color(const SDL_Color& color) {
+	const SDL_BlendMode blend_mode = (color.a == 255) ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND;
+	if (blend_mode == applied_blend_mode) {
+		elided_calls_p++;
+	} else {
+		applied_blend_mode = SDL_BLENDMODE_INVALID;
+		if (SDL_SetRenderDrawBlendMode(renderer, blend_mode)) return true;
+		applied_blend_mode = blend_mode;
+	}
+	if (applied_color_valid && color.r == applied_color.r && color.g == applied_color.g && color.b == applied_color.b && color.a == applied_color.a) {
+		elided_calls_p++;
+	} else {
+		applied_color_valid = false;
+		if (SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a)) return true;
+		applied_color = color;
+		applied_color_valid = true;
+	}
+	return false;
+}
+
+/***************************************************************************//**
+ * Private. Sends a render target to SDL, skipping the call if it is already
+ * the target.
+ * @param texture The target, or nullptr for the screen.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::apply_render_target(SDL_Texture* texture) {
+	if (texture == applied_target) {
+		elided_calls_p++;
+		return false;
+	}
+	if (SDL_SetRenderTarget(renderer, texture)) return true;
+	applied_target = texture;
+	// SDL disables clipping when the target changes:
+	if (dirty_frame && texture == back_buffer.texture) return SDL_RenderSetClipRect(renderer, &frame_damage);
+	return false;
+}
+
+/***************************************************************************//**
+ * Private. Returns what drawing to the screen draws to. This is the back buffer
+ * while a frame is being drawn with dirty rendering.
+ * @return The back buffer's texture, or nullptr for the screen itself.
+ ******************************************************************************/
+SDL_Texture* FFG_Renderer::screen_texture() const {
+	return dirty_frame ? back_buffer.texture : nullptr;
+}
+
+/***************************************************************************//**
+ * Private. Clears the current target to the draw color SDL was last given.
+ * While the back buffer is being drawn with dirty rendering, only the damaged
+ * area is cleared, since clearing ignores clipping.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::clear_target() {
+	if (!dirty_frame || applied_target != back_buffer.texture) return SDL_RenderClear(renderer);
+	// Clearing replaces the pixels rather than blending over them:
+	if (applied_blend_mode != SDL_BLENDMODE_NONE) {
+		applied_blend_mode = SDL_BLENDMODE_INVALID;
+		if (SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE)) return true;
+		applied_blend_mode = SDL_BLENDMODE_NONE;
+	}
+	return SDL_RenderFillRect(renderer, &frame_damage);
 }
 
 /***************************************************************************//**
@@ -18,12 +829,16 @@ FFG_Renderer::FFG_Renderer() {
  * application, by FFG_Engine.
  ******************************************************************************/
 void FFG_Renderer::init() {
+	if (window_mode == FFG_WINDOW_HEADLESS) {
+		init_headless();
+		return;
+	}
 	// Initialize SDL:
 	if (SDL_Init(SDL_INIT_EVERYTHING) < 0) throw FFG_RENDERER_SDL_FAIL;
 	// Initialize SDL_Image:
 	if (!(IMG_Init(IMG_INIT_PNG)&IMG_INIT_PNG)) throw FFG_RENDERER_IMG_FAIL;
 	// Initialize the SDL_Window in accordance with the specified mode:
-	Uint32 window_flags;
+	Uint32 window_flags = SDL_WINDOW_SHOWN;
 	switch (window_mode) {
 		case FFG_WINDOW_WINDOWED:
 			window_flags = SDL_WINDOW_SHOWN;
@@ -37,6 +852,8 @@ void FFG_Renderer::init() {
 		// case FFG_WINDOW_BORDERLESS:
 		// 	   window_flags = SDL_WINDOW_SHOWN | SDL_WINDOW_BORDERLESS;
 		// 	   break;
+		case FFG_WINDOW_HEADLESS:
+			break;
 	}
 	window = SDL_CreateWindow(window_title.c_str(), SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, screen_width_p, screen_height_p, window_flags);
 	if (!window) throw FFG_RENDERER_WINDOW_FAIL;
@@ -45,6 +862,48 @@ void FFG_Renderer::init() {
 	if (vsync_p) renderer_flags = renderer_flags | SDL_RENDERER_PRESENTVSYNC;
 	renderer = SDL_CreateRenderer(window, -1, renderer_flags);
 	if (!renderer) throw FFG_RENDERER_RENDERER_FAIL;
+	choose_texture_format();
+	// Retrieve the actual size of the renderer's output:
+	if (SDL_GetRendererOutputSize(renderer, &screen_width_p, &screen_height_p)) throw FFG_RENDERER_SIZE_FAIL;
+}
+
+/***************************************************************************//**
+ * Private. Reads the current render target into a free capture buffer and hands
+ * it to the capture thread. If no buffer is free, the frame is dropped.
+ * NOTE: This method is core loop critical.
+ ******************************************************************************/
+void FFG_Renderer::capture_frame() {
+	int width;
+	int height;
+	if (target_size(&width, &height)) return;
+	FFG_FrameCapture::FFG_CaptureFrame* frame = capture.acquire(width, height);
+	if (!frame) return;
+	if (SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_RGBA32, frame->pixels.data(), width * 4)) {
+		capture.failed++;
+		return;
+	}
+	capture.submit();
+}
+
+/***************************************************************************//**
+ * Private. Initializes the renderer without a window. SDL's dummy video driver
+ * is used so that events can still be polled without a display, and a software
+ * renderer draws into an offscreen surface the size of the screen. Vsync is
+ * ignored.
+ ******************************************************************************/
+void FFG_Renderer::init_headless() {
+	// Initialize SDL with the dummy video driver:
+	SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS | SDL_INIT_TIMER) < 0) throw FFG_RENDERER_SDL_FAIL;
+	// Initialize SDL_Image:
+	if (!(IMG_Init(IMG_INIT_PNG)&IMG_INIT_PNG)) throw FFG_RENDERER_IMG_FAIL;
+	// Initialize the offscreen surface in place of the window:
+	headless_surface = SDL_CreateRGBSurfaceWithFormat(0, screen_width_p, screen_height_p, 32, SDL_PIXELFORMAT_RGBA32);
+	if (!headless_surface) throw FFG_RENDERER_WINDOW_FAIL;
+	// Initialize the software SDL_Renderer:
+	renderer = SDL_CreateSoftwareRenderer(headless_surface);
+	if (!renderer) throw FFG_RENDERER_RENDERER_FAIL;
+	choose_texture_format();
 	// Retrieve the actual size of the renderer's output:
 	if (SDL_GetRendererOutputSize(renderer, &screen_width_p, &screen_height_p)) throw FFG_RENDERER_SIZE_FAIL;
 }
@@ -54,7 +913,42 @@ void FFG_Renderer::init() {
  * application, at the very end, by FFG_Engine.
  ******************************************************************************/
 void FFG_Renderer::exit() {
-	// Destory the renderer:
+	// Finish writing any captured frames, and forget any textures still streaming:
+	capture.stop();
+	stream.stop();
+	// Discard any pending batch or deferred commands:
+	batching = false;
+	batch_texture = nullptr;
+	batch_buffer = nullptr;
+	batch_vertices.clear();
+	deferred = false;
+	deferred_commands.clear();
+	deferred_keys.clear();
+	deferred_rects.clear();
+	deferred_targets.clear();
+	retired_buffers.clear();
+	retired_textures.clear();
+	deferred_target = FFG_RENDERER_DEFERRED_MAX_TARGETS;
+	current_target = nullptr;
+	applied_target = nullptr;
+	applied_blend_mode = SDL_BLENDMODE_INVALID;
+	applied_color_valid = false;
+	dirty_frame = false;
+	// Destory the renderer, along with the textures it owns:
+	back_buffer.texture = nullptr;
+	for (FFG_CachedLayer* layer : layers) layer->texture.texture = nullptr;
+	layers.clear();
+	for (FFG_SpriteCompositor* compositor : compositors) compositor->page.texture = nullptr;
+	compositors.clear();
+	for (FFG_Map* map : maps) {
+		for (FFG_Texture& texture : map->slots) texture.texture = nullptr;
+	}
+	maps.clear();
+	for (FFG_Texture* texture : resident) texture->resident_slot = -1;
+	resident.clear();
+	resident_bytes = 0;
+	cache_paths.clear();
+	cache_memory.clear();
 	if (renderer) {
 		SDL_DestroyRenderer(renderer);
 		renderer = nullptr;
@@ -64,162 +958,1247 @@ void FFG_Renderer::exit() {
 		SDL_DestroyWindow(window);
 		window = nullptr;
 	}
-	// Uninitialize SDL:
-	IMG_Quit();
-	SDL_Quit();
+	if (headless_surface) {
+		SDL_FreeSurface(headless_surface);
+		headless_surface = nullptr;
+	}
+	// Uninitialize SDL:
+	IMG_Quit();
+	SDL_Quit();
+}
+
+/***************************************************************************//**
+ * Protected. Presents what has been drawn to the screen.
+ ******************************************************************************/
+void FFG_Renderer::present() {
+	flush_deferred();
+	flush_batch();
+	if (capture.is_running()) capture_frame();
+	SDL_RenderPresent(renderer);
+}
+
+/***************************************************************************//**
+ * Protected. Begins a frame. While dirty rendering is enabled, the back buffer
+ * is created or resized as needed, layers that are dirty or have moved add
+ * their areas to the damage, and if there is damage, the back buffer is made
+ * the screen and is clipped to the damage.
+ * NOTE: This method is core loop critical.
+ * @return True if the current state should render this frame, otherwise false.
+ ******************************************************************************/
+bool FFG_Renderer::begin_frame() {
+	if (!dirty_rendering || !renderer) return true;
+	int width;
+	int height;
+	if (SDL_GetRendererOutputSize(renderer, &width, &height)) return true;
+	if (!back_buffer.texture || back_buffer.loaded_width != width || back_buffer.loaded_height != height) {
+		unload_texture(back_buffer);
+		back_buffer.set(width, height);
+		if (load_texture(back_buffer)) return true;
+		damage_all();
+	}
+	for (FFG_CachedLayer* layer : layers) {
+		if (layer->dirty) add_damage(layer->area);
+		if (layer->moved) {
+			add_damage(layer->moved_from);
+			add_damage(layer->area);
+			layer->moved = false;
+		}
+	}
+	if (!damaged) return false;
+	const SDL_Rect screen = { 0, 0, width, height };
+	const bool visible = SDL_IntersectRect(&pending_damage, &screen, &frame_damage);
+	damaged = false;
+	if (!visible) return false;
+	if (flush_batch()) return true;
+	dirty_frame = true;
+	current_target = nullptr;
+	if (applied_target == back_buffer.texture) {
+		SDL_RenderSetClipRect(renderer, &frame_damage);
+	} else {
+		apply_render_target(back_buffer.texture);
+	}
+	return true;
+}
+
+/***************************************************************************//**
+ * Protected. Ends a frame. While dirty rendering is enabled, anything pending
+ * is drawn to the back buffer, and the back buffer is copied to the screen.
+ * NOTE: This method is core loop critical.
+ ******************************************************************************/
+void FFG_Renderer::end_frame() {
+	if (!dirty_rendering || !back_buffer.texture) return;
+	if (dirty_frame) {
+		flush_deferred();
+		flush_batch();
+		if (applied_target == back_buffer.texture) SDL_RenderSetClipRect(renderer, nullptr);
+		dirty_frame = false;
+	}
+	current_target = nullptr;
+	apply_render_target(nullptr);
+	SDL_RenderCopy(renderer, back_buffer.texture, nullptr, nullptr);
+}
+
+/***************************************************************************//**
+ * Protected. Composites the cached layers behind or in front of the current
+ * state, from lowest to highest z. Dirty layers are redrawn first. While
+ * drawing is deferred, the layers behind are recorded on layer 0 and those in
+ * front on FFG_RENDERER_MAX_LAYER, so they sort around whatever the state
+ * recorded, and the state's layer is restored afterward.
+ * NOTE: This method is core loop critical.
+ * @param front True to composite the layers with a z of 0 or more. Otherwise
+ * false, to composite the layers with a negative z.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::composite_layers(bool front) {
+	if (layers.empty()) return false;
+	auto by_z = [](const FFG_CachedLayer* a, const FFG_CachedLayer* b) { return a->z_p < b->z_p; };
+	if (!std::is_sorted(layers.begin(), layers.end(), by_z)) std::stable_sort(layers.begin(), layers.end(), by_z);
+	bool failed = false;
+	const unsigned int state_layer = deferred_layer;
+	for (FFG_CachedLayer* layer : layers) {
+		if ((layer->z_p >= 0) != front) continue;
+		if (layer->dirty && redraw_layer(*layer)) failed = true;
+		FFG_Rect source = { 0, 0, layer->area.w, layer->area.h };
+		// Set for each layer, since redrawing may have changed it:
+		deferred_layer = front ? FFG_RENDERER_MAX_LAYER : 0;
+		if (draw(layer->texture, source, layer->area)) failed = true;
+	}
+	deferred_layer = state_layer;
+	return failed;
+}
+
+/***************************************************************************//**
+ * Protected. Marks every cached layer and every baked map chunk to be redrawn,
+ * forgets every baked composite sprite, and damages the whole screen. Called
+ * when the contents of render targets are lost.
+ ******************************************************************************/
+void FFG_Renderer::invalidate_targets() {
+	for (FFG_CachedLayer* layer : layers) layer->dirty = true;
+	for (FFG_SpriteCompositor* compositor : compositors) compositor->forget();
+	for (FFG_Map* map : maps) {
+		for (FFG_Map::FFG_MapChunk& chunk : map->chunks) chunk.dirty = true;
+	}
+	damage_all();
+}
+
+/***************************************************************************//**
+ * Protected. Unloads the textures in the texture cache that are no longer
+ * held. Called by the engine after changing states.
+ ******************************************************************************/
+void FFG_Renderer::collect_textures() {
+	for (auto i = cache_paths.begin(); i != cache_paths.end();) {
+		if (i->second.cache_references > 0) {
+			i++;
+			continue;
+		}
+		unload_texture(i->second);
+		i = cache_paths.erase(i);
+	}
+	for (auto i = cache_memory.begin(); i != cache_memory.end();) {
+		if (i->second.cache_references > 0) {
+			i++;
+			continue;
+		}
+		unload_texture(i->second);
+		i = cache_memory.erase(i);
+	}
+}
+
+/***************************************************************************//**
+ * Protected. Uploads decoded streaming textures, highest priority first, until
+ * the upload budget for the frame is spent. The rest wait for later frames.
+ * With dirty rendering, the whole screen is damaged if anything was uploaded,
+ * since whatever was drawn in place of the textures is now out of date.
+ * NOTE: This method is core loop critical.
+ ******************************************************************************/
+void FFG_Renderer::upload_streamed() {
+	if (!stream.is_running()) return;
+	typedef std::chrono::high_resolution_clock clock;
+	const clock::time_point start = clock::now();
+	bool uploaded = false;
+	FFG_TextureStream::FFG_StreamRequest request;
+	while (std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count() < upload_budget_us && stream.take_ready(request)) {
+		if (!request.surface) continue;
+		// The texture may have been loaded some other way while it was decoding:
+		if (!request.texture->texture && !upload_surface(*request.texture, request.surface)) uploaded = true;
+		SDL_FreeSurface(request.surface);
+	}
+	if (uploaded && dirty_rendering) damage_all();
+}
+
+/***************************************************************************//**
+ * Private. Draws in place of a texture that is not loaded. If the texture was
+ * requested and is still streaming, the placeholder is drawn, if there is one.
+ * NOTE: This method is core loop critical.
+ * @param texture The texture that is not loaded.
+ * @param destination The area to draw to, or nullptr for the entire target.
+ * @return False on success, including when nothing is drawn for a streaming
+ * texture. Otherwise true, including when the texture was never requested.
+ ******************************************************************************/
+bool FFG_Renderer::draw_placeholder(FFG_Texture& texture, const SDL_Rect* destination) {
+	if (!texture.stream_ticket) return true;
+	if (!placeholder || !placeholder->texture) return false;
+	const SDL_Rect source = { 0, 0, placeholder->loaded_width, placeholder->loaded_height };
+	SDL_Rect area = { 0, 0, 0, 0 };
+	if (destination) {
+		area = *destination;
+	} else if (target_size(&area.w, &area.h)) {
+		return true;
+	}
+	if (deferred) return record_sprite(*placeholder, source, area, { placeholder->mod_r, placeholder->mod_g, placeholder->mod_b, placeholder->mod_a });
+	if (batching) return batch_quad(*placeholder, source, area, { placeholder->mod_r, placeholder->mod_g, placeholder->mod_b, placeholder->mod_a }, placeholder->blend_mode, placeholder->texture);
+	return SDL_RenderCopy(renderer, placeholder->texture, nullptr, &area);
+}
+
+/***************************************************************************//**
+ * Private. Loads a texture in the texture cache, if needed, and adds a
+ * reference to it. A texture that was evicted is left to be loaded again when
+ * it is next drawn.
+ * @param texture The texture in the cache.
+ * @return The texture, or nullptr if it failed to load.
+ ******************************************************************************/
+FFG_Texture* FFG_Renderer::acquire_cached(FFG_Texture& texture) {
+	if (!texture.texture && !texture.evicted && load_texture(texture)) return nullptr;
+	texture.cached = true;
+	texture.cache_references++;
+	return &texture;
+}
+
+/***************************************************************************//**
+ * Private. Redraws a cached layer by making its texture the render target,
+ * clearing it to transparent, and calling its callback. The render target and
+ * draw color are restored afterward.
+ * @param layer The layer.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::redraw_layer(FFG_CachedLayer& layer) {
+	FFG_Texture* previous_target = current_target;
+	const SDL_Color previous_color = draw_color;
+	if (set_render_target(layer.texture)) return true;
+	bool failed = set_draw_color(0, 0, 0, 0) || render_clear();
+	if (layer.redraw) layer.redraw();
+	if (previous_target) {
+		if (set_render_target(*previous_target)) failed = true;
+	} else {
+		if (reset_render_target()) failed = true;
+	}
+	if (set_draw_color(previous_color.r, previous_color.g, previous_color.b, previous_color.a)) failed = true;
+	layer.dirty = false;
+	return failed;
+}
+
+/***************************************************************************//**
+ * Private. Bakes a sprite into a slot of a compositor's page: the slot is
+ * cleared to transparent, then each layer is drawn over it with its tint.
+ * Baking happens immediately, even while batching or deferring, so the slot
+ * holds the sprite before anything drawn from it is submitted. The render
+ * target and draw color are restored afterward.
+ * @param compositor The compositor.
+ * @param slot The index of the slot.
+ * @param tints The tint of each layer.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::bake_composite(FFG_SpriteCompositor& compositor, unsigned int slot, const std::vector<SDL_Color>& tints) {
+	if (flush_batch()) return true;
+	SDL_Texture* previous_target = applied_target;
+	if (apply_render_target(compositor.page.texture)) return true;
+	const SDL_Rect area = compositor.slot_rect(slot);
+	// Clearing replaces the pixels rather than blending over them:
+	applied_blend_mode = SDL_BLENDMODE_INVALID;
+	applied_color_valid = false;
+	bool failed = SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE) || SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0) || SDL_RenderFillRect(renderer, &area);
+	for (unsigned int i = 0; i < compositor.layers.size() && !failed; i++) {
+		FFG_Texture& layer = *compositor.layers[i];
+		if (use_texture(layer)) {
+			failed = true;
+			break;
+		}
+		const SDL_Color& tint = tints[i];
+		if (SDL_SetTextureColorMod(layer.texture, tint.r, tint.g, tint.b) || SDL_SetTextureAlphaMod(layer.texture, tint.a)) failed = true;
+		else if (SDL_RenderCopy(renderer, layer.texture, nullptr, &area)) failed = true;
+		// SDL takes the modulation when the copy is made, so the texture's own can be restored at once:
+		if (SDL_SetTextureColorMod(layer.texture, layer.mod_r, layer.mod_g, layer.mod_b) || SDL_SetTextureAlphaMod(layer.texture, layer.mod_a)) failed = true;
+	}
+	if (apply_render_target(previous_target)) failed = true;
+	// Primitives are drawn with whatever color SDL was last given:
+	if (apply_draw_color(draw_color)) failed = true;
+	return failed;
+}
+
+/***************************************************************************//**
+ * Private. Draws each layer of a sprite directly, with its tint, for when the
+ * sprite cannot be baked.
+ * @param compositor The compositor.
+ * @param tints The tint of each layer.
+ * @param screen_x The upper-left x coordinate to draw to on the current target.
+ * @param screen_y The upper-left y coordinate to draw to on the current target.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::draw_layers(FFG_SpriteCompositor& compositor, const std::vector<SDL_Color>& tints, int screen_x, int screen_y) {
+	bool failed = false;
+	FFG_Rect destination = { screen_x, screen_y, compositor.sprite_width, compositor.sprite_height };
+	for (unsigned int i = 0; i < compositor.layers.size(); i++) {
+		FFG_Texture& layer = *compositor.layers[i];
+		if (use_texture(layer)) {
+			failed = true;
+			continue;
+		}
+		const SDL_Color mod = { layer.mod_r, layer.mod_g, layer.mod_b, layer.mod_a };
+		FFG_Rect source = { 0, 0, layer.loaded_width, layer.loaded_height };
+		if (layer.set_mod_color(tints[i].r, tints[i].g, tints[i].b) || layer.set_mod_alpha(tints[i].a) || draw(layer, source, destination)) failed = true;
+		if (layer.set_mod_color(mod.r, mod.g, mod.b) || layer.set_mod_alpha(mod.a)) failed = true;
+	}
+	return failed;
+}
+
+/***************************************************************************//**
+ * Private. Draws the part of an area of a map that is within the camera. The
+ * area and camera are in map pixels, and the camera's top left is drawn at the
+ * screen position.
+ * NOTE: This method is core loop critical.
+ * @param texture The texture to draw from.
+ * @param source The area of the texture to draw, the same size as the area.
+ * @param area The area of the map the source is drawn to.
+ * @param camera The area of the map being drawn.
+ * @param screen_x The x-coordinate on the current target of the camera's left.
+ * @param screen_y The y-coordinate on the current target of the camera's top.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::draw_clipped(FFG_Texture& texture, const SDL_Rect& source, const SDL_Rect& area, const SDL_Rect& camera, int screen_x, int screen_y) {
+	SDL_Rect visible;
+	if (!SDL_IntersectRect(&area, &camera, &visible)) return false;
+	FFG_Rect clipped_source = { source.x + visible.x - area.x, source.y + visible.y - area.y, visible.w, visible.h };
+	FFG_Rect destination = { screen_x + visible.x - camera.x, screen_y + visible.y - camera.y, visible.w, visible.h };
+	return draw(texture, clipped_source, destination);
+}
+
+/***************************************************************************//**
+ * Private. Gives a chunk of a map a texture to be baked into. A free texture is
+ * used if there is one. Otherwise the texture of the chunk least recently drawn
+ * is taken, as long as that chunk was not drawn this frame. Textures are only
+ * created when first used.
+ * @param map The map.
+ * @param chunk The index of the chunk.
+ * @return The slot of the texture, or -1 if none could be given.
+ ******************************************************************************/
+int FFG_Renderer::acquire_map_slot(FFG_Map& map, int chunk) {
+	int slot = -1;
+	for (unsigned int i = 0; i < map.slot_chunks.size(); i++) {
+		if (map.slot_chunks[i] < 0) {
+			slot = i;
+			break;
+		}
+	}
+	if (slot < 0) {
+		for (unsigned int i = 0; i < map.slot_chunks.size(); i++) {
+			const FFG_Map::FFG_MapChunk& owner = map.chunks[map.slot_chunks[i]];
+			if (owner.last_drawn == deferred_frame) continue;
+			if (slot < 0 || owner.last_drawn < map.chunks[map.slot_chunks[slot]].last_drawn) slot = i;
+		}
+		if (slot < 0) return -1;
+		map.chunks[map.slot_chunks[slot]].slot = -1;
+		map.slot_chunks[slot] = -1;
+	}
+	FFG_Texture& texture = map.slots[slot];
+	if (!texture.texture) {
+		if (load_texture(texture)) return -1;
+		if (texture.set_blend_mode(FFG_BLEND_ALPHA)) {
+			unload_texture(texture);
+			return -1;
+		}
+	}
+	map.slot_chunks[slot] = chunk;
+	map.chunks[chunk].slot = slot;
+	return slot;
+}
+
+/***************************************************************************//**
+ * Private. Draws the tiles of a chunk of a map into its texture. The render
+ * target and draw color are restored afterward.
+ * @param map The map.
+ * @param chunk The index of the chunk, which must have a texture.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::bake_map_chunk(FFG_Map& map, int chunk) {
+	FFG_Texture* previous_target = current_target;
+	const SDL_Color previous_color = draw_color;
+	const bool was_batching = batching;
+	if (set_render_target(map.slots[map.chunks[chunk].slot])) return true;
+	bool failed = set_draw_color(0, 0, 0, 0) || render_clear();
+	const int columns = std::max(1, map.tileset->loaded_width / map.tile_width_p);
+	const int x0 = (chunk % map.chunks_x) * map.chunk_size_p;
+	const int y0 = (chunk / map.chunks_x) * map.chunk_size_p;
+	const int x1 = std::min(x0 + map.chunk_size_p, map.width_p);
+	const int y1 = std::min(y0 + map.chunk_size_p, map.height_p);
+	begin_batch();
+	for (int y = y0; y < y1; y++) {
+		for (int x = x0; x < x1; x++) {
+			const int tile = map.tiles[y * map.width_p + x];
+			if (tile < 0) continue;
+			FFG_Rect source = { (tile % columns) * map.tile_width_p, (tile / columns) * map.tile_height_p, map.tile_width_p, map.tile_height_p };
+			FFG_Rect destination = { (x - x0) * map.tile_width_p, (y - y0) * map.tile_height_p, map.tile_width_p, map.tile_height_p };
+			if (draw(*map.tileset, source, destination)) failed = true;
+		}
+	}
+	if (!was_batching && end_batch()) failed = true;
+	if (previous_target) {
+		if (set_render_target(*previous_target)) failed = true;
+	} else {
+		if (reset_render_target()) failed = true;
+	}
+	if (set_draw_color(previous_color.r, previous_color.g, previous_color.b, previous_color.a)) failed = true;
+	if (!failed) map.chunks[chunk].dirty = false;
+	return failed;
+}
+
+/***************************************************************************//**
+ * Private. Draws the tiles of a chunk of a map that are within the camera one
+ * by one, for when the chunk could not be baked.
+ * @param map The map.
+ * @param chunk The index of the chunk.
+ * @param camera The area of the map being drawn, in pixels.
+ * @param screen_x The x-coordinate on the current target of the camera's left.
+ * @param screen_y The y-coordinate on the current target of the camera's top.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::draw_map_tiles(FFG_Map& map, int chunk, const SDL_Rect& camera, int screen_x, int screen_y) {
+	const int columns = std::max(1, map.tileset->loaded_width / map.tile_width_p);
+	const int x0 = std::max((chunk % map.chunks_x) * map.chunk_size_p, camera.x / map.tile_width_p);
+	const int y0 = std::max((chunk / map.chunks_x) * map.chunk_size_p, camera.y / map.tile_height_p);
+	const int x1 = std::min(std::min(((chunk % map.chunks_x) + 1) * map.chunk_size_p, map.width_p), (camera.x + camera.w - 1) / map.tile_width_p + 1);
+	const int y1 = std::min(std::min(((chunk / map.chunks_x) + 1) * map.chunk_size_p, map.height_p), (camera.y + camera.h - 1) / map.tile_height_p + 1);
+	bool failed = false;
+	for (int y = y0; y < y1; y++) {
+		for (int x = x0; x < x1; x++) {
+			const int tile = map.tiles[y * map.width_p + x];
+			if (tile < 0) continue;
+			const SDL_Rect source = { (tile % columns) * map.tile_width_p, (tile / columns) * map.tile_height_p, map.tile_width_p, map.tile_height_p };
+			const SDL_Rect area = { x * map.tile_width_p, y * map.tile_height_p, map.tile_width_p, map.tile_height_p };
+			if (draw_clipped(*map.tileset, source, area, camera, screen_x, screen_y)) failed = true;
+		}
+	}
+	return failed;
+}
+
+/***************************************************************************//**
+ * Sets the title of the window. Can be called at any time. If it is called
+ * before the initialization of the window, the name will be used when the
+ * window is created. If it is called after the initialization of the window,
+ * will update the window's title immediately.
+ * @param window_title The new window title.
+ ******************************************************************************/
+void FFG_Renderer::set_window_title(const std::string& window_title) {
+	this->window_title = window_title;
+	if (window && renderer) SDL_SetWindowTitle(window, this->window_title.c_str());
+}
+
+/***************************************************************************//**
+ * Sets the screen width and height as well as its mode. Note that
+ * FFG_WINDOW_MATCHDEKSTOP will ignore the width and height. Can be called
+ * before engine initialization in order to set initial window state. If called
+ * afterwards, will update the screen. The screen width and height specified
+ * might not be the width and height used. Use FFG_Renderer::get_screen_width()
+ * and FFG_Renderer::get_screen_height() to query those.
+ * @param width The width of the window.
+ * @param height The height of the window.
+ * @param mode The window mode.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::set_screen_mode(int width, int height, FFG_WindowMode mode) {
+	if (width < 1) width = 1;
+	if (height < 1) height = 1;
+	// The offscreen surface cannot be swapped for a window, or resized, once created:
+	if (renderer && (mode == FFG_WINDOW_HEADLESS || window_mode == FFG_WINDOW_HEADLESS)) return true;
+	window_mode = mode;
+	if (renderer) {
+		switch (mode) {
+			case FFG_WINDOW_WINDOWED:
+				if (SDL_SetWindowFullscreen(window, 0)) return true;
+				SDL_SetWindowBordered(window, SDL_TRUE);
+				SDL_SetWindowSize(window, width, height);
+				break;
+			case FFG_WINDOW_MATCHDESKTOP:
+				SDL_SetWindowBordered(window, SDL_TRUE);
+				SDL_SetWindowSize(window, width, height);
+				if (SDL_SetWindowFullscreen(window, SDL_WINDOW_FULLSCREEN_DESKTOP)) return true;
+				break;
+			case FFG_WINDOW_HEADLESS:
+				break;
+		}
+		if (SDL_GetRendererOutputSize(renderer, &screen_width_p, &screen_height_p)) return true;
+	} else {
+		screen_width_p = width;
+		screen_height_p = height;
+	}
+	return false;
+}
+
+/***************************************************************************//**
+ * Sets Vsync to on or off. Should be set prior to running the engine,
+ * otherwise this method is a no-op.
+ * @param vsync TRUE if vsync should be enabled. Otherwise FALSE.
+ ******************************************************************************/
+void FFG_Renderer::set_vsync(bool vsync) {
+	vsync_p = vsync;
+}
+
+/***************************************************************************//**
+ * Gets the screen's width. O(1).
+ * @return The screen's width.
+ ******************************************************************************/
+int FFG_Renderer::screen_width() const {
+	return screen_width_p;
+}
+
+/***************************************************************************//**
+ * Gets the screen's height. O(1).
+ * @return The screen's height.
+ ******************************************************************************/
+int FFG_Renderer::screen_height() const {
+	return screen_height_p;
+}
+
+/***************************************************************************//**
+ * Indicates if a flag is set on the window. No flags are set when headless.
+ * @return If the flag is set on the window.
+ ******************************************************************************/
+bool FFG_Renderer::check_window_flag(FFG_WindowFlag window_flag) {
+	if (!window) return false;
+	Uint32 check_flag = 0;
+	switch(window_flag) {
+		case FFG_WINFLAG_MINIMIZED:
+			check_flag = SDL_WINDOW_MINIMIZED;
+			break;
+		case FFG_WINFLAG_MAXIMIZED:
+			check_flag = SDL_WINDOW_MAXIMIZED;
+			break;
+		case FFG_WINFLAG_INPUT_FOCUS:
+			check_flag = SDL_WINDOW_INPUT_FOCUS;
+			break;
+		case FFG_WINFLAG_MOUSE_FOCUS:
+			check_flag = SDL_WINDOW_MOUSE_FOCUS;
+			break;
+	}
+	return check_flag & SDL_GetWindowFlags(window);
+}
+
+/***************************************************************************//**
+ * Reads back what has been drawn to the current render target as RGBA pixels,
+ * four bytes per pixel, row by row from the top. Anything pending in a batch
+ * or deferred is drawn first. When drawing to a window the screen should be
+ * read before it is presented, since its contents are undefined afterward.
+ * The offscreen surface used when headless keeps its contents.
+ * @param pixels Resized and filled with the pixels.
+ * @param width Set to the width of the current target.
+ * @param height Set to the height of the current target.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::read_pixels(std::vector<Uint8>& pixels, int* width, int* height) {
+	if (!renderer) return true;
+	if (!deferred_commands.empty() && flush_deferred()) return true;
+	if (flush_batch()) return true;
+	if (target_size(width, height)) return true;
+	pixels.resize((std::size_t)(*width) * (*height) * 4);
+	if (pixels.empty()) return false;
+	return SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_RGBA32, pixels.data(), *width * 4);
+}
+
+/***************************************************************************//**
+ * Starts capturing every presented frame to .png files named by the path
+ * prefix followed by the frame number. Should only be called after engine
+ * initialization.
+ * @param path_prefix The path each frame's number and extension are added to.
+ * @param ring_size The number of frames that can wait to be written before
+ * further frames are dropped.
+ * @return False on success. Otherwise true, such as if already capturing.
+ ******************************************************************************/
+bool FFG_Renderer::start_capture(const std::string& path_prefix, unsigned int ring_size) {
+	if (!renderer) return true;
+	int width;
+	int height;
+	if (target_size(&width, &height)) return true;
+	return capture.start(path_prefix, ring_size, width, height);
+}
+
+/***************************************************************************//**
+ * Stops capturing frames. Waits for the frames already captured to be written.
+ ******************************************************************************/
+void FFG_Renderer::stop_capture() {
+	capture.stop();
+}
+
+/***************************************************************************//**
+ * Returns the number of frames captured since capturing last started.
+ * @return The number of frames captured.
+ ******************************************************************************/
+unsigned long FFG_Renderer::captured_frames() const {
+	return capture.captured_frames();
+}
+
+/***************************************************************************//**
+ * Returns the number of frames dropped since capturing last started, because
+ * too many frames were still waiting to be written.
+ * @return The number of frames dropped.
+ ******************************************************************************/
+unsigned long FFG_Renderer::dropped_frames() const {
+	return capture.dropped_frames();
+}
+
+/***************************************************************************//**
+ * Returns the number of frames that failed to be read back, encoded, or
+ * written since capturing last started.
+ * @return The number of frames that failed.
+ ******************************************************************************/
+unsigned long FFG_Renderer::failed_frames() const {
+	return capture.failed_frames();
+}
+
+/***************************************************************************//**
+ * Loads the texture.
+ * @param texture The texture to load.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::load_texture(FFG_Texture& texture) {
+	if (texture.texture) return false;
+	SDL_Surface* loaded_surface = nullptr;
+	switch (texture.type) {
+		case FFG_TEXTURE_STR:
+		case FFG_TEXTURE_MEM: {
+			// Load the unoptimized PNG from path/memory, converted once to the native format:
+			loaded_surface = prepare_surface(texture, texture_format, load_filter);
+			// Create a texture from the surface:
+			if (!loaded_surface) return true;
+			const bool failed = upload_surface(texture, loaded_surface);
+			SDL_FreeSurface(loaded_surface);
+			return failed;
+		}
+		case FFG_TEXTURE_RAW:
+			// Upload the pixels as they are:
+			return upload_raw(texture);
+		case FFG_TEXTURE_DRAWTO:
+			// Create an empty draw-toable texture:
+			texture.texture = SDL_CreateTexture(renderer, texture_format, SDL_TEXTUREACCESS_TARGET, texture.drawto_width, texture.drawto_height);
+			break;
+		case FFG_TEXTURE_STREAMING:
+			// Create both buffers of a transparent streaming texture:
+			if (create_streaming(texture)) return true;
+			break;
+	}
+	return query_texture(texture);
+}
+
+/***************************************************************************//**
+ * Loads many textures at once. Images are decoded and converted to the native
+ * pixel format on a pool of worker threads, and each is uploaded on this thread
+ * as soon as it is ready. Draw-toable and streaming textures are created first,
+ * and textures already loaded are skipped. Every texture is attempted even if
+ * some fail.
+ * @param textures The textures to load.
+ * @param progress If given, called on this thread as each texture finishes.
+ * @return False on success. Otherwise true, if any texture failed to load.
+ ******************************************************************************/
+bool FFG_Renderer::load_textures(const std::vector<FFG_Texture*>& textures, const std::function<void(const FFG_LoadProgress&)>& progress) {
+	if (!renderer) return true;
+	typedef std::chrono::high_resolution_clock clock;
+	auto elapsed_us = [](clock::time_point start) { return (int)std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count(); };
+	class FFG_PendingLoad {
+	public:
+		SDL_Surface* surface = nullptr;
+		int decode_us = 0;
+		int convert_us = 0;
+	};
+	bool failed = false;
+	FFG_LoadProgress report;
+	report.done = 0;
+	report.total = textures.size();
+	auto finish = [&](unsigned int index, bool texture_failed, int decode_us, int convert_us, int upload_us) {
+		if (texture_failed) failed = true;
+		report.index = index;
+		report.done++;
+		report.failed = texture_failed;
+		report.decode_us = decode_us;
+		report.convert_us = convert_us;
+		report.upload_us = upload_us;
+		if (progress) progress(report);
+	};
+	// Draw-toable, streaming and already loaded textures need no decoding:
+	std::vector<unsigned int> decode;
+	for (unsigned int i = 0; i < textures.size(); i++) {
+		FFG_Texture& texture = *textures[i];
+		if (texture.texture) {
+			finish(i, false, 0, 0, 0);
+		} else if (texture.type == FFG_TEXTURE_DRAWTO || texture.type == FFG_TEXTURE_STREAMING) {
+			const clock::time_point start = clock::now();
+			const bool texture_failed = load_texture(texture);
+			finish(i, texture_failed, 0, 0, elapsed_us(start));
+		} else {
+			decode.push_back(i);
+		}
+	}
+	if (decode.empty()) return failed;
+	// Decode and convert on the workers, handing back finished images in any order:
+	std::vector<FFG_PendingLoad> pending(decode.size());
+	std::vector<unsigned int> finished;
+	finished.reserve(decode.size());
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::atomic<unsigned int> next(0);
+	auto work = [&]() {
+		unsigned int job;
+		while ((job = next++) < decode.size()) {
+			FFG_PendingLoad& load = pending[job];
+			clock::time_point start = clock::now();
+			SDL_Surface* decoded = load_surface(*textures[decode[job]]);
+			load.decode_us = elapsed_us(start);
+			if (decoded) {
+				start = clock::now();
+				load.surface = FFG_PixelOps::convert_surface(decoded, texture_format);
+				if (load.surface && load_filter) load_filter(*textures[decode[job]], load.surface);
+				load.convert_us = elapsed_us(start);
+			}
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				finished.push_back(job);
+			}
+			condition.notify_one();
+		}
+	};
+	unsigned int num_threads = std::thread::hardware_concurrency();
+	if (num_threads < 1) num_threads = 1;
+	if (num_threads > FFG_RENDERER_MAX_LOAD_THREADS) num_threads = FFG_RENDERER_MAX_LOAD_THREADS;
+	if (num_threads > decode.size()) num_threads = decode.size();
+	std::vector<std::thread> workers;
+	for (unsigned int i = 0; i < num_threads; i++) workers.push_back(std::thread(work));
+	// Upload each image here as soon as it is ready:
+	for (unsigned int uploaded = 0; uploaded < decode.size(); uploaded++) {
+		unsigned int job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [&]() { return uploaded < finished.size(); });
+			job = finished[uploaded];
+		}
+		FFG_PendingLoad& load = pending[job];
+		const clock::time_point start = clock::now();
+		const bool texture_failed = !load.surface || upload_surface(*textures[decode[job]], load.surface);
+		const int upload_us = elapsed_us(start);
+		if (load.surface) SDL_FreeSurface(load.surface);
+		load.surface = nullptr;
+		finish(decode[job], texture_failed, load.decode_us, load.convert_us, upload_us);
+	}
+	for (std::thread& worker : workers) worker.join();
+	return failed;
+}
+
+/***************************************************************************//**
+ * Requests that a texture be loaded in the background. Its image is decoded on
+ * a background thread, and it is uploaded during a later frame, within the
+ * upload budget. FFG_Texture::is_loaded() reports when it is ready. Requesting
+ * a texture already requested changes its priority. Draw-toable and streaming
+ * textures have nothing to decode, and are loaded immediately. The texture must
+ * not be changed until it is loaded, cancelled, or unloaded.
+ * @param texture The texture to load.
+ * @param priority The priority. Higher priorities are loaded first, and equal
+ * priorities are loaded in the order they were requested.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::request_texture(FFG_Texture& texture, int priority) {
+	if (!renderer) return true;
+	if (texture.texture) return false;
+	if (texture.type == FFG_TEXTURE_DRAWTO || texture.type == FFG_TEXTURE_STREAMING) return load_texture(texture);
+	if (!stream.is_running() && stream.start(texture_format)) return true;
+	texture.owner = this;
+	stream.request(texture, priority);
+	return false;
+}
+
+/***************************************************************************//**
+ * Cancels a texture's request, if it has not been loaded yet.
+ * @param texture The texture.
+ ******************************************************************************/
+void FFG_Renderer::cancel_texture(FFG_Texture& texture) {
+	stream.cancel(texture);
+}
+
+/***************************************************************************//**
+ * Locks an area of a streaming texture for writing. The pixels given are the
+ * texture's own copy, in its pixel format, so they hold what was last written
+ * and may be read as well as written. Only the area locked is uploaded when
+ * the texture is unlocked.
+ * @param texture The texture to lock, loaded as a streaming texture.
+ * @param area The area to lock, which is clipped to the texture, or nullptr to
+ * lock the whole texture.
+ * @param pixels Set to the first pixel of the area.
+ * @param pitch Set to the number of bytes between rows of pixels.
+ * @return False on success. Otherwise true, if the texture is not a loaded
+ * streaming texture, is already locked, or the area is empty.
+ ******************************************************************************/
+bool FFG_Renderer::lock_texture(FFG_Texture& texture, const FFG_Rect* area, Uint8** pixels, int* pitch) {
+	if (texture.type != FFG_TEXTURE_STREAMING || !texture.texture || texture.locked) return true;
+	const SDL_Rect bounds = { 0, 0, texture.loaded_width, texture.loaded_height };
+	SDL_Rect locked = bounds;
+	if (area && !SDL_IntersectRect(area, &bounds, &locked)) return true;
+	texture.lock_rect = locked;
+	texture.locked = true;
+	*pixels = texture.lock_pixels.data() + (std::size_t)locked.y * texture.lock_pitch + (std::size_t)locked.x * SDL_BYTESPERPIXEL(texture.format);
+	*pitch = texture.lock_pitch;
+	return false;
+}
+
+/***************************************************************************//**
+ * Unlocks a streaming texture, uploading the area that was locked to the
+ * buffer not being drawn, and then swapping the buffers. Draws of the texture
+ * made before unlocking show the old pixels, and draws made after show the new
+ * ones, including deferred draws, which keep the buffer they were recorded
+ * with. If a buffer swapped out earlier in the frame may still be drawn by
+ * deferred draws, it is replaced with a new one, and is destroyed once the
+ * deferred draws are replayed. The blend mode and color modulation carry over.
+ * @param texture The texture to unlock.
+ * @return False on success. Otherwise true, if the texture is not locked or
+ * uploading fails. The texture is unlocked either way.
+ ******************************************************************************/
+bool FFG_Renderer::unlock_texture(FFG_Texture& texture) {
+	if (!texture.locked) return true;
+	texture.locked = false;
+	if (texture.swap_frame == deferred_frame && texture.deferred_frame == deferred_frame && !deferred_commands.empty()) {
+		SDL_Texture* buffer = SDL_CreateTexture(renderer, texture.format, SDL_TEXTUREACCESS_STREAMING, texture.loaded_width, texture.loaded_height);
+		if (!buffer) return true;
+		retired_buffers.push_back(texture.back_texture);
+		texture.back_texture = buffer;
+		texture.back_damage = { 0, 0, texture.loaded_width, texture.loaded_height };
+	}
+	// The back buffer also lacks the area uploaded before the last swap:
+	SDL_Rect area = texture.lock_rect;
+	if (!SDL_RectEmpty(&texture.back_damage)) SDL_UnionRect(&area, &texture.back_damage, &area);
+	if (upload_pixels(texture, texture.back_texture, area)) {
+		texture.back_damage = area;
+		return true;
+	}
+	if (batch_texture == &texture) flush_batch();
+	SDL_BlendMode blend_mode;
+	if (SDL_GetTextureBlendMode(texture.texture, &blend_mode) || SDL_SetTextureBlendMode(texture.back_texture, blend_mode)) return true;
+	if (SDL_SetTextureColorMod(texture.back_texture, texture.mod_r, texture.mod_g, texture.mod_b) || SDL_SetTextureAlphaMod(texture.back_texture, texture.mod_a)) return true;
+	std::swap(texture.texture, texture.back_texture);
+	texture.back_damage = texture.lock_rect;
+	texture.swap_frame = deferred_frame;
+	return false;
+}
+
+/***************************************************************************//**
+ * Sets the number of microseconds the engine may spend uploading streamed
+ * textures each frame. The budget is checked before each upload, so a single
+ * large texture may overrun it. A budget of 0 pauses uploading.
+ * @param us The number of microseconds.
+ ******************************************************************************/
+void FFG_Renderer::set_upload_budget(int us) {
+	upload_budget_us = (us < 0) ? 0 : us;
+}
+
+/***************************************************************************//**
+ * Sets the texture drawn in place of requested textures that are not yet
+ * loaded. It is drawn stretched over the area the texture would have covered.
+ * The placeholder must remain valid until it is replaced.
+ * @param texture The placeholder, or nullptr to draw nothing instead.
+ ******************************************************************************/
+void FFG_Renderer::set_placeholder(FFG_Texture* texture) {
+	placeholder = texture;
+}
+
+/***************************************************************************//**
+ * Returns the number of textures requested and not yet loaded.
+ * @return The number of textures.
+ ******************************************************************************/
+unsigned int FFG_Renderer::streaming_textures() {
+	return stream.size();
+}
+
+/***************************************************************************//**
+ * Sets the most memory loaded textures may use before the least recently drawn
+ * are evicted. Evicts textures immediately if the budget is already exceeded.
+ * @param bytes The budget in bytes, or 0 for no budget.
+ ******************************************************************************/
+void FFG_Renderer::set_texture_budget(std::size_t bytes) {
+	texture_budget_p = bytes;
+	enforce_texture_budget();
+}
+
+/***************************************************************************//**
+ * Returns the most memory loaded textures may use.
+ * @return The budget in bytes, or 0 if there is no budget.
+ ******************************************************************************/
+std::size_t FFG_Renderer::texture_budget() const {
+	return texture_budget_p;
+}
+
+/***************************************************************************//**
+ * Returns an estimate of the memory used by loaded textures, from their sizes
+ * and pixel formats.
+ * @return The number of bytes.
+ ******************************************************************************/
+std::size_t FFG_Renderer::texture_bytes() const {
+	return resident_bytes;
+}
+
+/***************************************************************************//**
+ * Returns the texture cache's texture for an image at a path, loading it if it
+ * is not already loaded, and adds a reference to it. The texture must not be
+ * unloaded or changed, and is released with FFG_Renderer::release_texture().
+ * @param path The path to the image in .png format.
+ * @return The texture, or nullptr if it failed to load.
+ ******************************************************************************/
+FFG_Texture* FFG_Renderer::acquire_texture(const std::string& path) {
+	if (!renderer) return nullptr;
+	auto found = cache_paths.find(path);
+	if (found == cache_paths.end()) found = cache_paths.emplace(path, FFG_Texture(path)).first;
+	FFG_Texture* texture = acquire_cached(found->second);
+	if (!texture && found->second.cache_references == 0) cache_paths.erase(found);
+	return texture;
+}
+
+/***************************************************************************//**
+ * Returns the texture cache's texture for an image in memory, loading it if it
+ * is not already loaded, and adds a reference to it. Images are told apart by
+ * their address and size, so the memory must not change while it is cached.
+ * The texture must not be unloaded or changed, and is released with
+ * FFG_Renderer::release_texture().
+ * @param mem A pointer to the image data, encoded as a .png.
+ * @param size_b The size of the data pointed to by mem.
+ * @return The texture, or nullptr if it failed to load.
+ ******************************************************************************/
+FFG_Texture* FFG_Renderer::acquire_texture(void* const mem, const unsigned int size_b) {
+	if (!renderer) return nullptr;
+	const std::pair<void*, unsigned int> key(mem, size_b);
+	auto found = cache_memory.find(key);
+	if (found == cache_memory.end()) found = cache_memory.emplace(key, FFG_Texture(mem, size_b)).first;
+	FFG_Texture* texture = acquire_cached(found->second);
+	if (!texture && found->second.cache_references == 0) cache_memory.erase(found);
+	return texture;
+}
+
+/***************************************************************************//**
+ * Removes a reference to a texture from the texture cache. Once no references
+ * remain, the texture is unloaded the next time the engine changes states,
+ * unless it is acquired again first.
+ * @param texture The texture, as returned by FFG_Renderer::acquire_texture().
+ * Does nothing if nullptr or not from the cache.
+ ******************************************************************************/
+void FFG_Renderer::release_texture(FFG_Texture* texture) {
+	if (!texture || !texture->cached || texture->cache_references == 0) return;
+	texture->cache_references--;
+}
+
+/***************************************************************************//**
+ * Returns the number of textures in the texture cache, including those no
+ * longer held that have not been unloaded yet.
+ * @return The number of textures.
+ ******************************************************************************/
+unsigned int FFG_Renderer::cached_textures() const {
+	return cache_paths.size() + cache_memory.size();
+}
+
+/***************************************************************************//**
+ * Unloads the texture. While drawing is deferred, draws of the texture already
+ * recorded are still replayed in order, and its buffers are destroyed once they
+ * are.
+ * @param texture The texture to unload.
+ ******************************************************************************/
+void FFG_Renderer::unload_texture(FFG_Texture& texture) {
+	stream.cancel(texture);
+	untrack_texture(texture);
+	texture.evicted = false;
+	if (batch_texture == &texture) flush_batch();
+	if (!deferred_commands.empty()) {
+		retire_texture(texture);
+	} else {
+		// SDL resets the render target when the target is destroyed:
+		if (texture.texture && applied_target == texture.texture) applied_target = nullptr;
+		if (texture.texture) SDL_DestroyTexture(texture.texture);
+		if (texture.back_texture) SDL_DestroyTexture(texture.back_texture);
+	}
+	texture.texture = nullptr;
+	texture.back_texture = nullptr;
+	texture.lock_pixels.clear();
+	texture.locked = false;
+	if (current_target == &texture) reset_render_target();
 }
 
 /***************************************************************************//**
- * Protected. Presents what has been drawn to the screen.
+ * Private. Sets aside the buffers of a texture being unloaded while there are
+ * deferred commands, so that the draws already recorded from it are still
+ * replayed in order. Those draws are pointed at a stand-in that holds what
+ * replaying needs, since the texture itself may be destroyed before then. Draws
+ * recorded onto the texture, as a render target, are dropped. The buffers and
+ * stand-ins are destroyed once the deferred commands are replayed.
+ * @param texture The texture being unloaded.
  ******************************************************************************/
-void FFG_Renderer::present() {
-	SDL_RenderPresent(renderer);
+void FFG_Renderer::retire_texture(FFG_Texture& texture) {
+	if (texture.deferred_frame == deferred_frame && texture.texture) {
+		retired_textures.emplace_back();
+		FFG_Texture& stand_in = retired_textures.back();
+		stand_in.texture = texture.texture;
+		stand_in.loaded_width = texture.loaded_width;
+		stand_in.loaded_height = texture.loaded_height;
+		stand_in.format = texture.format;
+		stand_in.blend_mode = texture.blend_mode;
+		stand_in.mod_r = texture.mod_r;
+		stand_in.mod_g = texture.mod_g;
+		stand_in.mod_b = texture.mod_b;
+		stand_in.mod_a = texture.mod_a;
+		for (FFG_RenderCommand& command : deferred_commands) {
+			if (command.texture == &texture) command.texture = &stand_in;
+		}
+	}
+	if (texture.deferred_target_frame == deferred_frame) deferred_targets[texture.deferred_target_slot] = nullptr;
+	texture.deferred_frame = 0;
+	texture.deferred_target_frame = 0;
+	if (texture.texture) retired_buffers.push_back(texture.texture);
+	if (texture.back_texture) retired_buffers.push_back(texture.back_texture);
 }
 
 /***************************************************************************//**
- * Sets the title of the window. Can be called at any time. If it is called
- * before the initialization of the window, the name will be used when the
- * window is created. If it is called after the initialization of the window,
- * will update the window's title immediately.
- * @param window_title The new window title.
+ * Private. Extrudes the edge pixels of an area of a surface outward into the
+ * padding around it, clipped to the surface, so that linear filtering at the
+ * edges of the area samples its own pixels rather than its neighbours'.
+ * @param surface The surface, which must not need locking.
+ * @param area The area to extrude the edges of.
+ * @param padding How many pixels to extrude by.
  ******************************************************************************/
-void FFG_Renderer::set_window_title(const std::string& window_title) {
-	this->window_title = window_title;
-	if (window && renderer) SDL_SetWindowTitle(window, this->window_title.c_str());
+void FFG_Renderer::extrude_edges(SDL_Surface* surface, const SDL_Rect& area, int padding) {
+	const int bpp = surface->format->BytesPerPixel;
+	Uint8* pixels = (Uint8*)surface->pixels;
+	const int x0 = std::max(area.x - padding, 0);
+	const int x1 = std::min(area.x + area.w + padding, surface->w);
+	// Each row of the area, outward to the left and right:
+	for (int y = area.y; y < area.y + area.h; y++) {
+		Uint8* row = pixels + (std::size_t)y * surface->pitch;
+		for (int x = x0; x < area.x; x++) std::memcpy(row + x * bpp, row + area.x * bpp, bpp);
+		for (int x = area.x + area.w; x < x1; x++) std::memcpy(row + x * bpp, row + (area.x + area.w - 1) * bpp, bpp);
+	}
+	// Then the extended top and bottom rows, up and down, filling the corners:
+	const std::size_t row_size = (std::size_t)(x1 - x0) * bpp;
+	const Uint8* top = pixels + (std::size_t)area.y * surface->pitch + x0 * bpp;
+	const Uint8* bottom = pixels + (std::size_t)(area.y + area.h - 1) * surface->pitch + x0 * bpp;
+	for (int y = std::max(area.y - padding, 0); y < area.y; y++) std::memcpy(pixels + (std::size_t)y * surface->pitch + x0 * bpp, top, row_size);
+	for (int y = area.y + area.h; y < std::min(area.y + area.h + padding, surface->h); y++) std::memcpy(pixels + (std::size_t)y * surface->pitch + x0 * bpp, bottom, row_size);
 }
 
 /***************************************************************************//**
- * Sets the screen width and height as well as its mode. Note that
- * FFG_WINDOW_MATCHDEKSTOP will ignore the width and height. Can be called
- * before engine initialization in order to set initial window state. If called
- * afterwards, will update the screen. The screen width and height specified
- * might not be the width and height used. Use FFG_Renderer::get_screen_width()
- * and FFG_Renderer::get_screen_height() to query those.
- * @param width The width of the window.
- * @param height The height of the window.
- * @param mode The window mode.
+ * Loads the atlas. Every image added to the atlas is decoded, the images are
+ * packed onto pages, and each page is uploaded as a single texture. The edge
+ * pixels of each image are extruded into the padding around it, so that images
+ * drawn with linear filtering do not bleed into each other. If any image fails
+ * to load or is larger than a page, nothing is loaded.
+ * @param atlas The atlas to load.
  * @return False on success. Otherwise true.
  ******************************************************************************/
-bool FFG_Renderer::set_screen_mode(int width, int height, FFG_WindowMode mode) {
-	if (width < 1) width = 1;
-	if (height < 1) height = 1;
-	window_mode = mode;
-	if (renderer) {
-		switch (mode) {
-			case FFG_WINDOW_WINDOWED:
-				if (SDL_SetWindowFullscreen(window, 0)) return true;
-				SDL_SetWindowBordered(window, SDL_TRUE);
-				SDL_SetWindowSize(window, width, height);
-				break;
-			case FFG_WINDOW_MATCHDESKTOP:
-				SDL_SetWindowBordered(window, SDL_TRUE);
-				SDL_SetWindowSize(window, width, height);
-				if (SDL_SetWindowFullscreen(window, SDL_WINDOW_FULLSCREEN_DESKTOP)) return true;
-				break;
+bool FFG_Renderer::load_atlas(FFG_TextureAtlas& atlas) {
+	if (atlas.is_loaded()) return false;
+	if (atlas.entries.empty()) return true;
+	// Pages may not exceed the largest texture the renderer supports:
+	int max_page_size = atlas.page_size;
+	SDL_RendererInfo info;
+	if (SDL_GetRendererInfo(renderer, &info)) return true;
+	if (info.max_texture_width > 0 && info.max_texture_width < max_page_size) max_page_size = info.max_texture_width;
+	if (info.max_texture_height > 0 && info.max_texture_height < max_page_size) max_page_size = info.max_texture_height;
+	// Decode every image:
+	std::vector<SDL_Surface*> surfaces(atlas.entries.size(), nullptr);
+	bool failed = false;
+	for (unsigned int i = 0; i < surfaces.size(); i++) {
+		// Converted first, so composing the pages only copies pixels:
+		surfaces[i] = prepare_surface(atlas.entries[i].source, texture_format, load_filter);
+		if (!surfaces[i]) {
+			failed = true;
+			break;
 		}
-		if (SDL_GetRendererOutputSize(renderer, &screen_width_p, &screen_height_p)) return true;
-	} else {
-		screen_width_p = width;
-		screen_height_p = height;
+		atlas.entries[i].rect.w = surfaces[i]->w;
+		atlas.entries[i].rect.h = surfaces[i]->h;
 	}
-	return false;
+	// Pack the images and compose each page:
+	if (!failed) failed = atlas.pack(max_page_size);
+	if (!failed) atlas.pages.resize(atlas.page_extents.size());
+	for (unsigned int page = 0; page < atlas.pages.size() && !failed; page++) {
+		const FFG_Rect& extent = atlas.page_extents[page];
+		SDL_Surface* page_surface = SDL_CreateRGBSurfaceWithFormat(0, extent.w, extent.h, SDL_BITSPERPIXEL(texture_format), texture_format);
+		if (!page_surface) {
+			failed = true;
+			break;
+		}
+		for (unsigned int i = 0; i < surfaces.size() && !failed; i++) {
+			if (atlas.entries[i].page != (int)page) continue;
+			SDL_Rect destination = atlas.entries[i].rect;
+			// Copy the pixels as they are, rather than blending them onto the page:
+			if (SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE)) failed = true;
+			else if (SDL_BlitSurface(surfaces[i], nullptr, page_surface, &destination)) failed = true;
+			else if (atlas.entries[i].rect.w > 0 && atlas.entries[i].rect.h > 0) extrude_edges(page_surface, atlas.entries[i].rect, FFG_ATLAS_PADDING);
+		}
+		if (!failed) failed = upload_surface(atlas.pages[page], page_surface);
+		SDL_FreeSurface(page_surface);
+	}
+	for (SDL_Surface* surface : surfaces) {
+		if (surface) SDL_FreeSurface(surface);
+	}
+	if (failed) unload_atlas(atlas);
+	return failed;
 }
 
 /***************************************************************************//**
- * Sets Vsync to on or off. Should be set prior to running the engine,
- * otherwise this method is a no-op.
- * @param vsync TRUE if vsync should be enabled. Otherwise FALSE.
+ * Unloads the atlas.
+ * @param atlas The atlas to unload.
  ******************************************************************************/
-void FFG_Renderer::set_vsync(bool vsync) {
-	vsync_p = vsync;
+void FFG_Renderer::unload_atlas(FFG_TextureAtlas& atlas) {
+	for (FFG_Texture& page : atlas.pages) unload_texture(page);
+	atlas.pages.clear();
+	atlas.page_extents.clear();
 }
 
 /***************************************************************************//**
- * Gets the screen's width. O(1).
- * @return The screen's width.
+ * Returns the native pixel format: the format textures loaded from images,
+ * draw-toable textures and atlas pages are created in. Chosen when the
+ * renderer is initialized, from the formats it supports.
+ * @return The native pixel format.
  ******************************************************************************/
-int FFG_Renderer::screen_width() const {
-	return screen_width_p;
+Uint32 FFG_Renderer::native_format() const {
+	return texture_format;
 }
 
 /***************************************************************************//**
- * Gets the screen's height. O(1).
- * @return The screen's height.
+ * Sets a filter that every decoded image passes through before it is uploaded,
+ * including images loaded in bulk, streamed, or added to atlases. The filter is
+ * given the texture and its image, in the native pixel format, and may change
+ * the pixels, such as with FFG_PixelOps. It may be called from worker threads,
+ * for several textures at once.
+ * @param filter The filter, or nullptr for none.
  ******************************************************************************/
-int FFG_Renderer::screen_height() const {
-	return screen_height_p;
+void FFG_Renderer::set_load_filter(const std::function<void(FFG_Texture&, SDL_Surface*)>& filter) {
+	load_filter = filter;
+	stream.set_filter(filter);
 }
 
 /***************************************************************************//**
- * Indicates if a flag is set on the window.
- * @return If the flag is set on the window.
+ * Loads the map. No chunk textures are created until they are first needed.
+ * The map must remain valid until it is unloaded.
+ * @param map The map to load.
+ * @return False on success. Otherwise true.
  ******************************************************************************/
-bool FFG_Renderer::check_window_flag(FFG_WindowFlag window_flag) {
-	Uint32 check_flag = 0;
-	switch(window_flag) {
-		case FFG_WINFLAG_MINIMIZED:
-			check_flag = SDL_WINDOW_MINIMIZED;
-			break;
-		case FFG_WINFLAG_MAXIMIZED:
-			check_flag = SDL_WINDOW_MAXIMIZED;
-			break;
-		case FFG_WINFLAG_INPUT_FOCUS:
-			check_flag = SDL_WINDOW_INPUT_FOCUS;
-			break;
-		case FFG_WINFLAG_MOUSE_FOCUS:
-			check_flag = SDL_WINDOW_MOUSE_FOCUS;
-			break;
+bool FFG_Renderer::load_map(FFG_Map& map) {
+	if (!renderer) return true;
+	if (map.is_loaded()) return false;
+	map.slots.assign(map.max_baked_chunks, FFG_Texture(map.chunk_size_p * map.tile_width_p, map.chunk_size_p * map.tile_height_p));
+	map.slot_chunks.assign(map.max_baked_chunks, -1);
+	for (FFG_Map::FFG_MapChunk& chunk : map.chunks) {
+		chunk.slot = -1;
+		chunk.dirty = true;
 	}
-	return check_flag & SDL_GetWindowFlags(window);
+	maps.push_back(&map);
+	return false;
 }
 
 /***************************************************************************//**
- * Loads the texture.
- * @param texture The texture to load.
+ * Unloads the map, along with its chunk textures.
+ * @param map The map to unload.
+ ******************************************************************************/
+void FFG_Renderer::unload_map(FFG_Map& map) {
+	auto it = std::find(maps.begin(), maps.end(), &map);
+	if (it != maps.end()) maps.erase(it);
+	for (FFG_Texture& texture : map.slots) unload_texture(texture);
+	map.slots.clear();
+	map.slot_chunks.clear();
+	for (FFG_Map::FFG_MapChunk& chunk : map.chunks) {
+		chunk.slot = -1;
+		chunk.dirty = true;
+	}
+}
+
+/***************************************************************************//**
+ * Draws the part of the map within the camera to the current target, at its
+ * original scale. Only the chunks intersecting the camera are drawn, and each
+ * is baked first if it has not been or if its tiles changed.
+ * NOTE: This method is core loop critical.
+ * @param map The map to draw, whose tileset must be loaded.
+ * @param camera The area of the map to draw, in pixels.
+ * @param screen_x The x-coordinate on the current target to draw the camera's
+ * left at.
+ * @param screen_y The y-coordinate on the current target to draw the camera's
+ * top at.
  * @return False on success. Otherwise true.
  ******************************************************************************/
-bool FFG_Renderer::load_texture(FFG_Texture& texture) {
-	if (texture.texture) return false;
-	SDL_Surface* loaded_surface = nullptr;
-	SDL_RWops* rw = nullptr;
-	switch (texture.type) {
-		case FFG_TEXTURE_STR:
-		case FFG_TEXTURE_MEM:
-			// Load the unoptimized PNG from path/memory:
-			switch (texture.type) {
-				case FFG_TEXTURE_STR:
-					// From path:
-					loaded_surface = IMG_Load(texture.path.c_str());
-					break;
-				case FFG_TEXTURE_MEM:
-					// From memory:
-					rw = SDL_RWFromConstMem(texture.mem, texture.size_b);
-					if (!rw) return true;
-					loaded_surface = IMG_LoadPNG_RW(rw);
-					break;
+bool FFG_Renderer::draw_map(FFG_Map& map, const FFG_Rect& camera, int screen_x, int screen_y) {
+	if (!map.is_loaded() || !map.tileset || use_texture(*map.tileset)) return true;
+	const int chunk_width = map.chunk_size_p * map.tile_width_p;
+	const int chunk_height = map.chunk_size_p * map.tile_height_p;
+	const SDL_Rect bounds = { 0, 0, map.width_p * map.tile_width_p, map.height_p * map.tile_height_p };
+	SDL_Rect view;
+	if (!SDL_IntersectRect(&camera, &bounds, &view)) return false;
+	const int cx0 = view.x / chunk_width;
+	const int cy0 = view.y / chunk_height;
+	const int cx1 = (view.x + view.w - 1) / chunk_width;
+	const int cy1 = (view.y + view.h - 1) / chunk_height;
+	// Mark every visible chunk first, so that baking one never evicts another:
+	for (int cy = cy0; cy <= cy1; cy++) {
+		for (int cx = cx0; cx <= cx1; cx++) map.chunks[cy * map.chunks_x + cx].last_drawn = deferred_frame;
+	}
+	bool failed = false;
+	for (int cy = cy0; cy <= cy1; cy++) {
+		for (int cx = cx0; cx <= cx1; cx++) {
+			const int index = cy * map.chunks_x + cx;
+			FFG_Map::FFG_MapChunk& chunk = map.chunks[index];
+			if (chunk.slot < 0) acquire_map_slot(map, index);
+			if (chunk.slot < 0 || (chunk.dirty && bake_map_chunk(map, index))) {
+				if (draw_map_tiles(map, index, view, screen_x + view.x - camera.x, screen_y + view.y - camera.y)) failed = true;
+				continue;
 			}
-			// Create a texture from the surface:
-			if (!loaded_surface) return true;
-			texture.texture = SDL_CreateTextureFromSurface(renderer, loaded_surface);
-			SDL_FreeSurface(loaded_surface);
-			break;
-		case FFG_TEXTURE_DRAWTO:
-			// Create an empty draw-toable texture:
-			texture.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, texture.drawto_width, texture.drawto_height);
-			break;
+			const SDL_Rect area = { cx * chunk_width, cy * chunk_height, std::min(chunk_width, bounds.w - cx * chunk_width), std::min(chunk_height, bounds.h - cy * chunk_height) };
+			const SDL_Rect source = { 0, 0, area.w, area.h };
+			if (draw_clipped(map.slots[chunk.slot], source, area, view, screen_x + view.x - camera.x, screen_y + view.y - camera.y)) failed = true;
+		}
 	}
-	if (!texture.texture) return true;
-	if (SDL_QueryTexture(texture.texture, nullptr, nullptr, &texture.loaded_width, &texture.loaded_height)) return true;
-	return false;
+	return failed;
 }
 
 /***************************************************************************//**
- * Unloads the texture.
- * @param texture The texture to unload.
+ * Draws the cells of a hex map within the camera to the current target, at
+ * their original scale. The visible rows are found from the camera's top and
+ * bottom, and the visible columns of each row from the camera's left and right
+ * and the row's offset, so no cell outside the camera is visited. All cells
+ * are submitted as a single batch.
+ * NOTE: This method is core loop critical.
+ * @param map The map to draw, whose tileset must be loaded.
+ * @param camera The area of the map to draw, in pixels.
+ * @param screen_x The x-coordinate on the current target to draw the camera's
+ * left at.
+ * @param screen_y The y-coordinate on the current target to draw the camera's
+ * top at.
+ * @return False on success. Otherwise true.
  ******************************************************************************/
-void FFG_Renderer::unload_texture(FFG_Texture& texture) {
-	if (texture.texture) SDL_DestroyTexture(texture.texture);
-	texture.texture = nullptr;
+bool FFG_Renderer::draw_hex_map(FFG_MapHex& map, const FFG_Rect& camera, int screen_x, int screen_y) {
+	if (!map.tileset || use_texture(*map.tileset)) return true;
+	if (camera.w <= 0 || camera.h <= 0 || map.tiles.empty()) return false;
+	auto floor_div = [](int a, int b) { return (a >= 0) ? a / b : -((-a + b - 1) / b); };
+	const int w = map.hex_width_p;
+	const int h = map.hex_height_p;
+	const int columns = std::max(1, map.tileset->loaded_width / w);
+	// A row's sprites span [row * row_height, row * row_height + h):
+	const int row_first = std::max(0, floor_div(camera.y - h, map.row_height_p) + 1);
+	const int row_last = std::min(map.height_p - 1, floor_div(camera.y + camera.h - 1, map.row_height_p));
+	const bool was_batching = batching;
+	begin_batch();
+	bool failed = false;
+	for (int row = row_first; row <= row_last; row++) {
+		// A cell's sprite spans [column * w + offset, column * w + offset + w):
+		const int offset = (row & 1) * (w / 2);
+		const int column_first = std::max(0, floor_div(camera.x - offset - w, w) + 1);
+		const int column_last = std::min(map.width_p - 1, floor_div(camera.x + camera.w - offset - 1, w));
+		const int* cells = &map.tiles[row * map.width_p];
+		FFG_Rect destination = { 0, screen_y + row * map.row_height_p - camera.y, w, h };
+		for (int column = column_first; column <= column_last; column++) {
+			const int tile = cells[column];
+			if (tile < 0) continue;
+			FFG_Rect source = { (tile % columns) * w, (tile / columns) * h, w, h };
+			destination.x = screen_x + column * w + offset - camera.x;
+			if (draw(*map.tileset, source, destination)) failed = true;
+		}
+	}
+	if (!was_batching && end_batch()) failed = true;
+	return failed;
 }
 
 /***************************************************************************//**
@@ -230,7 +2209,21 @@ void FFG_Renderer::unload_texture(FFG_Texture& texture) {
  ******************************************************************************/
 bool FFG_Renderer::set_render_target(FFG_Texture& texture) {
 	if (!texture.texture) return true;
-	return SDL_SetRenderTarget(renderer, texture.texture);
+	if (deferred) {
+		if (texture.deferred_target_frame != deferred_frame) {
+			if (deferred_targets.size() >= FFG_RENDERER_DEFERRED_MAX_TARGETS) return true;
+			texture.deferred_target_frame = deferred_frame;
+			texture.deferred_target_slot = deferred_targets.size();
+			deferred_targets.push_back(&texture);
+		}
+		deferred_target = texture.deferred_target_slot;
+		current_target = &texture;
+		return false;
+	}
+	if (flush_batch()) return true;
+	if (apply_render_target(texture.texture)) return true;
+	current_target = &texture;
+	return false;
 }
 
 /***************************************************************************//**
@@ -239,7 +2232,24 @@ bool FFG_Renderer::set_render_target(FFG_Texture& texture) {
  ******************************************************************************/
 bool FFG_Renderer::reset_render_target() {
 	if (!renderer) return true;
-	return SDL_SetRenderTarget(renderer, nullptr);
+	if (deferred) {
+		deferred_target = FFG_RENDERER_DEFERRED_MAX_TARGETS;
+		current_target = nullptr;
+		return false;
+	}
+	if (flush_batch()) return true;
+	if (apply_render_target(screen_texture())) return true;
+	current_target = nullptr;
+	return false;
+}
+
+/***************************************************************************//**
+ * Returns the current render target, so that it can be set again after drawing
+ * to another.
+ * @return The current render target, or nullptr for the screen.
+ ******************************************************************************/
+FFG_Texture* FFG_Renderer::get_render_target() const {
+	return current_target;
 }
 
 /***************************************************************************//**
@@ -248,8 +2258,15 @@ bool FFG_Renderer::reset_render_target() {
  * @param texture The texture to draw from.
  * @return False on success. Otherwise true.
  ******************************************************************************/
-bool FFG_Renderer::draw(FFG_Texture& texture) const {
-	if (!texture.texture) return true;
+bool FFG_Renderer::draw(FFG_Texture& texture) {
+	if (use_texture(texture)) return draw_placeholder(texture, nullptr);
+	if (deferred || batching) {
+		SDL_Rect source = { 0, 0, texture.loaded_width, texture.loaded_height };
+		SDL_Rect destination = { 0, 0, 0, 0 };
+		if (target_size(&destination.w, &destination.h)) return true;
+		if (deferred) return record_sprite(texture, source, destination, { texture.mod_r, texture.mod_g, texture.mod_b, texture.mod_a });
+		return batch_quad(texture, source, destination, { texture.mod_r, texture.mod_g, texture.mod_b, texture.mod_a }, texture.blend_mode, texture.texture);
+	}
 	return SDL_RenderCopy(renderer, texture.texture, nullptr, nullptr);
 }
 
@@ -263,13 +2280,15 @@ bool FFG_Renderer::draw(FFG_Texture& texture) const {
  * @param screen_y The upper-left y coordinate to draw to on the current target.
  * @return False on success. Otherwise true.
  ******************************************************************************/
-bool FFG_Renderer::draw(FFG_Texture& texture, FFG_Rect& source, int screen_x, int screen_y) const {
-	if (!texture.texture) return true;
+bool FFG_Renderer::draw(FFG_Texture& texture, FFG_Rect& source, int screen_x, int screen_y) {
 	SDL_Rect destination;
 	destination.x = screen_x;
 	destination.y = screen_y;
 	destination.w = source.w;
 	destination.h = source.h;
+	if (use_texture(texture)) return draw_placeholder(texture, &destination);
+	if (deferred) return record_sprite(texture, source, destination, { texture.mod_r, texture.mod_g, texture.mod_b, texture.mod_a });
+	if (batching) return batch_quad(texture, source, destination, { texture.mod_r, texture.mod_g, texture.mod_b, texture.mod_a }, texture.blend_mode, texture.texture);
 	return SDL_RenderCopy(renderer, texture.texture, &source, &destination);
 }
 
@@ -282,11 +2301,357 @@ bool FFG_Renderer::draw(FFG_Texture& texture, FFG_Rect& source, int screen_x, in
  * @param destination The area on the destination target to draw to.
  * @return False on success. Otherwise true.
  ******************************************************************************/
-bool FFG_Renderer::draw(FFG_Texture& texture, FFG_Rect& source, FFG_Rect& destination) const {
-	if (!texture.texture) return true;
+bool FFG_Renderer::draw(FFG_Texture& texture, FFG_Rect& source, FFG_Rect& destination) {
+	if (use_texture(texture)) return draw_placeholder(texture, &destination);
+	if (deferred) return record_sprite(texture, source, destination, { texture.mod_r, texture.mod_g, texture.mod_b, texture.mod_a });
+	if (batching) return batch_quad(texture, source, destination, { texture.mod_r, texture.mod_g, texture.mod_b, texture.mod_a }, texture.blend_mode, texture.texture);
 	return SDL_RenderCopy(renderer, texture.texture, &source, &destination);
 }
 
+/***************************************************************************//**
+ * Draws quads already laid out as vertices, all from the same texture, in a
+ * single submission. Each quad is four vertices: top left, top right, bottom
+ * left, then bottom right, with texture coordinates from 0 to 1. The color of
+ * each quad's vertices is used in place of the texture's color modulation.
+ * While batching, the quads join the pending batch. While deferring, each quad
+ * is recorded as a separate draw, with the color of its first vertex. Nothing
+ * is drawn while the texture is still streaming.
+ * NOTE: This method is core loop critical.
+ * @param texture The texture to draw from.
+ * @param vertices The vertices of the quads.
+ * @param num_quads The number of quads.
+ * @return False on success, or if the texture is still streaming. Otherwise
+ * true.
+ ******************************************************************************/
+bool FFG_Renderer::draw_quads(FFG_Texture& texture, const SDL_Vertex* vertices, int num_quads) {
+	if (num_quads <= 0) return false;
+	if (use_texture(texture)) return !texture.stream_ticket;
+	SDL_Rect source;
+	SDL_Rect destination;
+	if (deferred) {
+		bool failed = false;
+		for (int i = 0; i < num_quads; i++) {
+			const SDL_Vertex* quad = vertices + i * 4;
+			quad_rects(texture, quad, source, destination);
+			if (record_sprite(texture, source, destination, quad[0].color)) failed = true;
+		}
+		return failed;
+	}
+	if (batch_texture != &texture || batch_buffer != texture.texture || batch_blend_mode != texture.blend_mode) {
+		if (flush_batch()) return true;
+		quad_rects(texture, vertices, source, destination);
+		batch_texture = &texture;
+		batch_buffer = texture.texture;
+		batch_blend_mode = texture.blend_mode;
+		batch_first_source = source;
+		batch_first_destination = destination;
+	}
+	batch_vertices.insert(batch_vertices.end(), vertices, vertices + num_quads * 4);
+	if (batching) return false;
+	return flush_batch();
+}
+
+/***************************************************************************//**
+ * Loads a cached layer's texture and adds the layer to be composited every
+ * frame. Should only be called after engine initialization. The layer must
+ * remain valid until it is removed.
+ * @param layer The layer.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::add_layer(FFG_CachedLayer& layer) {
+	if (std::find(layers.begin(), layers.end(), &layer) != layers.end()) return false;
+	if (load_texture(layer.texture)) return true;
+	if (layer.texture.set_blend_mode(FFG_BLEND_ALPHA)) {
+		unload_texture(layer.texture);
+		return true;
+	}
+	layer.area.w = layer.texture.loaded_width;
+	layer.area.h = layer.texture.loaded_height;
+	layer.dirty = true;
+	layers.push_back(&layer);
+	return false;
+}
+
+/***************************************************************************//**
+ * Removes a cached layer and unloads its texture.
+ * @param layer The layer.
+ ******************************************************************************/
+void FFG_Renderer::remove_layer(FFG_CachedLayer& layer) {
+	auto it = std::find(layers.begin(), layers.end(), &layer);
+	if (it == layers.end()) return;
+	layers.erase(it);
+	unload_texture(layer.texture);
+	add_damage(layer.area);
+}
+
+/***************************************************************************//**
+ * Loads a sprite compositor, creating its page with as many slots as fit, up
+ * to its capacity. Should only be called after engine initialization. The
+ * compositor must remain valid until it is unloaded.
+ * @param compositor The compositor.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::load_compositor(FFG_SpriteCompositor& compositor) {
+	if (compositor.is_loaded()) return false;
+	if (!renderer || compositor.sprite_width <= 0 || compositor.sprite_height <= 0) return true;
+	// Slots are laid out in a square, within the largest texture the renderer supports:
+	int max_width = INT_MAX;
+	int max_height = INT_MAX;
+	SDL_RendererInfo info;
+	if (SDL_GetRendererInfo(renderer, &info)) return true;
+	if (info.max_texture_width > 0) max_width = info.max_texture_width;
+	if (info.max_texture_height > 0) max_height = info.max_texture_height;
+	int columns = (int)std::ceil(std::sqrt((double)compositor.capacity_p));
+	if (columns > max_width / compositor.sprite_width) columns = max_width / compositor.sprite_width;
+	int rows = (compositor.capacity_p + columns - 1) / std::max(columns, 1);
+	if (rows > max_height / compositor.sprite_height) rows = max_height / compositor.sprite_height;
+	if (columns < 1 || rows < 1) return true;
+	if ((unsigned int)(columns * rows) < compositor.capacity_p) compositor.capacity_p = columns * rows;
+	compositor.columns = columns;
+	compositor.page.set(columns * compositor.sprite_width, rows * compositor.sprite_height);
+	if (load_texture(compositor.page) || compositor.page.set_blend_mode(FFG_BLEND_ALPHA)) {
+		unload_texture(compositor.page);
+		return true;
+	}
+	compositor.slots.assign(compositor.capacity_p, FFG_SpriteCompositor::FFG_CompositeSlot());
+	compositor.forget();
+	compositors.push_back(&compositor);
+	return false;
+}
+
+/***************************************************************************//**
+ * Unloads a sprite compositor, forgetting every baked sprite.
+ * @param compositor The compositor.
+ ******************************************************************************/
+void FFG_Renderer::unload_compositor(FFG_SpriteCompositor& compositor) {
+	auto it = std::find(compositors.begin(), compositors.end(), &compositor);
+	if (it != compositors.end()) compositors.erase(it);
+	unload_texture(compositor.page);
+	compositor.slots.clear();
+	compositor.forget();
+}
+
+/***************************************************************************//**
+ * Draws a sprite from a compositor, with the top left of the sprite at a
+ * location on the current target. The sprite is baked first if no sprite with
+ * the same tints is, and is then drawn from its slot as a single quad.
+ * NOTE: This method is core loop critical.
+ * @param compositor The compositor.
+ * @param tints The tint of each layer, in the order the layers were added.
+ * @param screen_x The upper-left x coordinate to draw to on the current target.
+ * @param screen_y The upper-left y coordinate to draw to on the current target.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::draw_composite(FFG_SpriteCompositor& compositor, const std::vector<SDL_Color>& tints, int screen_x, int screen_y) {
+	if (!compositor.is_loaded() || tints.size() != compositor.layers.size()) return true;
+	std::string& key = compositor.key_buffer;
+	key.assign((const char*)tints.data(), tints.size() * sizeof(SDL_Color));
+	unsigned int slot = 0;
+	auto found = compositor.lookup.find(key);
+	if (found != compositor.lookup.end()) {
+		slot = found->second;
+		compositor.hits_p++;
+	} else {
+		compositor.misses_p++;
+		// Take a free slot, or else the least recently drawn one:
+		for (unsigned int i = 0; i < compositor.slots.size(); i++) {
+			if (!compositor.slots[i].baked && compositor.slots[i].used_frame != deferred_frame) {
+				slot = i;
+				break;
+			}
+			if (compositor.slots[i].used_frame < compositor.slots[slot].used_frame) slot = i;
+		}
+		FFG_SpriteCompositor::FFG_CompositeSlot& chosen = compositor.slots[slot];
+		// Draws from the slot this frame may not have been submitted yet:
+		if (chosen.used_frame == deferred_frame) return draw_layers(compositor, tints, screen_x, screen_y);
+		if (chosen.baked) {
+			compositor.lookup.erase(chosen.key);
+			compositor.evictions_p++;
+		} else {
+			compositor.baked_p++;
+		}
+		chosen.key = key;
+		chosen.baked = true;
+		compositor.lookup[key] = slot;
+		if (bake_composite(compositor, slot, tints)) {
+			compositor.lookup.erase(key);
+			chosen.key.clear();
+			chosen.baked = false;
+			compositor.baked_p--;
+			return true;
+		}
+	}
+	compositor.slots[slot].used_frame = deferred_frame;
+	FFG_Rect source = compositor.slot_rect(slot);
+	return draw(compositor.page, source, screen_x, screen_y);
+}
+
+/***************************************************************************//**
+ * Enables or disables dirty rendering. Enabling it damages the whole screen.
+ * Should not be called while rendering.
+ * @param dirty_rendering True if dirty rendering should be enabled. Otherwise
+ * false.
+ ******************************************************************************/
+void FFG_Renderer::set_dirty_rendering(bool dirty_rendering) {
+	if (dirty_rendering == this->dirty_rendering) return;
+	this->dirty_rendering = dirty_rendering;
+	if (dirty_rendering) {
+		damage_all();
+	} else {
+		unload_texture(back_buffer);
+	}
+}
+
+/***************************************************************************//**
+ * Adds an area of the screen that changed and must be redrawn next frame. The
+ * damage of a frame is the bounding rectangle of all the areas added.
+ * NOTE: This method is core loop critical.
+ * @param rect The area of the screen.
+ ******************************************************************************/
+void FFG_Renderer::add_damage(const FFG_Rect& rect) {
+	if (rect.w <= 0 || rect.h <= 0) return;
+	if (damaged) {
+		SDL_UnionRect(&pending_damage, &rect, &pending_damage);
+	} else {
+		pending_damage = rect;
+		damaged = true;
+	}
+}
+
+/***************************************************************************//**
+ * Damages the whole screen, so that it is entirely redrawn next frame.
+ ******************************************************************************/
+void FFG_Renderer::damage_all() {
+	pending_damage = { 0, 0, INT_MAX / 2, INT_MAX / 2 };
+	damaged = true;
+}
+
+/***************************************************************************//**
+ * Indicates if an area of the screen is being redrawn this frame. Always true
+ * if dirty rendering is disabled. Should only be called while rendering.
+ * NOTE: This method is core loop critical.
+ * @param rect The area of the screen.
+ * @return True if any of the area is damaged, otherwise false.
+ ******************************************************************************/
+bool FFG_Renderer::is_damaged(const FFG_Rect& rect) const {
+	if (!dirty_frame) return !dirty_rendering;
+	return SDL_HasIntersection(&rect, &frame_damage);
+}
+
+/***************************************************************************//**
+ * Returns the number of calls to SDL that were skipped because they would not
+ * have changed the draw color, blend mode, render target, or a texture's color
+ * modulation, alpha modulation, or blend mode.
+ * @return The number of skipped calls.
+ ******************************************************************************/
+unsigned long FFG_Renderer::elided_calls() const {
+	return elided_calls_p + FFG_Texture::elided_calls;
+}
+
+/***************************************************************************//**
+ * Resets the number of skipped calls to zero.
+ ******************************************************************************/
+void FFG_Renderer::reset_elided_calls() {
+	elided_calls_p = 0;
+	FFG_Texture::elided_calls = 0;
+}
+
+/***************************************************************************//**
+ * Begins batching texture draws. Until FFG_Renderer::end_batch() is called,
+ * consecutive draws of the same texture are collected and submitted together.
+ * Does nothing if already batching.
+ ******************************************************************************/
+void FFG_Renderer::begin_batch() {
+	batching = true;
+}
+
+/***************************************************************************//**
+ * Ends batching texture draws, submitting any draws still pending.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::end_batch() {
+	batching = false;
+	return flush_batch();
+}
+
+/***************************************************************************//**
+ * Turns deferred rendering on or off. Turning it off replays any commands
+ * recorded so far. Drawing to the current render target continues either way.
+ * @param deferred TRUE if drawing should be deferred. Otherwise FALSE.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::set_deferred(bool deferred) {
+	if (!renderer) return true;
+	if (this->deferred == deferred) return false;
+	if (!deferred) {
+		bool failed = flush_deferred();
+		this->deferred = false;
+		return failed;
+	}
+	if (flush_batch()) return true;
+	this->deferred = true;
+	// Recording continues on the current target:
+	if (current_target) {
+		FFG_Texture& target = *current_target;
+		current_target = nullptr;
+		return set_render_target(target);
+	}
+	deferred_target = FFG_RENDERER_DEFERRED_MAX_TARGETS;
+	return false;
+}
+
+/***************************************************************************//**
+ * Sets the layer that subsequent deferred draws are recorded on. Lower layers
+ * are drawn first. Has no effect unless drawing is deferred. Cached layers are
+ * recorded on layers 0 and FFG_RENDERER_MAX_LAYER, so while any are in use a
+ * state should stay between them.
+ * @param layer The layer, from 0 to FFG_RENDERER_MAX_LAYER.
+ ******************************************************************************/
+void FFG_Renderer::set_layer(unsigned int layer) {
+	if (layer > FFG_RENDERER_MAX_LAYER) layer = FFG_RENDERER_MAX_LAYER;
+	deferred_layer = layer;
+}
+
+/***************************************************************************//**
+ * Sorts and replays the commands recorded since the last flush. Is called
+ * automatically when the frame is presented. Afterwards the current render
+ * target and draw color are as they would be had the commands not been
+ * deferred.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_Renderer::flush_deferred() {
+	if (!renderer) return true;
+	bool failed = false;
+	if (!deferred_keys.empty()) {
+		const bool was_deferred = deferred;
+		deferred = false;
+		sort_deferred();
+		failed = replay_deferred();
+		if (apply_render_target(current_target ? current_target->texture : screen_texture())) failed = true;
+		if (apply_draw_color(draw_color)) failed = true;
+		deferred = was_deferred;
+	}
+	for (SDL_Texture* buffer : retired_buffers) {
+		if (applied_target == buffer) applied_target = nullptr;
+		SDL_DestroyTexture(buffer);
+	}
+	retired_buffers.clear();
+	retired_textures.clear();
+	deferred_commands.clear();
+	deferred_keys.clear();
+	deferred_rects.clear();
+	deferred_targets.clear();
+	deferred_next_slot = 0;
+	deferred_frame++;
+	// Keep recording on the current target:
+	if (deferred && current_target) {
+		FFG_Texture& target = *current_target;
+		current_target = nullptr;
+		if (set_render_target(target)) failed = true;
+	}
+	return failed;
+}
+
 /***************************************************************************//**
  * Sets the draw color for clearing or drawing primitives.
  * @param r The red component of the color.
@@ -305,8 +2670,17 @@ bool FFG_Renderer::set_draw_color(int r, int g, int b, int a) {
 	if (g > 255) g = 255;
 	if (b > 255) b = 255;
 	if (a > 255) a = 255;
-	if (SDL_SetRenderDrawBlendMode(renderer, (a == 255) ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND)) return true;
-	return SDL_SetRenderDrawColor(renderer, r, g, b, a);
+	draw_color = { (Uint8)r, (Uint8)g, (Uint8)b, (Uint8)a };
+	if (deferred) return false;
+	return apply_draw_color(draw_color);
+}
+
+/***************************************************************************//**
+ * Returns the draw color for clearing or drawing primitives.
+ * @return The draw color.
+ ******************************************************************************/
+SDL_Color FFG_Renderer::get_draw_color() const {
+	return draw_color;
 }
 
 /***************************************************************************//**
@@ -317,6 +2691,11 @@ bool FFG_Renderer::set_draw_color(int r, int g, int b, int a) {
  ******************************************************************************/
 bool FFG_Renderer::draw_pixel(int x, int y) {
 	if (!renderer) return true;
+	if (flush_batch()) return true;
+	if (deferred) {
+		rect_buffer.push_back({ x, y, 1, 1 });
+		return flush_rects();
+	}
 	return SDL_RenderDrawPoint(renderer, x, y);
 }
 
@@ -329,6 +2708,11 @@ bool FFG_Renderer::draw_pixel(int x, int y) {
  ******************************************************************************/
 bool FFG_Renderer::draw_h_line(int y, int x1, int x2) {
 	if (!renderer) return true;
+	if (flush_batch()) return true;
+	if (deferred) {
+		push_h_line(y, std::min(x1, x2), std::max(x1, x2));
+		return flush_rects();
+	}
 	return SDL_RenderDrawLine(renderer, x1, y, x2, y);
 }
 
@@ -341,6 +2725,11 @@ bool FFG_Renderer::draw_h_line(int y, int x1, int x2) {
  ******************************************************************************/
 bool FFG_Renderer::draw_v_line(int x, int y1, int y2) {
 	if (!renderer) return true;
+	if (flush_batch()) return true;
+	if (deferred) {
+		rect_buffer.push_back({ x, std::min(y1, y2), 1, std::abs(y2 - y1) + 1 });
+		return flush_rects();
+	}
 	return SDL_RenderDrawLine(renderer, x, y1, x, y2);
 }
 
@@ -355,6 +2744,12 @@ bool FFG_Renderer::draw_v_line(int x, int y1, int y2) {
  ******************************************************************************/
 bool FFG_Renderer::draw_line(int x1, int y1, int x2, int y2) {
 	if (!renderer) return true;
+	if (flush_batch()) return true;
+	if (deferred) {
+		FFG_RenderCommand command(FFG_COMMAND_LINE, draw_color);
+		command.destination = { x1, y1, x2, y2 };
+		return record_command(command);
+	}
 	return SDL_RenderDrawLine(renderer, x1, y1, x2, y2);
 }
 
@@ -370,11 +2765,17 @@ bool FFG_Renderer::draw_line(int x1, int y1, int x2, int y2) {
  ******************************************************************************/
 bool FFG_Renderer::draw_rectangle(int x, int y, int w, int h, bool filled) {
 	if (!renderer) return true;
+	if (flush_batch()) return true;
 	SDL_Rect rect;
 	rect.x = x;
 	rect.y = y;
 	rect.w = w;
 	rect.h = h;
+	if (deferred) {
+		rect_buffer.push_back(rect);
+		if (filled) return flush_rects();
+		return record_rects(FFG_COMMAND_DRAW_RECTS);
+	}
 	if (filled) {
 		return SDL_RenderFillRect(renderer, &rect);
 	}
@@ -382,7 +2783,9 @@ bool FFG_Renderer::draw_rectangle(int x, int y, int w, int h, bool filled) {
 }
 
 /***************************************************************************//**
- * Draws a circle of the current draw color to the current target.
+ * Draws a circle of the current draw color to the current target. The circle is
+ * rasterized with the integer midpoint algorithm into horizontal spans, which
+ * are submitted with a single call.
  * @param x The x-coordinate of the circle center.
  * @param y The y-coordinate of the circle center.
  * @param r The radius of the circle.
@@ -391,40 +2794,18 @@ bool FFG_Renderer::draw_rectangle(int x, int y, int w, int h, bool filled) {
  ******************************************************************************/
 bool FFG_Renderer::draw_circle(int x, int y, int r, bool filled) {
 	if (!renderer) return true;
-	if (r == 0) return SDL_RenderDrawPoint(renderer, x, y);
+	if (flush_batch()) return true;
+	if (r == 0) return draw_pixel(x, y);
 	if (r < 0) r *= -1;
-	int r2 = r * r;
-	if (filled) {
-		if (SDL_RenderDrawLine(renderer, x, y + r, x, y - r)) return true;
-		for (int ix = 1; ix <= r; ix++) {
-			int iy = (int)sqrt(r2 - ix*ix);
-			if (SDL_RenderDrawLine(renderer, x + ix, y + iy, x + ix, y - iy)) return true;
-			if (SDL_RenderDrawLine(renderer, x - ix, y + iy, x - ix, y - iy)) return true;
-		}
-	} else {
-		if (SDL_RenderDrawPoint(renderer, x, y + r)) return true;
-		if (SDL_RenderDrawPoint(renderer, x, y - r)) return true;
-		if (SDL_RenderDrawPoint(renderer, x + r, y)) return true;
-		if (SDL_RenderDrawPoint(renderer, x - r, y)) return true;
-		int until = (int)((double)(r) / sqrt(2.0));
-		until = until + 1;
-		for (int ix = 1; ix < until; ix++) {
-			int iy = (int)sqrt(r2 - ix*ix);
-			if (SDL_RenderDrawPoint(renderer, x + ix, y + iy)) return true;
-			if (SDL_RenderDrawPoint(renderer, x + ix, y - iy)) return true;
-			if (SDL_RenderDrawPoint(renderer, x - ix, y + iy)) return true;
-			if (SDL_RenderDrawPoint(renderer, x - ix, y - iy)) return true;
-			if (SDL_RenderDrawPoint(renderer, x + iy, y + ix)) return true;
-			if (SDL_RenderDrawPoint(renderer, x + iy, y - ix)) return true;
-			if (SDL_RenderDrawPoint(renderer, x - iy, y + ix)) return true;
-			if (SDL_RenderDrawPoint(renderer, x - iy, y - ix)) return true;
-		}
-	}
-	return false;
+	circle_spans(r);
+	push_spans(x, y, filled);
+	return flush_rects();
 }
 
 /***************************************************************************//**
- * Draws an ellipse of the current draw color to the current target.
+ * Draws an ellipse of the current draw color to the current target. The
+ * ellipse is rasterized with the integer midpoint algorithm into horizontal
+ * spans, which are submitted with a single call.
  * @param x The x-coordinate of the ellipse center.
  * @param y The y-coordinate of the ellipse center.
  * @param rx The x radius of the ellipse.
@@ -434,43 +2815,15 @@ bool FFG_Renderer::draw_circle(int x, int y, int r, bool filled) {
  ******************************************************************************/
 bool FFG_Renderer::draw_ellipse(int x, int y, int rx, int ry, bool filled) {
 	if (!renderer) return true;
+	if (flush_batch()) return true;
 	if (rx < 0) rx *= -1;
 	if (ry < 0) ry *= -1;
 	if (rx == ry) return draw_circle(x, y, rx, filled);
-	if (rx == 0) return SDL_RenderDrawLine(renderer, x, y - ry, x, y + ry);
-	if (ry == 0) return SDL_RenderDrawLine(renderer, x - rx, y, x + rx, y);
-	int rx2 = rx*rx;
-	int ry2 = ry*ry;
-	if (filled) {
-		if (SDL_RenderDrawLine(renderer, x, y + ry, x, y - ry)) return true;
-		for (int ix = 1; ix <= rx; ix++) {
-			int iy = (int)((double)(ry)*sqrt(1.0 - ((double)(ix*ix) / (double)(rx2))));
-			if (SDL_RenderDrawLine(renderer, x + ix, y + iy, x + ix, y - iy)) return true;
-			if (SDL_RenderDrawLine(renderer, x - ix, y + iy, x - ix, y - iy)) return true;
-		}
-	} else {
-		if (SDL_RenderDrawPoint(renderer, x, y + ry)) return true;
-		if (SDL_RenderDrawPoint(renderer, x, y - ry)) return true;
-		int until = (int)((double)(rx2) / sqrt((double)(rx2 + ry2)));
-		until = until + 1;
-		for (int ix = 1; ix < until; ix++) {
-			int iy = (int)((double)(ry)*sqrt(1.0 - ((double)(ix*ix) / (double)(rx2))));
-			if (SDL_RenderDrawPoint(renderer, x + ix, y + iy)) return true;
-			if (SDL_RenderDrawPoint(renderer, x + ix, y - iy)) return true;
-			if (SDL_RenderDrawPoint(renderer, x - ix, y + iy)) return true;
-			if (SDL_RenderDrawPoint(renderer, x - ix, y - iy)) return true;
-		}
-		until = (int)((double)(ry2) / sqrt((double)(rx2 + ry2)));
-		until = until + 1;
-		for (int iy = 0; iy < until; iy++) {
-			int ix = (int)((double)(rx)*sqrt(1.0 - ((double)(iy*iy) / (double)(ry2))));
-			if (SDL_RenderDrawPoint(renderer, x + ix, y + iy)) return true;
-			if (SDL_RenderDrawPoint(renderer, x + ix, y - iy)) return true;
-			if (SDL_RenderDrawPoint(renderer, x - ix, y + iy)) return true;
-			if (SDL_RenderDrawPoint(renderer, x - ix, y - iy)) return true;
-		}
-	}
-	return false;
+	if (rx == 0) return draw_v_line(x, y - ry, y + ry);
+	if (ry == 0) return draw_h_line(y, x - rx, x + rx);
+	ellipse_spans(rx, ry);
+	push_spans(x, y, filled);
+	return flush_rects();
 }
 
 /***************************************************************************//**
@@ -479,5 +2832,10 @@ bool FFG_Renderer::draw_ellipse(int x, int y, int rx, int ry, bool filled) {
  ******************************************************************************/
 bool FFG_Renderer::render_clear() {
 	if (!renderer) return true;
-	return SDL_RenderClear(renderer);
+	if (flush_batch()) return true;
+	if (deferred) return record_command(FFG_RenderCommand(FFG_COMMAND_CLEAR, draw_color));
+	if (!dirty_frame) return SDL_RenderClear(renderer);
+	bool failed = clear_target();
+	if (apply_draw_color(draw_color)) failed = true;
+	return failed;
 }
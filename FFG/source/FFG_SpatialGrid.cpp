@@ -0,0 +1,118 @@
+#include "FFG_SpatialGrid.hpp"
+
+/***************************************************************************//**
+ * Private. Returns the bucket a cell hashes to.
+ * NOTE: This method is core loop critical.
+ * @param cell_x The x-coordinate of the cell.
+ * @param cell_y The y-coordinate of the cell.
+ * @return The bucket.
+ ******************************************************************************/
+std::vector<unsigned int>& FFG_SpatialGrid::bucket(int cell_x, int cell_y) {
+	const unsigned int hash = ((unsigned int)cell_x * 73856093u) ^ ((unsigned int)cell_y * 19349663u);
+	return buckets[hash % buckets.size()];
+}
+
+/***************************************************************************//**
+ * Private. Finds the range of cells a rectangle overlaps.
+ * @param rect The rectangle, which must not be empty.
+ * @param x0 Set to the x-coordinate of the first column of cells.
+ * @param y0 Set to the y-coordinate of the first row of cells.
+ * @param x1 Set to the x-coordinate of the last column of cells.
+ * @param y1 Set to the y-coordinate of the last row of cells.
+ * @return The number of cells in the range.
+ ******************************************************************************/
+long long FFG_SpatialGrid::cell_range(const FFG_Rect& rect, int* x0, int* y0, int* x1, int* y1) const {
+	*x0 = floor_div(rect.x, cell_size_p);
+	*y0 = floor_div(rect.y, cell_size_p);
+	*x1 = floor_div(rect.x + rect.w - 1, cell_size_p);
+	*y1 = floor_div(rect.y + rect.h - 1, cell_size_p);
+	return (long long)(*x1 - *x0 + 1) * (*y1 - *y0 + 1);
+}
+
+/***************************************************************************//**
+ * Protected. Lists an object in the cells its bounding rectangle overlaps.
+ * @param id The ID of the object.
+ ******************************************************************************/
+void FFG_SpatialGrid::add_entry(unsigned int id) {
+	FFG_SpatialEntry& entry = entries[id];
+	entry.node = -1;
+	if (entry.bounds.w <= 0 || entry.bounds.h <= 0) return;
+	int x0, y0, x1, y1;
+	if (cell_range(entry.bounds, &x0, &y0, &x1, &y1) > (long long)buckets.size()) {
+		entry.node = 1;
+		oversized.push_back(id);
+		return;
+	}
+	entry.node = 0;
+	for (int y = y0; y <= y1; y++) {
+		for (int x = x0; x <= x1; x++) bucket(x, y).push_back(id);
+	}
+}
+
+/***************************************************************************//**
+ * Protected. Removes an object from the cells it is listed in.
+ * @param id The ID of the object.
+ ******************************************************************************/
+void FFG_SpatialGrid::remove_entry(unsigned int id) {
+	FFG_SpatialEntry& entry = entries[id];
+	auto erase = [id](std::vector<unsigned int>& list) {
+		for (unsigned int i = 0; i < list.size(); i++) {
+			if (list[i] == id) {
+				list[i] = list.back();
+				list.pop_back();
+				return;
+			}
+		}
+	};
+	if (entry.node == 1) {
+		erase(oversized);
+	} else if (entry.node == 0) {
+		int x0, y0, x1, y1;
+		cell_range(entry.bounds, &x0, &y0, &x1, &y1);
+		for (int y = y0; y <= y1; y++) {
+			for (int x = x0; x <= x1; x++) erase(bucket(x, y));
+		}
+	}
+	entry.node = -1;
+}
+
+/***************************************************************************//**
+ * Protected. Tests every object listed in the cells an area overlaps. If the
+ * area overlaps more cells than there are buckets, every bucket is tested
+ * instead.
+ * NOTE: This method is core loop critical.
+ * @param area The area.
+ ******************************************************************************/
+void FFG_SpatialGrid::collect(const FFG_Rect& area) {
+	for (unsigned int id : oversized) test(id);
+	int x0, y0, x1, y1;
+	if (cell_range(area, &x0, &y0, &x1, &y1) > (long long)buckets.size()) {
+		for (const std::vector<unsigned int>& list : buckets) {
+			for (unsigned int id : list) test(id);
+		}
+		return;
+	}
+	for (int y = y0; y <= y1; y++) {
+		for (int x = x0; x <= x1; x++) {
+			for (unsigned int id : bucket(x, y)) test(id);
+		}
+	}
+}
+
+/***************************************************************************//**
+ * Constructor.
+ * @param cell_size The width and height of a cell.
+ * @param num_buckets The number of buckets cells are hashed into.
+ ******************************************************************************/
+FFG_SpatialGrid::FFG_SpatialGrid(const int cell_size, const unsigned int num_buckets) {
+	cell_size_p = (cell_size < 1) ? 1 : cell_size;
+	buckets.resize((num_buckets < 1) ? 1 : num_buckets);
+}
+
+/***************************************************************************//**
+ * Returns the width and height of a cell.
+ * @return The width and height of a cell.
+ ******************************************************************************/
+int FFG_SpatialGrid::cell_size() const {
+	return cell_size_p;
+}
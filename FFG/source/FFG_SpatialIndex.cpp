@@ -0,0 +1,236 @@
+#include "FFG_SpatialIndex.hpp"
+
+/***************************************************************************//**
+ * Constructor.
+ ******************************************************************************/
+FFG_SpatialIndex::FFG_SpatialEntry::FFG_SpatialEntry() {
+	bounds = { 0, 0, 0, 0 };
+	stamp = 0;
+	node = -1;
+	used = false;
+}
+
+/***************************************************************************//**
+ * Private. Runs a query whose type and shape are already set.
+ * NOTE: This method is core loop critical.
+ * @param area The area candidates must be found in.
+ * @param results The buffer to write the IDs found to.
+ * @param max_results The size of the buffer.
+ * @return The number of objects found, which may exceed the size of the buffer.
+ ******************************************************************************/
+unsigned int FFG_SpatialIndex::run_query(const FFG_Rect& area, unsigned int* results, unsigned int max_results) {
+	if (area.w <= 0 || area.h <= 0 || num_objects == 0) return 0;
+	query_area = area;
+	query_results = results;
+	query_max_results = results ? max_results : 0;
+	query_count = 0;
+	// A new stamp marks every object as not yet reported by this query:
+	if (++query_stamp == 0) {
+		for (FFG_SpatialEntry& entry : entries) entry.stamp = 0;
+		query_stamp = 1;
+	}
+	collect(area);
+	return query_count;
+}
+
+/***************************************************************************//**
+ * Protected. Constructor.
+ ******************************************************************************/
+FFG_SpatialIndex::FFG_SpatialIndex() {
+	num_objects = 0;
+	query_stamp = 0;
+	query_type = FFG_SPATIAL_QUERY_RECT;
+	query_area = { 0, 0, 0, 0 };
+	query_x = 0;
+	query_y = 0;
+	query_radius_sq = 0;
+	query_results = nullptr;
+	query_max_results = 0;
+	query_count = 0;
+}
+
+/***************************************************************************//**
+ * Protected. Called by implementations for each object that might match the
+ * current query. Reports the object if it matches and has not been reported
+ * yet.
+ * NOTE: This method is core loop critical.
+ * @param id The ID of the object.
+ ******************************************************************************/
+void FFG_SpatialIndex::test(unsigned int id) {
+	FFG_SpatialEntry& entry = entries[id];
+	if (entry.stamp == query_stamp) return;
+	entry.stamp = query_stamp;
+	const FFG_Rect& b = entry.bounds;
+	switch (query_type) {
+		case FFG_SPATIAL_QUERY_RECT:
+			if (b.x >= query_area.x + query_area.w || query_area.x >= b.x + b.w) return;
+			if (b.y >= query_area.y + query_area.h || query_area.y >= b.y + b.h) return;
+			break;
+		case FFG_SPATIAL_QUERY_POINT:
+			if (query_x < b.x || query_x >= b.x + b.w || query_y < b.y || query_y >= b.y + b.h) return;
+			break;
+		case FFG_SPATIAL_QUERY_RADIUS: {
+			// The distance from the center to the nearest point of the rectangle:
+			const long long dx = (query_x < b.x) ? b.x - query_x : (query_x > b.x + b.w - 1) ? query_x - (b.x + b.w - 1) : 0;
+			const long long dy = (query_y < b.y) ? b.y - query_y : (query_y > b.y + b.h - 1) ? query_y - (b.y + b.h - 1) : 0;
+			if (dx * dx + dy * dy > query_radius_sq) return;
+			break;
+		}
+	}
+	if (query_count < query_max_results) query_results[query_count] = id;
+	query_count++;
+}
+
+/***************************************************************************//**
+ * Protected. Divides, rounding toward negative infinity.
+ * @param a The dividend.
+ * @param b The divisor, which must be positive.
+ * @return The quotient.
+ ******************************************************************************/
+int FFG_SpatialIndex::floor_div(int a, int b) {
+	return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+/***************************************************************************//**
+ * Destructor.
+ ******************************************************************************/
+FFG_SpatialIndex::~FFG_SpatialIndex() {
+}
+
+/***************************************************************************//**
+ * Inserts an object. Objects with an empty rectangle are tracked but are never
+ * found by queries.
+ * @param bounds The bounding rectangle of the object.
+ * @return The ID of the object.
+ ******************************************************************************/
+unsigned int FFG_SpatialIndex::insert(const FFG_Rect& bounds) {
+	unsigned int id;
+	if (free_ids.empty()) {
+		id = entries.size();
+		entries.push_back(FFG_SpatialEntry());
+	} else {
+		id = free_ids.back();
+		free_ids.pop_back();
+	}
+	FFG_SpatialEntry& entry = entries[id];
+	entry.bounds = bounds;
+	entry.stamp = 0;
+	entry.used = true;
+	add_entry(id);
+	num_objects++;
+	return id;
+}
+
+/***************************************************************************//**
+ * Changes the bounding rectangle of an object.
+ * NOTE: This method is core loop critical.
+ * @param id The ID of the object.
+ * @param bounds The new bounding rectangle of the object.
+ * @return False on success. Otherwise true, if there is no such object.
+ ******************************************************************************/
+bool FFG_SpatialIndex::move(unsigned int id, const FFG_Rect& bounds) {
+	if (!contains(id)) return true;
+	remove_entry(id);
+	entries[id].bounds = bounds;
+	add_entry(id);
+	return false;
+}
+
+/***************************************************************************//**
+ * Removes an object. Its ID may be given to an object inserted later.
+ * @param id The ID of the object.
+ * @return False on success. Otherwise true, if there is no such object.
+ ******************************************************************************/
+bool FFG_SpatialIndex::remove(unsigned int id) {
+	if (!contains(id)) return true;
+	remove_entry(id);
+	entries[id].used = false;
+	free_ids.push_back(id);
+	num_objects--;
+	return false;
+}
+
+/***************************************************************************//**
+ * Removes every object.
+ ******************************************************************************/
+void FFG_SpatialIndex::clear() {
+	for (unsigned int id = 0; id < entries.size(); id++) remove(id);
+}
+
+/***************************************************************************//**
+ * Finds the objects whose bounding rectangles intersect an area.
+ * NOTE: This method is core loop critical.
+ * @param area The area.
+ * @param results The buffer to write the IDs found to.
+ * @param max_results The size of the buffer.
+ * @return The number of objects found. If this exceeds the size of the buffer,
+ * only the first max_results are written.
+ ******************************************************************************/
+unsigned int FFG_SpatialIndex::query_rect(const FFG_Rect& area, unsigned int* results, unsigned int max_results) {
+	query_type = FFG_SPATIAL_QUERY_RECT;
+	return run_query(area, results, max_results);
+}
+
+/***************************************************************************//**
+ * Finds the objects whose bounding rectangles contain a point, such as the
+ * position of a mouse event.
+ * NOTE: This method is core loop critical.
+ * @param x The x-coordinate of the point.
+ * @param y The y-coordinate of the point.
+ * @param results The buffer to write the IDs found to.
+ * @param max_results The size of the buffer.
+ * @return The number of objects found. If this exceeds the size of the buffer,
+ * only the first max_results are written.
+ ******************************************************************************/
+unsigned int FFG_SpatialIndex::query_point(int x, int y, unsigned int* results, unsigned int max_results) {
+	query_type = FFG_SPATIAL_QUERY_POINT;
+	query_x = x;
+	query_y = y;
+	return run_query({ x, y, 1, 1 }, results, max_results);
+}
+
+/***************************************************************************//**
+ * Finds the objects whose bounding rectangles are within a distance of a point.
+ * NOTE: This method is core loop critical.
+ * @param x The x-coordinate of the point.
+ * @param y The y-coordinate of the point.
+ * @param radius The distance.
+ * @param results The buffer to write the IDs found to.
+ * @param max_results The size of the buffer.
+ * @return The number of objects found. If this exceeds the size of the buffer,
+ * only the first max_results are written.
+ ******************************************************************************/
+unsigned int FFG_SpatialIndex::query_radius(int x, int y, int radius, unsigned int* results, unsigned int max_results) {
+	if (radius < 0) return 0;
+	query_type = FFG_SPATIAL_QUERY_RADIUS;
+	query_x = x;
+	query_y = y;
+	query_radius_sq = (long long)radius * radius;
+	return run_query({ x - radius, y - radius, 2 * radius + 1, 2 * radius + 1 }, results, max_results);
+}
+
+/***************************************************************************//**
+ * Returns the number of objects.
+ * @return The number of objects.
+ ******************************************************************************/
+unsigned int FFG_SpatialIndex::size() const {
+	return num_objects;
+}
+
+/***************************************************************************//**
+ * Indicates if an object exists.
+ * @param id The ID of the object.
+ * @return True if the object exists, otherwise false.
+ ******************************************************************************/
+bool FFG_SpatialIndex::contains(unsigned int id) const {
+	return id < entries.size() && entries[id].used;
+}
+
+/***************************************************************************//**
+ * Returns the bounding rectangle of an object. The object must exist.
+ * @param id The ID of the object.
+ * @return The bounding rectangle of the object.
+ ******************************************************************************/
+const FFG_Rect& FFG_SpatialIndex::get_bounds(unsigned int id) const {
+	return entries[id].bounds;
+}
@@ -0,0 +1,155 @@
+#include "FFG_SpriteCompositor.hpp"
+
+/***************************************************************************//**
+ * Constructor.
+ ******************************************************************************/
+FFG_SpriteCompositor::FFG_CompositeSlot::FFG_CompositeSlot() {
+	used_frame = 0;
+	baked = false;
+}
+
+/***************************************************************************//**
+ * Private. Forgets every baked sprite.
+ ******************************************************************************/
+void FFG_SpriteCompositor::forget() {
+	for (FFG_CompositeSlot& slot : slots) {
+		// The frame is kept, so slots drawn this frame are still not reused:
+		slot.key.clear();
+		slot.baked = false;
+	}
+	lookup.clear();
+	baked_p = 0;
+}
+
+/***************************************************************************//**
+ * Private. Returns the area of the page holding a slot.
+ * NOTE: This method is core loop critical.
+ * @param slot The index of the slot.
+ * @return The area.
+ ******************************************************************************/
+FFG_Rect FFG_SpriteCompositor::slot_rect(unsigned int slot) const {
+	return { (int)(slot % columns) * sprite_width, (int)(slot / columns) * sprite_height, sprite_width, sprite_height };
+}
+
+/***************************************************************************//**
+ * Constructor.
+ ******************************************************************************/
+FFG_SpriteCompositor::FFG_SpriteCompositor() {
+	sprite_width = 0;
+	sprite_height = 0;
+	capacity_p = FFG_COMPOSITOR_DEFAULT_CAPACITY;
+	columns = 1;
+	baked_p = 0;
+	hits_p = 0;
+	misses_p = 0;
+	evictions_p = 0;
+}
+
+/***************************************************************************//**
+ * Setting constructor. Refer to set.
+ * @param width The width of the sprites.
+ * @param height The height of the sprites.
+ * @param capacity The number of sprites that can be baked at once.
+ ******************************************************************************/
+FFG_SpriteCompositor::FFG_SpriteCompositor(const int width, const int height, const unsigned int capacity) : FFG_SpriteCompositor() {
+	set(width, height, capacity);
+}
+
+/***************************************************************************//**
+ * Sets the size of the sprites and the number of slots. Should only be called
+ * before the compositor is loaded. The slots may be fewer if the page would be
+ * larger than the renderer supports.
+ * @param width The width of the sprites.
+ * @param height The height of the sprites.
+ * @param capacity The number of sprites that can be baked at once.
+ ******************************************************************************/
+void FFG_SpriteCompositor::set(const int width, const int height, const unsigned int capacity) {
+	sprite_width = width;
+	sprite_height = height;
+	capacity_p = (capacity < 1) ? 1 : capacity;
+}
+
+/***************************************************************************//**
+ * Adds a layer, drawn above the layers added before it. Forgets every baked
+ * sprite.
+ * @param texture The texture of the layer.
+ ******************************************************************************/
+void FFG_SpriteCompositor::add_layer(FFG_Texture& texture) {
+	layers.push_back(&texture);
+	forget();
+}
+
+/***************************************************************************//**
+ * Removes every layer. Forgets every baked sprite.
+ ******************************************************************************/
+void FFG_SpriteCompositor::clear_layers() {
+	layers.clear();
+	forget();
+}
+
+/***************************************************************************//**
+ * Resets the hit, miss and eviction counts to 0.
+ ******************************************************************************/
+void FFG_SpriteCompositor::reset_counters() {
+	hits_p = 0;
+	misses_p = 0;
+	evictions_p = 0;
+}
+
+/***************************************************************************//**
+ * Indicates if the compositor is loaded.
+ * @return True if the compositor is loaded, otherwise false.
+ ******************************************************************************/
+bool FFG_SpriteCompositor::is_loaded() const {
+	return page.is_loaded();
+}
+
+/***************************************************************************//**
+ * Returns the number of layers.
+ * @return The number of layers.
+ ******************************************************************************/
+unsigned int FFG_SpriteCompositor::num_layers() const {
+	return layers.size();
+}
+
+/***************************************************************************//**
+ * Returns the number of sprites that can be baked at once. Once loaded, this is
+ * the number of slots the page holds.
+ * @return The number of slots.
+ ******************************************************************************/
+unsigned int FFG_SpriteCompositor::capacity() const {
+	return capacity_p;
+}
+
+/***************************************************************************//**
+ * Returns the number of slots holding a baked sprite.
+ * @return The number of baked sprites.
+ ******************************************************************************/
+unsigned int FFG_SpriteCompositor::baked() const {
+	return baked_p;
+}
+
+/***************************************************************************//**
+ * Returns the number of draws that found their sprite already baked.
+ * @return The number of hits.
+ ******************************************************************************/
+unsigned long FFG_SpriteCompositor::hits() const {
+	return hits_p;
+}
+
+/***************************************************************************//**
+ * Returns the number of draws that had to bake their sprite, or draw its
+ * layers directly.
+ * @return The number of misses.
+ ******************************************************************************/
+unsigned long FFG_SpriteCompositor::misses() const {
+	return misses_p;
+}
+
+/***************************************************************************//**
+ * Returns the number of baked sprites replaced by others.
+ * @return The number of evictions.
+ ******************************************************************************/
+unsigned long FFG_SpriteCompositor::evictions() const {
+	return evictions_p;
+}
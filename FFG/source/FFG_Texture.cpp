@@ -1,4 +1,30 @@
 #include "FFG_Texture.hpp"
+#include "FFG_RawImage.hpp"
+#include "FFG_Renderer.hpp"
+
+/***************************************************************************//**
+ * The number of calls to SDL skipped by all textures because they would not
+ * have changed anything. Reported by FFG_Renderer::elided_calls().
+ ******************************************************************************/
+unsigned long FFG_Texture::elided_calls = 0;
+
+/***************************************************************************//**
+ * Private. Converts a blend mode to SDL's.
+ * @param mode The blend mode.
+ * @return The SDL blend mode.
+ ******************************************************************************/
+SDL_BlendMode FFG_Texture::sdl_blend_mode(FFG_BlendMode mode) {
+	switch (mode) {
+		case FFG_BLEND_ALPHA:
+			return SDL_BLENDMODE_BLEND;
+		case FFG_BLEND_ADD:
+			return SDL_BLENDMODE_ADD;
+		case FFG_BLEND_MOD:
+			return SDL_BLENDMODE_MOD;
+		default:
+			return SDL_BLENDMODE_NONE;
+	}
+}
 
 /***************************************************************************//**
  * Constructor.
@@ -13,13 +39,38 @@ FFG_Texture::FFG_Texture() {
 	texture = nullptr;
 	loaded_width = -1;
 	loaded_height = -1;
+	format = SDL_PIXELFORMAT_UNKNOWN;
+	blend_mode = FFG_BLEND_NONE;
+	mod_r = 255;
+	mod_g = 255;
+	mod_b = 255;
+	mod_a = 255;
+	deferred_frame = 0;
+	deferred_slot = 0;
+	deferred_target_frame = 0;
+	deferred_target_slot = 0;
+	stream_ticket = 0;
+	used_frame = 0;
+	resident_bytes = 0;
+	resident_slot = -1;
+	pinned = false;
+	evicted = false;
+	cached = false;
+	cache_references = 0;
+	back_texture = nullptr;
+	lock_pitch = 0;
+	lock_rect = { 0, 0, 0, 0 };
+	locked = false;
+	back_damage = { 0, 0, 0, 0 };
+	swap_frame = 0;
+	owner = nullptr;
 }
 
 /***************************************************************************//**
  * Setting constructor. Refer to set.
  * @param path The path to the image in .png format.
  ******************************************************************************/
-FFG_Texture::FFG_Texture(const std::string& path) {
+FFG_Texture::FFG_Texture(const std::string& path) : FFG_Texture() {
 	set(path);
 }
 
@@ -28,7 +79,7 @@ FFG_Texture::FFG_Texture(const std::string& path) {
  * @param mem A pointer to the image data, encoded as a .png.
  * @param size_b The size of the data pointed to by mem.
  ******************************************************************************/
-FFG_Texture::FFG_Texture(void* const mem, const unsigned int size_b) {
+FFG_Texture::FFG_Texture(void* const mem, const unsigned int size_b) : FFG_Texture() {
 	set(mem, size_b);
 }
 
@@ -37,10 +88,132 @@ FFG_Texture::FFG_Texture(void* const mem, const unsigned int size_b) {
  * @param width The width of the texture.
  * @param height The height of the texture.
  ******************************************************************************/
-FFG_Texture::FFG_Texture(const int width, const int height) {
+FFG_Texture::FFG_Texture(const int width, const int height) : FFG_Texture() {
 	set(width, height);
 }
 
+/***************************************************************************//**
+ * Copy constructor. The copy loads what the other texture loads, and starts
+ * unloaded.
+ * @param other The texture to copy.
+ ******************************************************************************/
+FFG_Texture::FFG_Texture(const FFG_Texture& other) : FFG_Texture() {
+	copy_source(other);
+}
+
+/***************************************************************************//**
+ * Move constructor. Takes the other texture's loaded texture, if any, leaving
+ * the other texture unloaded.
+ * @param other The texture to move.
+ ******************************************************************************/
+FFG_Texture::FFG_Texture(FFG_Texture&& other) noexcept : FFG_Texture() {
+	take(other);
+}
+
+/***************************************************************************//**
+ * Copy assignment. Unloads the texture, then loads what the other texture
+ * loads from then on.
+ * @param other The texture to copy.
+ * @return This texture.
+ ******************************************************************************/
+FFG_Texture& FFG_Texture::operator=(const FFG_Texture& other) {
+	if (this == &other) return *this;
+	release();
+	copy_source(other);
+	return *this;
+}
+
+/***************************************************************************//**
+ * Move assignment. Unloads the texture, then takes the other texture's loaded
+ * texture, if any, leaving the other texture unloaded.
+ * @param other The texture to move.
+ * @return This texture.
+ ******************************************************************************/
+FFG_Texture& FFG_Texture::operator=(FFG_Texture&& other) noexcept {
+	if (this == &other) return *this;
+	release();
+	take(other);
+	return *this;
+}
+
+/***************************************************************************//**
+ * Destructor. Unloads the texture, so that the renderer does not keep using it.
+ ******************************************************************************/
+FFG_Texture::~FFG_Texture() {
+	release();
+}
+
+/***************************************************************************//**
+ * Private. Copies what another texture loads, and how.
+ * @param other The texture to copy.
+ ******************************************************************************/
+void FFG_Texture::copy_source(const FFG_Texture& other) {
+	type = other.type;
+	path = other.path;
+	mem = other.mem;
+	size_b = other.size_b;
+	drawto_width = other.drawto_width;
+	drawto_height = other.drawto_height;
+	pinned = other.pinned;
+}
+
+/***************************************************************************//**
+ * Private. Takes everything from another texture, which must not be this one,
+ * and leaves it unloaded. The renderer's record of the texture is moved along.
+ * A request to stream the other texture is cancelled, since the stream refers
+ * to the other texture.
+ * @param other The texture to take from.
+ ******************************************************************************/
+void FFG_Texture::take(FFG_Texture& other) {
+	if (other.stream_ticket && other.owner) other.owner->cancel_texture(other);
+	copy_source(other);
+	texture = other.texture;
+	loaded_width = other.loaded_width;
+	loaded_height = other.loaded_height;
+	format = other.format;
+	blend_mode = other.blend_mode;
+	mod_r = other.mod_r;
+	mod_g = other.mod_g;
+	mod_b = other.mod_b;
+	mod_a = other.mod_a;
+	deferred_frame = other.deferred_frame;
+	deferred_slot = other.deferred_slot;
+	deferred_target_frame = other.deferred_target_frame;
+	deferred_target_slot = other.deferred_target_slot;
+	stream_ticket = 0;
+	used_frame = other.used_frame;
+	resident_bytes = other.resident_bytes;
+	resident_slot = other.resident_slot;
+	evicted = other.evicted;
+	cached = other.cached;
+	cache_references = other.cache_references;
+	back_texture = other.back_texture;
+	lock_pixels.swap(other.lock_pixels);
+	lock_pitch = other.lock_pitch;
+	lock_rect = other.lock_rect;
+	locked = other.locked;
+	back_damage = other.back_damage;
+	swap_frame = other.swap_frame;
+	owner = other.owner;
+	if (resident_slot >= 0) owner->resident[resident_slot] = this;
+	other.texture = nullptr;
+	other.resident_bytes = 0;
+	other.resident_slot = -1;
+	other.evicted = false;
+	other.cached = false;
+	other.cache_references = 0;
+	other.back_texture = nullptr;
+	other.locked = false;
+}
+
+/***************************************************************************//**
+ * Private. Unloads the texture through the renderer it was loaded or requested
+ * with, if it is loaded or streaming.
+ ******************************************************************************/
+void FFG_Texture::release() {
+	if (owner && (resident_slot >= 0 || stream_ticket)) owner->unload_texture(*this);
+}
+
 /***************************************************************************//**
  * Sets the FFG_Texture to load an image from the path. Textures loaded this way
  * cannot be used as render targets.
@@ -53,12 +226,14 @@ void FFG_Texture::set(const std::string& path) {
 
 /***************************************************************************//**
  * Sets the FFG_Texture to load an image from a memory pointer. Textures loaded
- * this way cannot be used as render targets.
- * @param mem A pointer to the image data, encoded as a .png.
+ * this way cannot be used as render targets. Raw images built by the ffg_pack
+ * tool are recognized by their header, and are uploaded with no decoding. See
+ * FFG_RawImage.
+ * @param mem A pointer to the image data, encoded as a .png or a raw image.
  * @param size_b The size of the data pointed to by mem.
  ******************************************************************************/
 void FFG_Texture::set(void* const mem, const unsigned int size_b) {
-	type = FFG_TEXTURE_MEM;
+	type = FFG_RawImage::is_raw(mem, size_b) ? FFG_TEXTURE_RAW : FFG_TEXTURE_MEM;
 	this->mem = mem;
 	this->size_b = size_b;
 }
@@ -75,13 +250,35 @@ void FFG_Texture::set(const int width, const int height) {
 	drawto_height = height;
 }
 
+/***************************************************************************//**
+ * Sets the FFG_Texture to load an empty, transparent image of a specified size
+ * whose pixels are written from the CPU with FFG_Renderer::lock_texture() and
+ * FFG_Renderer::unlock_texture(). Textures loaded this way are double
+ * buffered, and cannot be used as render targets.
+ * @param width The width of the texture.
+ * @param height The height of the texture.
+ ******************************************************************************/
+void FFG_Texture::set_streaming(const int width, const int height) {
+	type = FFG_TEXTURE_STREAMING;
+	drawto_width = width;
+	drawto_height = height;
+}
+
 /***************************************************************************//**
  * Indicates if the texture is loaded.
  * @return True if the texture is loaded, otherwise false.
  ******************************************************************************/
 bool FFG_Texture::is_loaded() const {
-	if (!texture) return true;
-	return false;
+	return texture != nullptr;
+}
+
+/***************************************************************************//**
+ * Indicates if the texture has been requested with
+ * FFG_Renderer::request_texture() and is not yet loaded.
+ * @return True if the texture is streaming, otherwise false.
+ ******************************************************************************/
+bool FFG_Texture::is_streaming() const {
+	return stream_ticket != 0;
 }
 
 /***************************************************************************//**
@@ -104,18 +301,97 @@ int FFG_Texture::get_height() const {
 	return loaded_height;
 }
 
+/***************************************************************************//**
+ * Returns the pixel format of the texture. Textures loaded from images and
+ * draw-toable textures are in the renderer's native pixel format. Should only
+ * be called after the texture is loaded.
+ * @return The pixel format of the texture, or SDL_PIXELFORMAT_UNKNOWN if it is
+ * not loaded.
+ ******************************************************************************/
+Uint32 FFG_Texture::get_format() const {
+	if (!texture) return SDL_PIXELFORMAT_UNKNOWN;
+	return format;
+}
+
 /***************************************************************************//**
  * Sets the texture modulation when drawing. Should only be called after the
- * texture is loaded.
- * @return The height of the texture.
+ * texture is loaded. If the texture was evicted by FFG_Renderer, the modulation
+ * is kept and applied when it is loaded again.
+ * @param r The red modulation, from 0 to 255.
+ * @param g The green modulation, from 0 to 255.
+ * @param b The blue modulation, from 0 to 255.
+ * @return False on success, otherwise true.
  ******************************************************************************/
 bool FFG_Texture::set_mod_color(int r, int g, int b) {
-	if (!texture) return true;
+	if (!texture && !evicted) return true;
 	if (r < 0) r = 0;
 	if (g < 0) g = 0;
 	if (b < 0) b = 0;
 	if (r > 255) r = 255;
 	if (g > 255) g = 255;
 	if (b > 255) b = 255;
-	return SDL_SetTextureColorMod(texture, r, g, b);
+	if (r == mod_r && g == mod_g && b == mod_b) {
+		elided_calls++;
+		return false;
+	}
+	if (texture && SDL_SetTextureColorMod(texture, r, g, b)) return true;
+	mod_r = r;
+	mod_g = g;
+	mod_b = b;
+	return false;
+}
+
+/***************************************************************************//**
+ * Sets the texture alpha modulation when drawing. Should only be called after
+ * the texture is loaded. If the texture was evicted by FFG_Renderer, the
+ * modulation is kept and applied when it is loaded again.
+ * @param a The alpha modulation, from 0 to 255.
+ * @return False on success, otherwise true.
+ ******************************************************************************/
+bool FFG_Texture::set_mod_alpha(int a) {
+	if (!texture && !evicted) return true;
+	if (a < 0) a = 0;
+	if (a > 255) a = 255;
+	if (a == mod_a) {
+		elided_calls++;
+		return false;
+	}
+	if (texture && SDL_SetTextureAlphaMod(texture, a)) return true;
+	mod_a = a;
+	return false;
+}
+
+/***************************************************************************//**
+ * Sets how the texture is blended onto the current target when drawing. Should
+ * only be called after the texture is loaded. If the texture was evicted by
+ * FFG_Renderer, the blend mode is kept and applied when it is loaded again.
+ * @param mode The blend mode.
+ * @return False on success, otherwise true.
+ ******************************************************************************/
+bool FFG_Texture::set_blend_mode(FFG_BlendMode mode) {
+	if (!texture && !evicted) return true;
+	if (mode == blend_mode) {
+		elided_calls++;
+		return false;
+	}
+	if (texture && SDL_SetTextureBlendMode(texture, sdl_blend_mode(mode))) return true;
+	blend_mode = mode;
+	return false;
+}
+
+/***************************************************************************//**
+ * Sets whether the texture is pinned. Pinned textures are never evicted by
+ * FFG_Renderer to stay within its texture budget.
+ * @param pinned True to pin the texture, false to unpin it.
+ ******************************************************************************/
+void FFG_Texture::set_pinned(bool pinned) {
+	this->pinned = pinned;
+}
+
+/***************************************************************************//**
+ * Indicates if the texture is pinned.
+ * @return True if the texture is pinned, otherwise false.
+ ******************************************************************************/
+bool FFG_Texture::is_pinned() const {
+	return pinned;
 }
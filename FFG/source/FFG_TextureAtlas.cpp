@@ -0,0 +1,162 @@
+#include <algorithm>
+#include "FFG_TextureAtlas.hpp"
+
+/***************************************************************************//**
+ * Constructor.
+ * @param page The page the shelf is on.
+ * @param y The y-coordinate of the top of the shelf.
+ * @param height The height of the shelf.
+ ******************************************************************************/
+FFG_TextureAtlas::FFG_AtlasShelf::FFG_AtlasShelf(int page, int y, int height) {
+	this->page = page;
+	this->y = y;
+	this->height = height;
+	x = 0;
+}
+
+/***************************************************************************//**
+ * Constructor.
+ ******************************************************************************/
+FFG_TextureAtlas::FFG_AtlasEntry::FFG_AtlasEntry() {
+	page = -1;
+	rect.x = 0;
+	rect.y = 0;
+	rect.w = 0;
+	rect.h = 0;
+}
+
+/***************************************************************************//**
+ * Private. Packs the entries onto pages. The width and height of every entry
+ * must already be set. Entries are placed tallest first onto the first shelf
+ * with room for them, opening a new shelf or a new page as needed. Each entry
+ * is bordered by padding on every side, which is left out where the entry meets
+ * the edge of a page, so an entry as large as a page still fits. Each page's
+ * extent is shrunk to the area actually used, padding included.
+ * @param max_page_size The largest width and height of a page.
+ * @return False on success. Otherwise true, if an image is larger than a page.
+ ******************************************************************************/
+bool FFG_TextureAtlas::pack(int max_page_size) {
+	const int padding = FFG_ATLAS_PADDING;
+	std::vector<unsigned int> order(entries.size());
+	for (unsigned int i = 0; i < order.size(); i++) order[i] = i;
+	std::sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b) {
+		if (entries[a].rect.h != entries[b].rect.h) return entries[a].rect.h > entries[b].rect.h;
+		return entries[a].rect.w > entries[b].rect.w;
+	});
+	std::vector<FFG_AtlasShelf> shelves;
+	std::vector<int> page_bottoms;
+	page_extents.clear();
+	for (unsigned int index : order) {
+		FFG_AtlasEntry& entry = entries[index];
+		const int w = entry.rect.w;
+		const int h = entry.rect.h;
+		if (w > max_page_size || h > max_page_size) return true;
+		// Find the first shelf with room:
+		FFG_AtlasShelf* shelf = nullptr;
+		for (FFG_AtlasShelf& candidate : shelves) {
+			if (h <= candidate.height && (candidate.x ? candidate.x + padding : 0) + w <= max_page_size) {
+				shelf = &candidate;
+				break;
+			}
+		}
+		// Otherwise open a new shelf, on a new page if none has room:
+		if (!shelf) {
+			int page = 0;
+			while (page < (int)page_bottoms.size() && page_bottoms[page] + padding + h > max_page_size) page++;
+			if (page == (int)page_bottoms.size()) {
+				page_bottoms.push_back(0);
+				page_extents.push_back({ 0, 0, 0, 0 });
+			}
+			const int y = page_bottoms[page] ? page_bottoms[page] + padding : 0;
+			shelves.push_back(FFG_AtlasShelf(page, y, h));
+			page_bottoms[page] = y + h + padding;
+			shelf = &shelves.back();
+		}
+		entry.page = shelf->page;
+		entry.rect.x = shelf->x ? shelf->x + padding : 0;
+		entry.rect.y = shelf->y;
+		shelf->x = entry.rect.x + w + padding;
+		FFG_Rect& extent = page_extents[shelf->page];
+		extent.w = std::max(extent.w, std::min(shelf->x, max_page_size));
+		extent.h = std::max(extent.h, std::min(shelf->y + h + padding, max_page_size));
+	}
+	return false;
+}
+
+/***************************************************************************//**
+ * Constructor.
+ * @param page_size The largest width and height of a page.
+ ******************************************************************************/
+FFG_TextureAtlas::FFG_TextureAtlas(const int page_size) {
+	this->page_size = (page_size < 1) ? 1 : page_size;
+}
+
+/***************************************************************************//**
+ * Adds an image from a path to the atlas. Should only be called before the
+ * atlas is loaded.
+ * @param path The path to the image in .png format.
+ * @return The ID of the image.
+ ******************************************************************************/
+unsigned int FFG_TextureAtlas::add(const std::string& path) {
+	entries.push_back(FFG_AtlasEntry());
+	entries.back().source.set(path);
+	return entries.size() - 1;
+}
+
+/***************************************************************************//**
+ * Adds an image from a memory pointer to the atlas. Should only be called
+ * before the atlas is loaded. The memory must remain valid until the atlas is
+ * loaded.
+ * @param mem A pointer to the image data, encoded as a .png.
+ * @param size_b The size of the data pointed to by mem.
+ * @return The ID of the image.
+ ******************************************************************************/
+unsigned int FFG_TextureAtlas::add(void* const mem, const unsigned int size_b) {
+	entries.push_back(FFG_AtlasEntry());
+	entries.back().source.set(mem, size_b);
+	return entries.size() - 1;
+}
+
+/***************************************************************************//**
+ * Indicates if the atlas is loaded.
+ * @return True if the atlas is loaded, otherwise false.
+ ******************************************************************************/
+bool FFG_TextureAtlas::is_loaded() const {
+	return !pages.empty();
+}
+
+/***************************************************************************//**
+ * Returns the number of images added to the atlas.
+ * @return The number of images.
+ ******************************************************************************/
+unsigned int FFG_TextureAtlas::size() const {
+	return entries.size();
+}
+
+/***************************************************************************//**
+ * Returns the number of pages. Should only be called after the atlas is loaded.
+ * @return The number of pages.
+ ******************************************************************************/
+unsigned int FFG_TextureAtlas::num_pages() const {
+	return pages.size();
+}
+
+/***************************************************************************//**
+ * Returns the page holding an image. Should only be called after the atlas is
+ * loaded.
+ * @param id The ID of the image.
+ * @return The page holding the image.
+ ******************************************************************************/
+FFG_Texture& FFG_TextureAtlas::get_texture(unsigned int id) {
+	return pages[entries[id].page];
+}
+
+/***************************************************************************//**
+ * Returns the area of its page holding an image. Should only be called after
+ * the atlas is loaded.
+ * @param id The ID of the image.
+ * @return The area of the page holding the image.
+ ******************************************************************************/
+FFG_Rect& FFG_TextureAtlas::get_source(unsigned int id) {
+	return entries[id].rect;
+}
@@ -0,0 +1,212 @@
+#include "FFG_TextureStream.hpp"
+#include "FFG_Renderer.hpp"
+
+/***************************************************************************//**
+ * Constructor.
+ ******************************************************************************/
+FFG_TextureStream::FFG_StreamRequest::FFG_StreamRequest() {
+	texture = nullptr;
+	ticket = 0;
+	priority = 0;
+	surface = nullptr;
+}
+
+/***************************************************************************//**
+ * Private. Finds the request to handle first: the one with the highest
+ * priority, and of those, the one made first.
+ * @param requests The requests, which must not be empty.
+ * @return The index of the request.
+ ******************************************************************************/
+unsigned int FFG_TextureStream::first(const std::vector<FFG_StreamRequest>& requests) {
+	unsigned int best = 0;
+	for (unsigned int i = 1; i < requests.size(); i++) {
+		const FFG_StreamRequest& a = requests[i];
+		const FFG_StreamRequest& b = requests[best];
+		if (a.priority > b.priority || (a.priority == b.priority && a.ticket < b.ticket)) best = i;
+	}
+	return best;
+}
+
+/***************************************************************************//**
+ * Private. Body of the worker thread. Decodes pending requests until stopped.
+ ******************************************************************************/
+void FFG_TextureStream::decode_requests() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		condition.wait(lock, [this]() { return !pending.empty() || !running; });
+		if (!running) break;
+		const unsigned int index = first(pending);
+		FFG_StreamRequest request = pending[index];
+		pending[index] = pending.back();
+		pending.pop_back();
+		decoding = request.texture;
+		decoding_cancelled = false;
+		const std::function<void(FFG_Texture&, SDL_Surface*)> decode_filter = filter;
+		// Decode without holding the lock, so the main thread is never blocked on it:
+		lock.unlock();
+		request.surface = FFG_Renderer::prepare_surface(*request.texture, format, decode_filter);
+		lock.lock();
+		if (decoding_cancelled) {
+			if (request.surface) SDL_FreeSurface(request.surface);
+		} else {
+			ready.push_back(request);
+		}
+		decoding = nullptr;
+		condition.notify_all();
+	}
+}
+
+/***************************************************************************//**
+ * Private. Queues a texture to be decoded, or changes the priority of a texture
+ * already queued. Called from the main thread only.
+ * @param texture The texture.
+ * @param priority The priority. Higher priorities are handled first.
+ ******************************************************************************/
+void FFG_TextureStream::request(FFG_Texture& texture, int priority) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (texture.stream_ticket) {
+			for (FFG_StreamRequest& queued : pending) {
+				if (queued.texture == &texture) queued.priority = priority;
+			}
+			for (FFG_StreamRequest& queued : ready) {
+				if (queued.texture == &texture) queued.priority = priority;
+			}
+			return;
+		}
+		FFG_StreamRequest queued;
+		queued.texture = &texture;
+		queued.ticket = ++next_ticket;
+		queued.priority = priority;
+		pending.push_back(queued);
+		texture.stream_ticket = queued.ticket;
+	}
+	condition.notify_all();
+}
+
+/***************************************************************************//**
+ * Private. Forgets a texture's request. If the texture is being decoded, waits
+ * for decoding to finish, so the texture is no longer used by the worker thread
+ * when this returns. Called from the main thread only.
+ * @param texture The texture.
+ ******************************************************************************/
+void FFG_TextureStream::cancel(FFG_Texture& texture) {
+	if (!texture.stream_ticket) return;
+	texture.stream_ticket = 0;
+	std::unique_lock<std::mutex> lock(mutex);
+	for (unsigned int i = 0; i < pending.size(); i++) {
+		if (pending[i].texture == &texture) {
+			pending[i] = pending.back();
+			pending.pop_back();
+			return;
+		}
+	}
+	for (unsigned int i = 0; i < ready.size(); i++) {
+		if (ready[i].texture == &texture) {
+			if (ready[i].surface) SDL_FreeSurface(ready[i].surface);
+			ready[i] = ready.back();
+			ready.pop_back();
+			return;
+		}
+	}
+	if (decoding == &texture) {
+		decoding_cancelled = true;
+		condition.wait(lock, [this, &texture]() { return decoding != &texture; });
+	}
+}
+
+/***************************************************************************//**
+ * Private. Takes the decoded request to upload first. The texture is no longer
+ * streaming once taken. Called from the main thread only.
+ * NOTE: This method is core loop critical.
+ * @param request Set to the request taken. Its surface must be freed.
+ * @return True if a request was taken, otherwise false.
+ ******************************************************************************/
+bool FFG_TextureStream::take_ready(FFG_StreamRequest& request) {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (ready.empty()) return false;
+	const unsigned int index = first(ready);
+	request = ready[index];
+	ready[index] = ready.back();
+	ready.pop_back();
+	request.texture->stream_ticket = 0;
+	return true;
+}
+
+/***************************************************************************//**
+ * Private. Sets the filter decoded images pass through. Images already decoded
+ * are not filtered again. Called from the main thread only.
+ * @param filter The filter, or nullptr for none.
+ ******************************************************************************/
+void FFG_TextureStream::set_filter(const std::function<void(FFG_Texture&, SDL_Surface*)>& filter) {
+	std::lock_guard<std::mutex> lock(mutex);
+	this->filter = filter;
+}
+
+/***************************************************************************//**
+ * Constructor.
+ ******************************************************************************/
+FFG_TextureStream::FFG_TextureStream() {
+	format = SDL_PIXELFORMAT_ARGB8888;
+	decoding = nullptr;
+	decoding_cancelled = false;
+	running = false;
+	next_ticket = 0;
+}
+
+/***************************************************************************//**
+ * Destructor. Stops streaming.
+ ******************************************************************************/
+FFG_TextureStream::~FFG_TextureStream() {
+	stop();
+}
+
+/***************************************************************************//**
+ * Starts the worker thread.
+ * @param format The pixel format images are converted to.
+ * @return False on success. Otherwise true, if already streaming.
+ ******************************************************************************/
+bool FFG_TextureStream::start(Uint32 format) {
+	if (is_running()) return true;
+	this->format = format;
+	running = true;
+	worker = std::thread(&FFG_TextureStream::decode_requests, this);
+	return false;
+}
+
+/***************************************************************************//**
+ * Stops the worker thread, waiting for the image being decoded, if any. Every
+ * request still queued or waiting to be uploaded is forgotten.
+ ******************************************************************************/
+void FFG_TextureStream::stop() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		running = false;
+	}
+	condition.notify_all();
+	if (worker.joinable()) worker.join();
+	for (FFG_StreamRequest& queued : pending) queued.texture->stream_ticket = 0;
+	for (FFG_StreamRequest& queued : ready) {
+		queued.texture->stream_ticket = 0;
+		if (queued.surface) SDL_FreeSurface(queued.surface);
+	}
+	pending.clear();
+	ready.clear();
+}
+
+/***************************************************************************//**
+ * Indicates if streaming.
+ * @return True if streaming, otherwise false.
+ ******************************************************************************/
+bool FFG_TextureStream::is_running() const {
+	return worker.joinable();
+}
+
+/***************************************************************************//**
+ * Returns the number of textures requested and not yet uploaded.
+ * @return The number of textures.
+ ******************************************************************************/
+unsigned int FFG_TextureStream::size() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return pending.size() + ready.size() + ((decoding && !decoding_cancelled) ? 1 : 0);
+}
@@ -1,4 +1,215 @@
 #ifndef FFG_EXT_UI_H_INCLUDED
 #define FFG_EXT_UI_H_INCLUDED
 
+#include <cstddef>
+#include <list>
+#include <SDL2/SDL.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "FFG_Pack.hpp"
+#include "FFG_Rect.hpp"
+#include "FFG_Renderer.hpp"
+#include "FFG_Texture.hpp"
+
+#define FFG_UI_NUM_GLYPHS 256
+#define FFG_UI_GRID_FIRST_GLYPH 32
+#define FFG_UI_GRID_NUM_GLYPHS 95
+#define FFG_UI_NUMBER_BUFFER_SIZE 32
+#define FFG_UI_DEFAULT_CACHE_CAPACITY 4194304
+
+class FFG_TextRenderer;
+
+/***************************************************************************//**
+ * A bitmap font. The glyphs of the font are all on a single image, which is
+ * loaded as one texture, the glyph atlas. Strings are drawn byte by byte, so
+ * only the first 256 characters are supported.
+ *
+ * A font is set from either:
+ *
+ *   - FFG_Font::set_grid(), an image of equally sized cells, one glyph per cell
+ *     in character order, left to right and then top to bottom.
+ *   - FFG_Font::load_bmfont(), a font description in the text format of the
+ *     AngelCode BMFont tool, with a single page. Kerning pairs are applied.
+ *
+ * The advance of a glyph in a grid font is the width of its cell, and may be
+ * changed using FFG_Font::set_advance().
+ *
+ * The font is loaded and drawn with FFG_TextRenderer. Strings are measured
+ * using FFG_Font::measure(), which needs no loading.
+ *
+ * Example usage:
+ * -----------------------------------------------------------------------------
+ * TODO: Add example usage.
+ * -----------------------------------------------------------------------------
+ ******************************************************************************/
+class FFG_Font {
+private:
+    friend class FFG_TextRenderer;
+private:
+    class FFG_Glyph {
+    public:
+        FFG_Glyph();
+    public:
+        FFG_Rect source;
+        int x_offset;
+        int y_offset;
+        int advance;
+        float u1;
+        float v1;
+        float u2;
+        float v2;
+        bool present;
+    };
+private:
+    FFG_Texture page;
+    std::vector<FFG_Glyph> glyphs;
+    std::unordered_map<Uint16, int> kernings;   // Keyed by the first character in the high byte.
+    int line_height_p;
+    int size_p;
+private:
+    static int read_field(const std::string& line, const std::string& key, int default_value);
+    static std::string read_text_field(const std::string& line, const std::string& key);
+    void clear();
+    int kerning(unsigned char first, unsigned char second) const;
+public:
+    // CONSTRUCTION:
+    FFG_Font();
+    // SETTERS:
+    bool set_grid(const std::string& path, const int cell_width, const int cell_height, const int columns, const int first = FFG_UI_GRID_FIRST_GLYPH, const int count = FFG_UI_GRID_NUM_GLYPHS);
+    bool load_bmfont(const std::string& path);
+    void set_advance(const unsigned char c, const int advance);
+    // INFO:
+    bool is_loaded() const;
+    bool has_glyph(const unsigned char c) const;
+    int line_height() const;
+    int size() const;
+    FFG_Texture& get_texture();
+    void measure(const std::string& text, int* width, int* height, const float scale = 1.0f) const;
+};
+
+/***************************************************************************//**
+ * Draws text with bitmap fonts. Each string is laid out as one quad per glyph
+ * into a buffer that is reused from draw to draw, and the quads are submitted
+ * together through FFG_Renderer::draw_quads(), rather than one copy per glyph.
+ *
+ * Load and unload fonts using:
+ *
+ *   - FFG_TextRenderer::load_font()
+ *   - FFG_TextRenderer::unload_font()
+ *
+ * Draw text using:
+ *
+ *   - FFG_TextRenderer::draw_text()
+ *   - FFG_TextRenderer::draw_number()
+ *
+ * Many strings, such as a whole frame's worth, are submitted as one piece of
+ * geometry by wrapping their draws in:
+ *
+ *   - FFG_TextRenderer::begin_text()
+ *   - FFG_TextRenderer::end_text()
+ *
+ * Until then, glyphs collect in the buffer. Drawing with a different font
+ * submits what was collected so far. Nothing else may be drawn between the two
+ * calls, as it would be drawn beneath the collected text.
+ *
+ * Strings that rarely change, such as labels, are drawn from a cache using:
+ *
+ *   - FFG_TextRenderer::draw_label()
+ *
+ * The first draw of a string lays it out once, keyed by the font, the font's
+ * size, the scale and a hash of the string, and later draws reuse the layout.
+ * If pre-rendering is on, the layout is also drawn once into a draw-toable
+ * texture, so later draws are a single copy. Pre-rendered labels are tinted
+ * through the texture's color modulation. Set how the cache behaves using:
+ *
+ *   - FFG_TextRenderer::set_cache_capacity()
+ *   - FFG_TextRenderer::set_cache_prerender()
+ *   - FFG_TextRenderer::clear_cache()
+ *
+ * When the cache holds more than its capacity in bytes, the least recently
+ * drawn strings are evicted. Strings larger than the capacity are drawn without
+ * caching. Query how well the cache is reused using:
+ *
+ *   - FFG_TextRenderer::cache_hits()
+ *   - FFG_TextRenderer::cache_misses()
+ *   - FFG_TextRenderer::cache_evictions()
+ *   - FFG_TextRenderer::cache_size()
+ *   - FFG_TextRenderer::cache_entries()
+ *
+ * Pre-rendered labels are lost when the render targets are reset, so clear the
+ * cache on FFG_EVENT_WINDOW_RENDER_RESET, and before the engine exits.
+ *
+ * Example usage:
+ * -----------------------------------------------------------------------------
+ * TODO: Add example usage.
+ * -----------------------------------------------------------------------------
+ ******************************************************************************/
+class FFG_TextRenderer {
+private:
+    class FFG_CachedString {
+    public:
+        FFG_CachedString();
+    public:
+        FFG_Font* font;
+        int size;
+        float scale;
+        std::string text;
+        std::vector<SDL_Vertex> vertices;   // Laid out with the top left of the string at the origin.
+        FFG_Texture texture;                // The pre-rendered string, if any.
+        int offset_x;                       // Where the texture is drawn, relative to the string.
+        int offset_y;
+        std::size_t bytes;
+        std::list<Uint64>::iterator recency_position;   // Where the key is in the recency list.
+    };
+private:
+    FFG_Renderer& renderer;
+    std::vector<SDL_Vertex> vertices;
+    FFG_Font* pending_font;
+    bool collecting;
+    char number_buffer[FFG_UI_NUMBER_BUFFER_SIZE];
+    // STRING CACHE:
+    std::unordered_map<Uint64, FFG_CachedString> cache;
+    std::list<Uint64> recency;                  // Keys, most recently drawn first.
+    std::vector<Uint64> eviction_candidates;
+    std::size_t cache_capacity_p;
+    std::size_t cache_size_p;
+    bool cache_prerender;
+    unsigned long cache_hits_p;
+    unsigned long cache_misses_p;
+    unsigned long cache_evictions_p;
+private:
+    static void layout(FFG_Font& font, const char* text, int length, int x, int y, const SDL_Color& color, float scale, std::vector<SDL_Vertex>& out);
+    bool submit();
+    bool add_text(FFG_Font& font, const char* text, int length, int x, int y, const SDL_Color& color, float scale);
+    static Uint64 cache_key(const FFG_Font& font, const std::string& text, float scale);
+    void remove_entry(Uint64 key);
+    void make_room(std::size_t bytes);
+    bool prerender(FFG_CachedString& entry);
+    FFG_CachedString* find_label(FFG_Font& font, const std::string& text, float scale);
+public:
+    // CONSTRUCTION:
+    FFG_TextRenderer(FFG_Renderer& renderer);
+    // FONTS:
+    bool load_font(FFG_Font& font);
+    void unload_font(FFG_Font& font);
+    // DRAWING:
+    bool draw_text(FFG_Font& font, const std::string& text, int x, int y, const SDL_Color& color, const float scale = 1.0f);
+    bool draw_number(FFG_Font& font, long value, int x, int y, const SDL_Color& color, const float scale = 1.0f);
+    bool draw_label(FFG_Font& font, const std::string& text, int x, int y, const SDL_Color& color, const float scale = 1.0f);
+    // BATCHING:
+    void begin_text();
+    bool end_text();
+    // STRING CACHE:
+    void set_cache_capacity(const std::size_t bytes);
+    void set_cache_prerender(const bool prerender);
+    void clear_cache();
+    void reset_cache_counters();
+    unsigned long cache_hits() const;
+    unsigned long cache_misses() const;
+    unsigned long cache_evictions() const;
+    std::size_t cache_size() const;
+    unsigned int cache_entries() const;
+};
+
 #endif // FFG_EXT_UI_H_INCLUDED
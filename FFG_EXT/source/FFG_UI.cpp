@@ -1 +1,717 @@
 #include "FFG_UI.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+/***************************************************************************//**
+ * Constructor.
+ ******************************************************************************/
+FFG_Font::FFG_Glyph::FFG_Glyph() {
+    source = { 0, 0, 0, 0 };
+    x_offset = 0;
+    y_offset = 0;
+    advance = 0;
+    u1 = 0.0f;
+    v1 = 0.0f;
+    u2 = 0.0f;
+    v2 = 0.0f;
+    present = false;
+}
+
+/***************************************************************************//**
+ * Private. Reads a numeric field, written as key=value, from a line of a
+ * BMFont description.
+ * @param line The line.
+ * @param key The name of the field.
+ * @param default_value The value to return if the line has no such field.
+ * @return The value of the field if found, otherwise default_value.
+ ******************************************************************************/
+int FFG_Font::read_field(const std::string& line, const std::string& key, int default_value) {
+    const std::string pattern = " " + key + "=";
+    const std::size_t at = line.find(pattern);
+    if (at == std::string::npos) return default_value;
+    return std::atoi(line.c_str() + at + pattern.size());
+}
+
+/***************************************************************************//**
+ * Private. Reads a text field, written as key="value", from a line of a BMFont
+ * description.
+ * @param line The line.
+ * @param key The name of the field.
+ * @return The value of the field, or an empty string if there is no such field.
+ ******************************************************************************/
+std::string FFG_Font::read_text_field(const std::string& line, const std::string& key) {
+    const std::string pattern = " " + key + "=\"";
+    const std::size_t at = line.find(pattern);
+    if (at == std::string::npos) return "";
+    const std::size_t start = at + pattern.size();
+    const std::size_t end = line.find('"', start);
+    if (end == std::string::npos) return "";
+    return line.substr(start, end - start);
+}
+
+/***************************************************************************//**
+ * Private. Forgets every glyph and kerning pair.
+ ******************************************************************************/
+void FFG_Font::clear() {
+    glyphs.assign(FFG_UI_NUM_GLYPHS, FFG_Glyph());
+    kernings.clear();
+    line_height_p = 0;
+    size_p = 0;
+}
+
+/***************************************************************************//**
+ * Private. Returns the kerning between two characters.
+ * NOTE: This method is core loop critical.
+ * @param first The character on the left.
+ * @param second The character on the right.
+ * @return The amount to move the second character right by, usually negative.
+ ******************************************************************************/
+int FFG_Font::kerning(unsigned char first, unsigned char second) const {
+    if (kernings.empty()) return 0;
+    auto found = kernings.find((Uint16)((first << 8) | second));
+    return (found == kernings.end()) ? 0 : found->second;
+}
+
+/***************************************************************************//**
+ * Constructor.
+ ******************************************************************************/
+FFG_Font::FFG_Font() {
+    clear();
+}
+
+/***************************************************************************//**
+ * Sets the font to an image of equally sized cells, one glyph per cell in
+ * character order, left to right and then top to bottom. Should only be called
+ * before the font is loaded.
+ * @param path The path to the image.
+ * @param cell_width The width of each cell.
+ * @param cell_height The height of each cell, which is also the line height.
+ * @param columns The number of cells in each row of the image.
+ * @param first The character of the first cell.
+ * @param count The number of cells.
+ * @return False on success. Otherwise true, if the layout is invalid.
+ ******************************************************************************/
+bool FFG_Font::set_grid(const std::string& path, const int cell_width, const int cell_height, const int columns, const int first, const int count) {
+    if (cell_width <= 0 || cell_height <= 0 || columns <= 0 || first < 0 || count < 0 || first + count > FFG_UI_NUM_GLYPHS) return true;
+    clear();
+    page.set(path);
+    for (int i = 0; i < count; i++) {
+        FFG_Glyph& glyph = glyphs[first + i];
+        glyph.source = { (i % columns) * cell_width, (i / columns) * cell_height, cell_width, cell_height };
+        glyph.advance = cell_width;
+        glyph.present = true;
+    }
+    line_height_p = cell_height;
+    size_p = cell_height;
+    return false;
+}
+
+/***************************************************************************//**
+ * Sets the font from a description in the text format of the AngelCode BMFont
+ * tool. The description's single page is set as the glyph atlas, found relative
+ * to the description. Characters beyond the first 256, and on other pages, are
+ * skipped. Should only be called before the font is loaded.
+ * @param path The path to the .fnt description.
+ * @return False on success. Otherwise true, if the description could not be
+ * read or has no page.
+ ******************************************************************************/
+bool FFG_Font::load_bmfont(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) return true;
+    clear();
+    const std::size_t slash = path.find_last_of("/\\");
+    const std::string directory = (slash == std::string::npos) ? "" : path.substr(0, slash + 1);
+    std::string page_file;
+    std::string line;
+    while (std::getline(file, line)) {
+        // Keys are found by the space before them, so the tag is followed by one:
+        const std::size_t tag_end = line.find(' ');
+        if (tag_end == std::string::npos) continue;
+        const std::string tag = line.substr(0, tag_end);
+        if (tag == "info") {
+            size_p = std::abs(read_field(line, "size", 0));
+        } else if (tag == "common") {
+            line_height_p = read_field(line, "lineHeight", 0);
+        } else if (tag == "page") {
+            if (read_field(line, "id", -1) == 0) page_file = read_text_field(line, "file");
+        } else if (tag == "char") {
+            const int id = read_field(line, "id", -1);
+            if (id < 0 || id >= FFG_UI_NUM_GLYPHS || read_field(line, "page", 0) != 0) continue;
+            FFG_Glyph& glyph = glyphs[id];
+            glyph.source = { read_field(line, "x", 0), read_field(line, "y", 0), read_field(line, "width", 0), read_field(line, "height", 0) };
+            glyph.x_offset = read_field(line, "xoffset", 0);
+            glyph.y_offset = read_field(line, "yoffset", 0);
+            glyph.advance = read_field(line, "xadvance", 0);
+            glyph.present = true;
+        } else if (tag == "kerning") {
+            const int first = read_field(line, "first", -1);
+            const int second = read_field(line, "second", -1);
+            if (first < 0 || first >= FFG_UI_NUM_GLYPHS || second < 0 || second >= FFG_UI_NUM_GLYPHS) continue;
+            kernings[(Uint16)((first << 8) | second)] = read_field(line, "amount", 0);
+        }
+    }
+    if (page_file.empty()) return true;
+    page.set(directory + page_file);
+    return false;
+}
+
+/***************************************************************************//**
+ * Sets how far the pen moves right after drawing a character.
+ * @param c The character.
+ * @param advance The distance in pixels.
+ ******************************************************************************/
+void FFG_Font::set_advance(const unsigned char c, const int advance) {
+    glyphs[c].advance = advance;
+}
+
+/***************************************************************************//**
+ * Indicates if the font's glyph atlas is loaded.
+ * @return True if the font is loaded, otherwise false.
+ ******************************************************************************/
+bool FFG_Font::is_loaded() const {
+    return page.is_loaded();
+}
+
+/***************************************************************************//**
+ * Indicates if the font has a glyph for a character.
+ * @param c The character.
+ * @return True if the font has the glyph, otherwise false.
+ ******************************************************************************/
+bool FFG_Font::has_glyph(const unsigned char c) const {
+    return glyphs[c].present;
+}
+
+/***************************************************************************//**
+ * Returns the distance between the tops of consecutive lines.
+ * @return The line height in pixels.
+ ******************************************************************************/
+int FFG_Font::line_height() const {
+    return line_height_p;
+}
+
+/***************************************************************************//**
+ * Returns the size the font was made at.
+ * @return The size in pixels.
+ ******************************************************************************/
+int FFG_Font::size() const {
+    return size_p;
+}
+
+/***************************************************************************//**
+ * Returns the font's glyph atlas.
+ * @return The texture holding the glyphs.
+ ******************************************************************************/
+FFG_Texture& FFG_Font::get_texture() {
+    return page;
+}
+
+/***************************************************************************//**
+ * Measures a string as it would be drawn. Lines are separated by '\n'.
+ * NOTE: This method is core loop critical.
+ * @param text The string.
+ * @param width Set to the width of the widest line.
+ * @param height Set to the height of all the lines.
+ * @param scale The scale the string would be drawn at.
+ ******************************************************************************/
+void FFG_Font::measure(const std::string& text, int* width, int* height, const float scale) const {
+    int widest = 0;
+    int line_width = 0;
+    int lines = 1;
+    int previous = -1;
+    for (unsigned char c : text) {
+        if (c == '\n') {
+            if (line_width > widest) widest = line_width;
+            line_width = 0;
+            lines++;
+            previous = -1;
+            continue;
+        }
+        const FFG_Glyph& glyph = glyphs[c];
+        if (!glyph.present) continue;
+        if (previous >= 0) line_width += kerning(previous, c);
+        line_width += glyph.advance;
+        previous = c;
+    }
+    if (line_width > widest) widest = line_width;
+    if (width) *width = (int)std::ceil(widest * scale);
+    if (height) *height = (int)std::ceil(lines * line_height_p * scale);
+}
+
+/***************************************************************************//**
+ * Private. Lays out a string as one quad per glyph, appending them to a vertex
+ * buffer. Characters the font has no glyph for are skipped. The font
+ * must be loaded.
+ * NOTE: This method is core loop critical.
+ * @param font The font.
+ * @param text The string.
+ * @param length The length of the string.
+ * @param x The upper-left x coordinate of the string on the current target.
+ * @param y The upper-left y coordinate of the string on the current target.
+ * @param color The color of the glyphs.
+ * @param scale The scale of the glyphs.
+ * @param out The buffer to append the vertices to.
+ ******************************************************************************/
+void FFG_TextRenderer::layout(FFG_Font& font, const char* text, int length, int x, int y, const SDL_Color& color, float scale, std::vector<SDL_Vertex>& out) {
+    float pen_x = (float)x;
+    float pen_y = (float)y;
+    int previous = -1;
+    for (int i = 0; i < length; i++) {
+        const unsigned char c = text[i];
+        if (c == '\n') {
+            pen_x = (float)x;
+            pen_y += font.line_height_p * scale;
+            previous = -1;
+            continue;
+        }
+        const FFG_Font::FFG_Glyph& glyph = font.glyphs[c];
+        if (!glyph.present) continue;
+        if (previous >= 0) pen_x += font.kerning(previous, c) * scale;
+        previous = c;
+        if (glyph.source.w > 0 && glyph.source.h > 0) {
+            // Whole pixels keep the glyphs sharp:
+            const float x1 = std::floor(pen_x + glyph.x_offset * scale + 0.5f);
+            const float y1 = std::floor(pen_y + glyph.y_offset * scale + 0.5f);
+            const float x2 = x1 + std::floor(glyph.source.w * scale + 0.5f);
+            const float y2 = y1 + std::floor(glyph.source.h * scale + 0.5f);
+            out.push_back({ { x1, y1 }, color, { glyph.u1, glyph.v1 } });
+            out.push_back({ { x2, y1 }, color, { glyph.u2, glyph.v1 } });
+            out.push_back({ { x1, y2 }, color, { glyph.u1, glyph.v2 } });
+            out.push_back({ { x2, y2 }, color, { glyph.u2, glyph.v2 } });
+        }
+        pen_x += glyph.advance * scale;
+    }
+}
+
+/***************************************************************************//**
+ * Private. Submits the glyphs in the vertex buffer, if any, then empties it.
+ * NOTE: This method is core loop critical.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_TextRenderer::submit() {
+    bool failed = false;
+    if (pending_font && !vertices.empty()) failed = renderer.draw_quads(pending_font->page, vertices.data(), vertices.size() / 4);
+    vertices.clear();
+    pending_font = nullptr;
+    return failed;
+}
+
+/***************************************************************************//**
+ * Private. Draws a string, or collects it while between
+ * FFG_TextRenderer::begin_text() and FFG_TextRenderer::end_text().
+ * NOTE: This method is core loop critical.
+ * @param font The font.
+ * @param text The string.
+ * @param length The length of the string.
+ * @param x The upper-left x coordinate of the string on the current target.
+ * @param y The upper-left y coordinate of the string on the current target.
+ * @param color The color of the glyphs.
+ * @param scale The scale of the glyphs.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_TextRenderer::add_text(FFG_Font& font, const char* text, int length, int x, int y, const SDL_Color& color, float scale) {
+    if (!font.is_loaded()) return true;
+    bool failed = false;
+    if (pending_font != &font && submit()) failed = true;
+    pending_font = &font;
+    layout(font, text, length, x, y, color, scale, vertices);
+    if (!collecting && submit()) failed = true;
+    return failed;
+}
+
+/***************************************************************************//**
+ * Private. Hashes what identifies a cached string: the font, the font's size,
+ * the scale, and the string itself.
+ * NOTE: This method is core loop critical.
+ * @param font The font.
+ * @param text The string.
+ * @param scale The scale.
+ * @return The key of the string in the cache.
+ ******************************************************************************/
+Uint64 FFG_TextRenderer::cache_key(const FFG_Font& font, const std::string& text, float scale) {
+    Uint32 scale_bits;
+    std::memcpy(&scale_bits, &scale, sizeof(scale_bits));
+    const Uint64 parts[3] = { (Uint64)(std::uintptr_t)&font, (Uint64)font.size_p, scale_bits };
+    Uint64 key = FFG_Pack::hash(text);
+    for (Uint64 part : parts) key ^= part + 0x9E3779B97F4A7C15ULL + (key << 6) + (key >> 2);
+    return key;
+}
+
+/***************************************************************************//**
+ * Private. Removes a string from the cache, unloading its texture if it was
+ * pre-rendered.
+ * @param key The key of the string.
+ ******************************************************************************/
+void FFG_TextRenderer::remove_entry(Uint64 key) {
+    auto found = cache.find(key);
+    if (found == cache.end()) return;
+    FFG_CachedString& entry = found->second;
+    if (entry.texture.is_loaded()) renderer.unload_texture(entry.texture);
+    cache_size_p -= entry.bytes;
+    recency.erase(entry.recency_position);
+    cache.erase(found);
+}
+
+/***************************************************************************//**
+ * Private. Evicts the least recently drawn strings, from the back of the
+ * recency list, until a number of bytes more fit within the cache's capacity.
+ * NOTE: This method is core loop critical.
+ * @param bytes The number of bytes to make room for.
+ ******************************************************************************/
+void FFG_TextRenderer::make_room(std::size_t bytes) {
+    while (cache_size_p + bytes > cache_capacity_p && !recency.empty()) {
+        remove_entry(recency.back());
+        cache_evictions_p++;
+    }
+}
+
+/***************************************************************************//**
+ * Private. Draws a cached string's layout into a new draw-toable texture. The
+ * current render target and draw color are kept.
+ * @param entry The cached string, whose vertices are moved so that the string's
+ * top left is at the texture's.
+ * @return False on success. Otherwise true, leaving the layout as it was.
+ ******************************************************************************/
+bool FFG_TextRenderer::prerender(FFG_CachedString& entry) {
+    // Glyphs may reach above or left of the pen, so the texture covers all of them:
+    float left = 0.0f;
+    float top = 0.0f;
+    float right = 0.0f;
+    float bottom = 0.0f;
+    for (const SDL_Vertex& vertex : entry.vertices) {
+        left = std::min(left, vertex.position.x);
+        top = std::min(top, vertex.position.y);
+        right = std::max(right, vertex.position.x);
+        bottom = std::max(bottom, vertex.position.y);
+    }
+    const int width = (int)(right - left);
+    const int height = (int)(bottom - top);
+    if (width <= 0 || height <= 0) return true;
+    entry.texture.set(width, height);
+    if (renderer.load_texture(entry.texture) || entry.texture.set_blend_mode(FFG_BLEND_ALPHA)) {
+        renderer.unload_texture(entry.texture);
+        return true;
+    }
+    // Glyphs still collected would otherwise be drawn onto the texture:
+    bool failed = submit();
+    for (SDL_Vertex& vertex : entry.vertices) {
+        vertex.position.x -= left;
+        vertex.position.y -= top;
+    }
+    FFG_Texture* previous_target = renderer.get_render_target();
+    const SDL_Color previous_color = renderer.get_draw_color();
+    if (renderer.set_render_target(entry.texture) || renderer.set_draw_color(0, 0, 0, 0) || renderer.render_clear()) failed = true;
+    else if (renderer.draw_quads(entry.font->page, entry.vertices.data(), entry.vertices.size() / 4)) failed = true;
+    if (previous_target) {
+        if (renderer.set_render_target(*previous_target)) failed = true;
+    } else {
+        if (renderer.reset_render_target()) failed = true;
+    }
+    if (renderer.set_draw_color(previous_color.r, previous_color.g, previous_color.b, previous_color.a)) failed = true;
+    if (failed) {
+        for (SDL_Vertex& vertex : entry.vertices) {
+            vertex.position.x += left;
+            vertex.position.y += top;
+        }
+        renderer.unload_texture(entry.texture);
+        return true;
+    }
+    entry.offset_x = (int)left;
+    entry.offset_y = (int)top;
+    return false;
+}
+
+/***************************************************************************//**
+ * Private. Finds a string in the cache, adding it if it is not there. Another
+ * string with the same key is replaced.
+ * NOTE: This method is core loop critical.
+ * @param font The font, which must be loaded.
+ * @param text The string.
+ * @param scale The scale of the glyphs.
+ * @return The cached string, or nullptr if the string is too large to cache.
+ ******************************************************************************/
+FFG_TextRenderer::FFG_CachedString* FFG_TextRenderer::find_label(FFG_Font& font, const std::string& text, float scale) {
+    const Uint64 key = cache_key(font, text, scale);
+    auto found = cache.find(key);
+    if (found != cache.end()) {
+        FFG_CachedString& entry = found->second;
+        if (entry.font == &font && entry.size == font.size_p && entry.scale == scale && entry.text == text) {
+            cache_hits_p++;
+            recency.splice(recency.begin(), recency, entry.recency_position);
+            return &entry;
+        }
+        remove_entry(key);
+        cache_evictions_p++;
+    }
+    cache_misses_p++;
+    std::vector<SDL_Vertex> laid_out;
+    layout(font, text.data(), text.size(), 0, 0, { 255, 255, 255, 255 }, scale, laid_out);
+    // Pre-rendering is sized once the texture is made, so room is made for the larger of the two:
+    std::size_t bytes = sizeof(FFG_CachedString) + text.size() + laid_out.size() * sizeof(SDL_Vertex);
+    if (cache_prerender) {
+        int width;
+        int height;
+        font.measure(text, &width, &height, scale);
+        bytes += (std::size_t)width * height * 4;
+    }
+    if (bytes > cache_capacity_p) return nullptr;
+    make_room(bytes);
+    FFG_CachedString& entry = cache[key];
+    entry.font = &font;
+    entry.size = font.size_p;
+    entry.scale = scale;
+    entry.text = text;
+    entry.vertices.swap(laid_out);
+    recency.push_front(key);
+    entry.recency_position = recency.begin();
+    entry.bytes = sizeof(FFG_CachedString) + text.size();
+    if (cache_prerender && !entry.vertices.empty() && !prerender(entry)) {
+        entry.bytes += (std::size_t)entry.texture.get_width() * entry.texture.get_height() * 4;
+        std::vector<SDL_Vertex>().swap(entry.vertices);
+    } else {
+        entry.bytes += entry.vertices.size() * sizeof(SDL_Vertex);
+    }
+    cache_size_p += entry.bytes;
+    return &entry;
+}
+
+/***************************************************************************//**
+ * Constructor.
+ ******************************************************************************/
+FFG_TextRenderer::FFG_CachedString::FFG_CachedString() {
+    font = nullptr;
+    size = 0;
+    scale = 1.0f;
+    offset_x = 0;
+    offset_y = 0;
+    bytes = 0;
+}
+
+/***************************************************************************//**
+ * Constructor.
+ * @param renderer The renderer to draw with, usually the engine.
+ ******************************************************************************/
+FFG_TextRenderer::FFG_TextRenderer(FFG_Renderer& renderer) : renderer(renderer) {
+    pending_font = nullptr;
+    collecting = false;
+    number_buffer[0] = '\0';
+    cache_capacity_p = FFG_UI_DEFAULT_CACHE_CAPACITY;
+    cache_size_p = 0;
+    cache_prerender = false;
+    cache_hits_p = 0;
+    cache_misses_p = 0;
+    cache_evictions_p = 0;
+}
+
+/***************************************************************************//**
+ * Loads a font's glyph atlas. Should only be called after engine
+ * initialization. Glyphs that lie outside the atlas are dropped.
+ * @param font The font.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_TextRenderer::load_font(FFG_Font& font) {
+    if (renderer.load_texture(font.page) || font.page.set_blend_mode(FFG_BLEND_ALPHA)) {
+        renderer.unload_texture(font.page);
+        return true;
+    }
+    // The texture coordinates are worked out once, rather than per glyph drawn:
+    const float width = (float)font.page.get_width();
+    const float height = (float)font.page.get_height();
+    for (FFG_Font::FFG_Glyph& glyph : font.glyphs) {
+        const FFG_Rect& source = glyph.source;
+        if (source.x < 0 || source.y < 0 || source.x + source.w > width || source.y + source.h > height) glyph.present = false;
+        glyph.u1 = source.x / width;
+        glyph.v1 = source.y / height;
+        glyph.u2 = (source.x + source.w) / width;
+        glyph.v2 = (source.y + source.h) / height;
+    }
+    return false;
+}
+
+/***************************************************************************//**
+ * Unloads a font's glyph atlas. Any of its glyphs still collected are dropped,
+ * as are its strings in the cache.
+ * @param font The font.
+ ******************************************************************************/
+void FFG_TextRenderer::unload_font(FFG_Font& font) {
+    if (pending_font == &font) {
+        vertices.clear();
+        pending_font = nullptr;
+    }
+    eviction_candidates.clear();
+    for (const auto& key_entry : cache) {
+        if (key_entry.second.font == &font) eviction_candidates.push_back(key_entry.first);
+    }
+    for (Uint64 key : eviction_candidates) remove_entry(key);
+    renderer.unload_texture(font.page);
+}
+
+/***************************************************************************//**
+ * Draws a string with its top left at a location on the current target. Lines
+ * are separated by '\n'.
+ * NOTE: This method is core loop critical.
+ * @param font The font, which must be loaded.
+ * @param text The string.
+ * @param x The upper-left x coordinate of the string on the current target.
+ * @param y The upper-left y coordinate of the string on the current target.
+ * @param color The color of the glyphs.
+ * @param scale The scale of the glyphs.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_TextRenderer::draw_text(FFG_Font& font, const std::string& text, int x, int y, const SDL_Color& color, const float scale) {
+    return add_text(font, text.data(), text.size(), x, y, color, scale);
+}
+
+/***************************************************************************//**
+ * Draws a number with its top left at a location on the current target. The
+ * number is formatted into a reused buffer, so no string is allocated.
+ * NOTE: This method is core loop critical.
+ * @param font The font, which must be loaded.
+ * @param value The number.
+ * @param x The upper-left x coordinate of the number on the current target.
+ * @param y The upper-left y coordinate of the number on the current target.
+ * @param color The color of the glyphs.
+ * @param scale The scale of the glyphs.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_TextRenderer::draw_number(FFG_Font& font, long value, int x, int y, const SDL_Color& color, const float scale) {
+    const int length = std::snprintf(number_buffer, FFG_UI_NUMBER_BUFFER_SIZE, "%ld", value);
+    if (length < 0) return true;
+    return add_text(font, number_buffer, length, x, y, color, scale);
+}
+
+/***************************************************************************//**
+ * Draws a string from the cache with its top left at a location on the current
+ * target, laying it out, and pre-rendering it if pre-rendering is on, the first
+ * time it is drawn. While collecting text, a pre-rendered string is drawn at
+ * once, beneath the collected text.
+ * NOTE: This method is core loop critical.
+ * @param font The font, which must be loaded.
+ * @param text The string.
+ * @param x The upper-left x coordinate of the string on the current target.
+ * @param y The upper-left y coordinate of the string on the current target.
+ * @param color The color of the glyphs.
+ * @param scale The scale of the glyphs.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_TextRenderer::draw_label(FFG_Font& font, const std::string& text, int x, int y, const SDL_Color& color, const float scale) {
+    if (!font.is_loaded()) return true;
+    FFG_CachedString* entry = find_label(font, text, scale);
+    if (!entry) return draw_text(font, text, x, y, color, scale);
+    if (entry->texture.is_loaded()) {
+        FFG_Texture& texture = entry->texture;
+        FFG_Rect source = { 0, 0, texture.get_width(), texture.get_height() };
+        if (texture.set_mod_color(color.r, color.g, color.b) || texture.set_mod_alpha(color.a)) return true;
+        return renderer.draw(texture, source, x + entry->offset_x, y + entry->offset_y);
+    }
+    bool failed = false;
+    if (pending_font != &font && submit()) failed = true;
+    pending_font = &font;
+    for (const SDL_Vertex& vertex : entry->vertices) vertices.push_back({ { vertex.position.x + x, vertex.position.y + y }, color, vertex.tex_coord });
+    if (!collecting && submit()) failed = true;
+    return failed;
+}
+
+/***************************************************************************//**
+ * Begins collecting text. Until FFG_TextRenderer::end_text() is called, drawn
+ * strings are collected and submitted together. Does nothing if already
+ * collecting.
+ ******************************************************************************/
+void FFG_TextRenderer::begin_text() {
+    collecting = true;
+}
+
+/***************************************************************************//**
+ * Ends collecting text, submitting any strings still collected.
+ * @return False on success. Otherwise true.
+ ******************************************************************************/
+bool FFG_TextRenderer::end_text() {
+    collecting = false;
+    return submit();
+}
+
+/***************************************************************************//**
+ * Sets the most memory the string cache may use, evicting the least recently
+ * drawn strings if it already uses more.
+ * @param bytes The capacity in bytes.
+ ******************************************************************************/
+void FFG_TextRenderer::set_cache_capacity(const std::size_t bytes) {
+    cache_capacity_p = bytes;
+    make_room(0);
+}
+
+/***************************************************************************//**
+ * Sets whether strings added to the cache are pre-rendered into draw-toable
+ * textures. Strings already cached are left as they are.
+ * @param prerender If true, strings are pre-rendered.
+ ******************************************************************************/
+void FFG_TextRenderer::set_cache_prerender(const bool prerender) {
+    cache_prerender = prerender;
+}
+
+/***************************************************************************//**
+ * Removes every string from the cache, unloading the textures of those that
+ * were pre-rendered. Does not count as evictions.
+ ******************************************************************************/
+void FFG_TextRenderer::clear_cache() {
+    for (auto& key_entry : cache) {
+        if (key_entry.second.texture.is_loaded()) renderer.unload_texture(key_entry.second.texture);
+    }
+    cache.clear();
+    recency.clear();
+    cache_size_p = 0;
+}
+
+/***************************************************************************//**
+ * Resets the cache's hit, miss and eviction counters to 0.
+ ******************************************************************************/
+void FFG_TextRenderer::reset_cache_counters() {
+    cache_hits_p = 0;
+    cache_misses_p = 0;
+    cache_evictions_p = 0;
+}
+
+/***************************************************************************//**
+ * Returns the number of labels drawn from strings already in the cache.
+ * @return The number of hits.
+ ******************************************************************************/
+unsigned long FFG_TextRenderer::cache_hits() const {
+    return cache_hits_p;
+}
+
+/***************************************************************************//**
+ * Returns the number of labels whose strings had to be added to the cache.
+ * @return The number of misses.
+ ******************************************************************************/
+unsigned long FFG_TextRenderer::cache_misses() const {
+    return cache_misses_p;
+}
+
+/***************************************************************************//**
+ * Returns the number of strings removed from the cache to make room, or
+ * replaced by another string with the same key.
+ * @return The number of evictions.
+ ******************************************************************************/
+unsigned long FFG_TextRenderer::cache_evictions() const {
+    return cache_evictions_p;
+}
+
+/***************************************************************************//**
+ * Returns the memory the string cache uses.
+ * @return The size in bytes.
+ ******************************************************************************/
+std::size_t FFG_TextRenderer::cache_size() const {
+    return cache_size_p;
+}
+
+/***************************************************************************//**
+ * Returns the number of strings in the cache.
+ * @return The number of strings.
+ ******************************************************************************/
+unsigned int FFG_TextRenderer::cache_entries() const {
+    return cache.size();
+}
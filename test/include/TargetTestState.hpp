@@ -2,21 +2,29 @@
 #define TARGET_TEST_STATE_H_INCLUDED
 
 #include <iostream>
+#include <vector>
 #include "FFG.hpp"
 #include "TestSwitchboard.hpp"
 
 #define SOLDIER_WIDTH 200
 #define SOLDIER_HEIGHT 300
+#define SOLDIER_COMPOSITOR_CAPACITY 4
 
 class TargetTestState : public FFG_State {
 private:
 	TestSwitchboard& switchboard;
-	FFG_Texture target_texture;
+	FFG_CachedLayer soldier_layer;
+	FFG_SpriteCompositor soldier_compositor;
+	FFG_Texture* soldier_1_helmet = nullptr;
+	FFG_Texture* soldier_2_pack = nullptr;
+	FFG_Texture* soldier_3_pants = nullptr;
+	FFG_Texture* soldier_4_shirt = nullptr;
+	FFG_Texture* soldier_5_skin = nullptr;
+	FFG_Texture* soldier_6_rifle = nullptr;
 	int rs[6] = { 82, 138, 102, 143, 238,  89};
 	int gs[6] = { 75, 111,  57, 151, 195,  86};
 	int bs[6] = { 36,  48,  49,  74, 154,  82};
-	int draw_to_x;
-	int draw_to_y;
+	std::vector<SDL_Color> soldier_tints;
 private:
 	void redraw_soldier();
 public:
@@ -8,12 +8,14 @@ class TestSwitchboard {
 public:
     // Textures
     FFG_Texture screen_resolutions;
-    FFG_Texture soldier_1_helmet;
-    FFG_Texture soldier_2_pack;
-    FFG_Texture soldier_3_pants;
-    FFG_Texture soldier_4_shirt;
-    FFG_Texture soldier_5_skin;
-    FFG_Texture soldier_6_rifle;
+    std::string soldier_1_helmet_path;
+    std::string soldier_2_pack_path;
+    std::string soldier_3_pants_path;
+    std::string soldier_4_shirt_path;
+    std::string soldier_5_skin_path;
+    std::string soldier_6_rifle_path;
+    // Fonts
+    std::string font_path;
     // State IDs
 	unsigned int draw_1_id;
     unsigned int draw_2_id;
@@ -21,6 +23,7 @@ public:
     unsigned int event_id;
     unsigned int primitive_id;
     unsigned int target_id;
+    unsigned int text_id;
     unsigned int timer_id;
     unsigned int window_id;
 };
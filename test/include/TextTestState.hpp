@@ -0,0 +1,31 @@
+#ifndef TEXT_TEST_STATE_H_INCLUDED
+#define TEXT_TEST_STATE_H_INCLUDED
+
+#include <iostream>
+#include "FFG.hpp"
+#include "FFG_UI.hpp"
+#include "test_constants.hpp"
+#include "TestSwitchboard.hpp"
+
+#define FONT_CELL_WIDTH 4
+#define FONT_CELL_HEIGHT 6
+#define FONT_COLUMNS 16
+#define TEXT_SCALE 4.0f
+#define TEXT_MARGIN 32
+
+class TextTestState : public FFG_State {
+private:
+	TestSwitchboard& switchboard;
+	FFG_Font font;
+	FFG_TextRenderer text;
+	unsigned long frame;
+public:
+	TextTestState(FFG_Engine& engine, TestSwitchboard& switchboard);
+	void init();
+	void exit();
+	void handle();
+	void update();
+	void render();
+};
+
+#endif // TEXT_TEST_STATE_H_INCLUDED
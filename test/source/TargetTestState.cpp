@@ -1,58 +1,72 @@
 #include "TargetTestState.hpp"
 
 void TargetTestState::redraw_soldier() {
-    engine.set_render_target(target_texture);
     engine.set_draw_color(0, 0, 0, 255);
     engine.render_clear();
 
+    // Baked once, then drawn as a single quad.
+    if (soldier_compositor.is_loaded()) {
+        engine.draw_composite(soldier_compositor, soldier_tints, 0, 0);
+        return;
+    }
+
     // Modulation colors.
-    switchboard.soldier_1_helmet.set_mod_color(rs[0], gs[0], bs[0]);
-    switchboard.soldier_2_pack.set_mod_color(rs[1], gs[1], bs[1]);
-    switchboard.soldier_3_pants.set_mod_color(rs[2], gs[2], bs[2]);
-    switchboard.soldier_4_shirt.set_mod_color(rs[3], gs[3], bs[3]);
-    switchboard.soldier_5_skin.set_mod_color(rs[4], gs[4], bs[4]);
-    switchboard.soldier_6_rifle.set_mod_color(rs[5], gs[5], bs[5]);
+    if (soldier_1_helmet) soldier_1_helmet->set_mod_color(rs[0], gs[0], bs[0]);
+    if (soldier_2_pack) soldier_2_pack->set_mod_color(rs[1], gs[1], bs[1]);
+    if (soldier_3_pants) soldier_3_pants->set_mod_color(rs[2], gs[2], bs[2]);
+    if (soldier_4_shirt) soldier_4_shirt->set_mod_color(rs[3], gs[3], bs[3]);
+    if (soldier_5_skin) soldier_5_skin->set_mod_color(rs[4], gs[4], bs[4]);
+    if (soldier_6_rifle) soldier_6_rifle->set_mod_color(rs[5], gs[5], bs[5]);
 
     // Draws.
-    engine.draw(switchboard.soldier_6_rifle);
-    engine.draw(switchboard.soldier_5_skin);
-    engine.draw(switchboard.soldier_4_shirt);
-    engine.draw(switchboard.soldier_3_pants);
-    engine.draw(switchboard.soldier_2_pack);
-    engine.draw(switchboard.soldier_1_helmet);
-
-    engine.reset_render_target();
+    if (soldier_6_rifle) engine.draw(*soldier_6_rifle);
+    if (soldier_5_skin) engine.draw(*soldier_5_skin);
+    if (soldier_4_shirt) engine.draw(*soldier_4_shirt);
+    if (soldier_3_pants) engine.draw(*soldier_3_pants);
+    if (soldier_2_pack) engine.draw(*soldier_2_pack);
+    if (soldier_1_helmet) engine.draw(*soldier_1_helmet);
 }
 
 TargetTestState::TargetTestState(FFG_Engine& engine, TestSwitchboard& switchboard) : FFG_State(engine), switchboard(switchboard) {
-    target_texture.set(SOLDIER_WIDTH, SOLDIER_HEIGHT);
-    draw_to_x = 0;
-    draw_to_y = 0;
+    soldier_layer.set(SOLDIER_WIDTH, SOLDIER_HEIGHT, [this]() { redraw_soldier(); });
+    soldier_compositor.set(SOLDIER_WIDTH, SOLDIER_HEIGHT, SOLDIER_COMPOSITOR_CAPACITY);
+    // Layers bottom first, tinted in the same order.
+    const int order[6] = { 5, 4, 3, 2, 1, 0 };
+    for (int i : order) soldier_tints.push_back({ (Uint8)rs[i], (Uint8)gs[i], (Uint8)bs[i], 255 });
 }
 
 void TargetTestState::init() {
     std::cout << "--> TargetTestState." << std::endl;
-    engine.load_texture(switchboard.soldier_1_helmet);
-    engine.load_texture(switchboard.soldier_2_pack);
-    engine.load_texture(switchboard.soldier_3_pants);
-    engine.load_texture(switchboard.soldier_4_shirt);
-    engine.load_texture(switchboard.soldier_5_skin);
-    engine.load_texture(switchboard.soldier_6_rifle);
-    engine.load_texture(target_texture);
-    draw_to_x = (engine.screen_width() - SOLDIER_WIDTH) / 2;
-    draw_to_y = (engine.screen_height() - SOLDIER_HEIGHT) / 2;
-    redraw_soldier();
+    soldier_1_helmet = engine.acquire_texture(switchboard.soldier_1_helmet_path);
+    soldier_2_pack = engine.acquire_texture(switchboard.soldier_2_pack_path);
+    soldier_3_pants = engine.acquire_texture(switchboard.soldier_3_pants_path);
+    soldier_4_shirt = engine.acquire_texture(switchboard.soldier_4_shirt_path);
+    soldier_5_skin = engine.acquire_texture(switchboard.soldier_5_skin_path);
+    soldier_6_rifle = engine.acquire_texture(switchboard.soldier_6_rifle_path);
+    if (soldier_1_helmet && soldier_2_pack && soldier_3_pants && soldier_4_shirt && soldier_5_skin && soldier_6_rifle) {
+        soldier_compositor.clear_layers();
+        soldier_compositor.add_layer(*soldier_6_rifle);
+        soldier_compositor.add_layer(*soldier_5_skin);
+        soldier_compositor.add_layer(*soldier_4_shirt);
+        soldier_compositor.add_layer(*soldier_3_pants);
+        soldier_compositor.add_layer(*soldier_2_pack);
+        soldier_compositor.add_layer(*soldier_1_helmet);
+        engine.load_compositor(soldier_compositor);
+    }
+    soldier_layer.set_position((engine.screen_width() - SOLDIER_WIDTH) / 2, (engine.screen_height() - SOLDIER_HEIGHT) / 2);
+    engine.add_layer(soldier_layer);
 }
 
 void TargetTestState::exit() {
     std::cout << "<-- TargetTestState." << std::endl;
-    engine.unload_texture(switchboard.soldier_1_helmet);
-    engine.unload_texture(switchboard.soldier_2_pack);
-    engine.unload_texture(switchboard.soldier_3_pants);
-    engine.unload_texture(switchboard.soldier_4_shirt);
-    engine.unload_texture(switchboard.soldier_5_skin);
-    engine.unload_texture(switchboard.soldier_6_rifle);
-    engine.unload_texture(target_texture);
+    engine.unload_compositor(soldier_compositor);
+    engine.release_texture(soldier_1_helmet);
+    engine.release_texture(soldier_2_pack);
+    engine.release_texture(soldier_3_pants);
+    engine.release_texture(soldier_4_shirt);
+    engine.release_texture(soldier_5_skin);
+    engine.release_texture(soldier_6_rifle);
+    engine.remove_layer(soldier_layer);
 }
 
 void TargetTestState::handle() {
@@ -65,6 +79,10 @@ void TargetTestState::handle() {
                         case '[':
                             engine.set_next_state(switchboard.primitive_id);
                             return;
+                        case '}':
+                        case ']':
+                            engine.set_next_state(switchboard.text_id);
+                            return;
                         default:
                             break;
                     } // switch(engine.key)
@@ -87,10 +105,5 @@ void TargetTestState::update() {
 void TargetTestState::render() {
     engine.reset_render_target();
     engine.render_clear();
-    FFG_Rect source;
-    source.x = 0;
-    source.y = 0;
-    source.w = SOLDIER_WIDTH;
-    source.h = SOLDIER_HEIGHT;
-    engine.draw(target_texture, source, draw_to_x, draw_to_y);
+    // The soldier layer is composited by the engine afterward.
 }
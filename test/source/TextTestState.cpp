@@ -0,0 +1,79 @@
+#include "TextTestState.hpp"
+
+TextTestState::TextTestState(FFG_Engine& engine, TestSwitchboard& switchboard) : FFG_State(engine), switchboard(switchboard), text(engine) {
+    frame = 0;
+}
+
+void TextTestState::init() {
+    frame = 0;
+    std::cout << "--> TextTestState." << std::endl;
+    std::cout << "\tThis state tests drawing text with a bitmap font." << std::endl;
+    std::cout << "\t[    - Go to TargetTestState." << std::endl;
+    std::cout << "\t]    - Go to TimerTestState." << std::endl;
+    if (font.set_grid(switchboard.font_path, FONT_CELL_WIDTH, FONT_CELL_HEIGHT, FONT_COLUMNS) || text.load_font(font)) throw LOAD_TEXTURE_FAIL;
+}
+
+void TextTestState::exit() {
+    std::cout << "<-- TextTestState." << std::endl;
+    std::cout << "\tLabel cache hits: " << text.cache_hits() << " misses: " << text.cache_misses() << std::endl;
+    text.clear_cache();
+    text.unload_font(font);
+}
+
+void TextTestState::handle() {
+    switch(engine.type) {
+        case FFG_EVENT_KEYBOARD_UP:
+            switch(engine.key_type) {
+                case FFG_EVENT_KEY_CHAR:
+                    switch(engine.key) {
+                        case '{':
+                        case '[':
+                            engine.set_next_state(switchboard.target_id);
+                            return;
+                        case '}':
+                        case ']':
+                            engine.set_next_state(switchboard.timer_id);
+                            return;
+                        default:
+                            break;
+                    } // switch(engine.key)
+                    break;
+                case FFG_EVENT_KEY_ESCAPE:
+                    engine.quit();
+                    return;
+                default:
+                    break;
+            } // switch(engine.key_type)
+            break;
+        case FFG_EVENT_WINDOW_RENDER_RESET:
+            // Pre-rendered labels are lost with the render targets.
+            text.clear_cache();
+            break;
+        default:
+            break;
+    } // switch(engine.type)
+}
+
+void TextTestState::update() {
+    frame++;
+}
+
+void TextTestState::render() {
+    const SDL_Color white = { 255, 255, 255, 255 };
+    const SDL_Color yellow = { 255, 220, 64, 255 };
+    const int line = (int)(font.line_height() * TEXT_SCALE);
+    engine.set_draw_color(0, 0, 0, 255);
+    engine.render_clear();
+
+    // Labels are laid out once and drawn from the cache afterward.
+    text.draw_label(font, "TextTestState", TEXT_MARGIN, TEXT_MARGIN, yellow, TEXT_SCALE);
+    text.draw_label(font, "Every line below is submitted as one draw.", TEXT_MARGIN, TEXT_MARGIN + line, white, TEXT_SCALE);
+
+    // Strings that change every frame are collected and submitted together.
+    text.begin_text();
+    text.draw_text(font, "Frame:", TEXT_MARGIN, TEXT_MARGIN + line * 3, white, TEXT_SCALE);
+    text.draw_number(font, (long)frame, TEXT_MARGIN + (int)(7 * FONT_CELL_WIDTH * TEXT_SCALE), TEXT_MARGIN + line * 3, yellow, TEXT_SCALE);
+    text.draw_text(font, "0123456789 !\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~", TEXT_MARGIN, TEXT_MARGIN + line * 4, white, TEXT_SCALE);
+    text.draw_text(font, "The quick brown fox jumps over the lazy dog.", TEXT_MARGIN, TEXT_MARGIN + line * 5, white, TEXT_SCALE);
+    text.end_text();
+}
@@ -7,6 +7,7 @@
 #include "PrimitiveTestState.hpp"
 #include "TargetTestState.hpp"
 #include "test_constants.hpp"
+#include "TextTestState.hpp"
 #include "TimerTestState.hpp"
 #include "WindowTestState.hpp"
 
@@ -20,6 +21,7 @@
 #define SOLDIER_4_SHIRT_PATH "test/images/soldier4shirt.png"
 #define SOLDIER_5_SKIN_PATH "test/images/soldier5skin.png"
 #define SOLDIER_6_RIFLE_PATH "test/images/soldier6rifle.png"
+#define FONT_PATH "test/images/font3x5.png"
 
 void print_error(TestError error) {
     switch(error) {
@@ -36,12 +38,13 @@ int main(int argc, char **argv) {
     // Switchboard:
     TestSwitchboard switchboard;
     switchboard.screen_resolutions.set(SCREEN_RESOLUTIONS_PATH);
-    switchboard.soldier_1_helmet.set(SOLDIER_1_HELMET_PATH);
-    switchboard.soldier_2_pack.set(SOLDIER_2_PACK_PATH);
-    switchboard.soldier_3_pants.set(SOLDIER_3_PANTS_PATH);
-    switchboard.soldier_4_shirt.set(SOLDIER_4_SHIRT_PATH);
-    switchboard.soldier_5_skin.set(SOLDIER_5_SKIN_PATH);
-    switchboard.soldier_6_rifle.set(SOLDIER_6_RIFLE_PATH);
+    switchboard.soldier_1_helmet_path = SOLDIER_1_HELMET_PATH;
+    switchboard.soldier_2_pack_path = SOLDIER_2_PACK_PATH;
+    switchboard.soldier_3_pants_path = SOLDIER_3_PANTS_PATH;
+    switchboard.soldier_4_shirt_path = SOLDIER_4_SHIRT_PATH;
+    switchboard.soldier_5_skin_path = SOLDIER_5_SKIN_PATH;
+    switchboard.soldier_6_rifle_path = SOLDIER_6_RIFLE_PATH;
+    switchboard.font_path = FONT_PATH;
 
     // Engine:
     FFG_Engine engine;
@@ -53,6 +56,7 @@ int main(int argc, char **argv) {
     EventTestState event_state(engine, switchboard);
     PrimitiveTestState primitive_state(engine, switchboard);
     TargetTestState target_state(engine, switchboard);
+    TextTestState text_state(engine, switchboard);
     TimerTestState timer_state(engine, switchboard);
     WindowTestState window_state(engine, switchboard);
 
@@ -63,6 +67,7 @@ int main(int argc, char **argv) {
     unsigned int event_id = engine.register_state(&event_state);
     unsigned int primitive_id = engine.register_state(&primitive_state);
     unsigned int target_id = engine.register_state(&target_state);
+    unsigned int text_id = engine.register_state(&text_state);
     unsigned int timer_id = engine.register_state(&timer_state);
     unsigned int window_id = engine.register_state(&window_state);
 
@@ -73,6 +78,7 @@ int main(int argc, char **argv) {
     switchboard.event_id = event_id;
     switchboard.primitive_id = primitive_id;
     switchboard.target_id = target_id;
+    switchboard.text_id = text_id;
     switchboard.timer_id = timer_id;
     switchboard.window_id = window_id;
 
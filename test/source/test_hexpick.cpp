@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "FFG.hpp"
+
+#define MAP_WIDTH 9
+#define MAP_HEIGHT 7
+// Points closer than this to the edge of a hex could round either way:
+#define EDGE_MARGIN 0.01
+
+// Hex sizes whose heights divide by four, so the default row height spaces
+// them exactly:
+const int HEX_SIZES[][2] = { { 64, 64 }, { 56, 64 }, { 70, 80 }, { 32, 36 }, { 8, 8 } };
+const int NUM_HEX_SIZES = sizeof(HEX_SIZES) / sizeof(HEX_SIZES[0]);
+
+int failures = 0;
+
+void check(bool passed, const std::string& name) {
+    if (!passed) failures++;
+    std::cout << (passed ? "PASS: " : "FAIL: ") << name << std::endl;
+}
+
+// How far a point is inside a pointy-topped hex whose sprite has its top left
+// at the position given. Negative if the point is outside:
+double inside(const FFG_MapHex& map, int left, int top, int x, int y) {
+    const double w = map.hex_width();
+    const double h = map.hex_height();
+    const double dx = std::fabs(x - (left + w * 0.5));
+    const double dy = std::fabs(y - (top + h * 0.5));
+    // The sides are vertical, and the slanted edges run from the top and
+    // bottom points to a quarter of the height in from the corners:
+    const double side = w * 0.5 - dx;
+    const double slant = (h * 0.5 - h * dx / (2 * w) - dy) * (2 * w) / std::sqrt(4 * w * w + h * h);
+    return std::min(side, slant);
+}
+
+void test_pick(int hex_width, int hex_height) {
+    const FFG_MapHex map(MAP_WIDTH, MAP_HEIGHT, hex_width, hex_height);
+    const std::string name = std::to_string(hex_width) + "x" + std::to_string(hex_height);
+    int wrong = 0;
+    int bad_bounds = 0;
+    int checked = 0;
+    int total = 0;
+    int uncovered = 0;
+    // Every pixel of the map and a border of cells around it:
+    const int x0 = -2 * hex_width;
+    const int y0 = -2 * hex_height;
+    const int x1 = (MAP_WIDTH + 2) * hex_width;
+    const int y1 = (MAP_HEIGHT + 2) * map.row_height() + hex_height;
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            total++;
+            // Test every cell near the point, rather than trusting any math
+            // shared with pick():
+            int expected_column = 0;
+            int expected_row = 0;
+            int num_inside = 0;
+            double edge_distance = -1;
+            const int row_guess = (int)std::floor((double)y / map.row_height());
+            const int column_guess = (int)std::floor((double)x / hex_width);
+            for (int row = row_guess - 2; row <= row_guess + 2; row++) {
+                for (int column = column_guess - 2; column <= column_guess + 2; column++) {
+                    int left, top;
+                    map.get_position(column, row, &left, &top);
+                    const double depth = inside(map, left, top, x, y);
+                    if (depth > -EDGE_MARGIN) {
+                        num_inside++;
+                        expected_column = column;
+                        expected_row = row;
+                        edge_distance = depth;
+                    }
+                }
+            }
+            if (num_inside == 0) uncovered++;
+            // Skip points on an edge, which belong to either hex:
+            if (num_inside != 1 || edge_distance < EDGE_MARGIN) continue;
+            checked++;
+            int column = -1;
+            int row = -1;
+            const bool outside = map.pick(x, y, &column, &row);
+            if (column != expected_column || row != expected_row) wrong++;
+            const bool expected_outside = expected_column < 0 || expected_row < 0 || expected_column >= MAP_WIDTH || expected_row >= MAP_HEIGHT;
+            if (outside != expected_outside) bad_bounds++;
+        }
+    }
+    check(uncovered == 0, name + " hexes cover the map");
+    // Most points are well inside a hex; only edges are skipped:
+    check(checked > total * 3 / 4, name + " points away from edges");
+    check(wrong == 0, name + " pick matches the containing hex");
+    check(bad_bounds == 0, name + " pick reports points outside the map");
+}
+
+// Every cell's center picks that cell, including cells outside the map:
+void test_centers() {
+    const FFG_MapHex map(MAP_WIDTH, MAP_HEIGHT, 64, 64);
+    int wrong = 0;
+    for (int row = -3; row < MAP_HEIGHT + 3; row++) {
+        for (int column = -3; column < MAP_WIDTH + 3; column++) {
+            int x, y;
+            map.get_position(column, row, &x, &y);
+            int picked_column, picked_row;
+            map.pick(x + 32, y + 32, &picked_column, &picked_row);
+            if (picked_column != column || picked_row != row) wrong++;
+        }
+    }
+    check(wrong == 0, "centers pick their cells");
+}
+
+int main(int argc, char **argv) {
+    for (int i = 0; i < NUM_HEX_SIZES; i++) test_pick(HEX_SIZES[i][0], HEX_SIZES[i][1]);
+    test_centers();
+    std::cout << failures << " failure(s)." << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,144 @@
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "FFG.hpp"
+
+#define RANDOM_SEED 12345
+// Bytes past the end of each output buffer, which must never be written:
+#define GUARD_SIZE 64
+#define GUARD_BYTE 0xA5
+// Larger than the 64 KiB window, so matches must be found within it:
+#define LARGE_SIZE 200000
+#define NUM_CORRUPTIONS 2000
+
+int failures = 0;
+
+void check(bool passed, const std::string& name) {
+    if (!passed) failures++;
+    std::cout << (passed ? "PASS: " : "FAIL: ") << name << std::endl;
+}
+
+std::vector<Uint8> random_bytes(unsigned int size) {
+    std::vector<Uint8> bytes(size);
+    for (Uint8& byte : bytes) byte = (Uint8)(std::rand() & 0xFF);
+    return bytes;
+}
+
+std::vector<Uint8> repeated_bytes(unsigned int size) {
+    std::vector<Uint8> bytes(size);
+    for (unsigned int i = 0; i < size; i++) bytes[i] = (Uint8)("FFG!"[i % 4]);
+    return bytes;
+}
+
+// Random runs of random lengths, like the rows of a sprite sheet:
+std::vector<Uint8> mixed_bytes(unsigned int size) {
+    std::vector<Uint8> bytes;
+    while (bytes.size() < size) {
+        const Uint8 byte = (Uint8)(std::rand() & 0xFF);
+        const int run = std::rand() % 3 ? 1 : std::rand() % 300;
+        for (int i = 0; i < run; i++) bytes.push_back(byte);
+    }
+    bytes.resize(size);
+    return bytes;
+}
+
+// Decompresses into a buffer followed by guard bytes. Returns the result of
+// lz4_decompress(), and sets overran if any guard byte changed:
+bool decompress(const std::vector<Uint8>& block, unsigned int size, std::vector<Uint8>& out, bool& overran) {
+    out.assign(size + GUARD_SIZE, GUARD_BYTE);
+    const bool failed = FFG_RawImage::lz4_decompress(block.data(), block.size(), out.data(), size);
+    overran = false;
+    for (unsigned int i = size; i < out.size(); i++) if (out[i] != GUARD_BYTE) overran = true;
+    out.resize(size);
+    return failed;
+}
+
+void round_trip(const std::string& name, const std::vector<Uint8>& data) {
+    std::vector<Uint8> block;
+    FFG_RawImage::lz4_compress(data.data(), data.size(), block);
+    std::vector<Uint8> out;
+    bool overran;
+    const bool failed = decompress(block, data.size(), out, overran);
+    check(!failed && !overran && out == data, name + " round trip (" + std::to_string(data.size()) + " bytes)");
+}
+
+void test_round_trips() {
+    // Below 13 bytes, the whole block must be literals:
+    for (unsigned int size = 0; size < 13; size++) {
+        round_trip("random", random_bytes(size));
+        round_trip("repeated", repeated_bytes(size));
+    }
+    for (unsigned int size : { 13u, 14u, 17u, 255u, 256u, 270u, 1000u, 65535u, 65536u, 65537u, (unsigned int)LARGE_SIZE }) {
+        round_trip("random", random_bytes(size));
+        round_trip("repeated", repeated_bytes(size));
+        round_trip("mixed", mixed_bytes(size));
+    }
+    // Repeats further apart than the window cannot be matched, but must still
+    // come back intact:
+    std::vector<Uint8> far = random_bytes(70000);
+    far.insert(far.end(), far.begin(), far.end());
+    round_trip("repeated beyond window", far);
+    // Repetitive data should actually compress:
+    const std::vector<Uint8> repeated = repeated_bytes(LARGE_SIZE);
+    std::vector<Uint8> block;
+    FFG_RawImage::lz4_compress(repeated.data(), repeated.size(), block);
+    check(block.size() < repeated.size() / 100, "repeated compresses");
+}
+
+void test_truncated() {
+    const std::vector<Uint8> data = mixed_bytes(2000);
+    std::vector<Uint8> block;
+    FFG_RawImage::lz4_compress(data.data(), data.size(), block);
+    bool all_failed = true;
+    bool any_overran = false;
+    std::vector<Uint8> out;
+    for (unsigned int size = 0; size < block.size(); size++) {
+        const std::vector<Uint8> truncated(block.begin(), block.begin() + size);
+        bool overran;
+        if (!decompress(truncated, data.size(), out, overran)) all_failed = false;
+        if (overran) any_overran = true;
+    }
+    check(all_failed, "truncated blocks fail");
+    check(!any_overran, "truncated blocks stay in bounds");
+    // The wrong output size fails as well:
+    bool overran;
+    check(decompress(block, data.size() - 1, out, overran) && !overran, "output too small fails");
+    check(decompress(block, data.size() + 1, out, overran) && !overran, "output too large fails");
+}
+
+void test_corrupt() {
+    // A literal run longer than the block:
+    bool overran;
+    std::vector<Uint8> out;
+    check(decompress({ 0x30, 'a' }, 3, out, overran) && !overran, "literals past end fail");
+    // A literal length extension that is cut off:
+    check(decompress({ 0xF0, 255 }, 300, out, overran) && !overran, "cut off length fails");
+    // A match offset of zero:
+    check(decompress({ 0x10, 'a', 0, 0, 0x00 }, 5, out, overran) && !overran, "zero offset fails");
+    // A match from before the start of the output:
+    check(decompress({ 0x10, 'a', 2, 0, 0x00 }, 5, out, overran) && !overran, "offset before start fails");
+    // A match longer than the output:
+    check(decompress({ 0x1F, 'a', 1, 0, 200, 0x00 }, 20, out, overran) && !overran, "match past end fails");
+    // Randomly corrupted blocks may happen to decode, but never out of bounds:
+    const std::vector<Uint8> data = mixed_bytes(5000);
+    std::vector<Uint8> block;
+    FFG_RawImage::lz4_compress(data.data(), data.size(), block);
+    bool any_overran = false;
+    for (int i = 0; i < NUM_CORRUPTIONS; i++) {
+        std::vector<Uint8> corrupt = block;
+        const int flips = 1 + std::rand() % 4;
+        for (int f = 0; f < flips; f++) corrupt[std::rand() % corrupt.size()] = (Uint8)(std::rand() & 0xFF);
+        decompress(corrupt, data.size(), out, overran);
+        if (overran) any_overran = true;
+    }
+    check(!any_overran, "corrupt blocks stay in bounds");
+}
+
+int main(int argc, char **argv) {
+    std::srand(RANDOM_SEED);
+    test_round_trips();
+    test_truncated();
+    test_corrupt();
+    std::cout << failures << " failure(s)." << std::endl;
+    return failures ? 1 : 0;
+}
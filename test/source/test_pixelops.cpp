@@ -0,0 +1,128 @@
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "FFG.hpp"
+
+// Odd, so every SIMD version leaves pixels over for its scalar tail:
+#define NUM_PIXELS 1027
+#define RANDOM_SEED 12345
+
+const Uint32 FORMATS[] = {
+    SDL_PIXELFORMAT_ARGB8888,
+    SDL_PIXELFORMAT_ABGR8888,
+    SDL_PIXELFORMAT_RGBA8888,
+    SDL_PIXELFORMAT_BGRA8888,
+    SDL_PIXELFORMAT_RGB888
+};
+const int NUM_FORMATS = sizeof(FORMATS) / sizeof(FORMATS[0]);
+
+const FFG_SimdLevel LEVELS[] = { FFG_SIMD_SSE2, FFG_SIMD_AVX2 };
+const char* LEVEL_NAMES[] = { "scalar", "SSE2", "AVX2" };
+
+int failures = 0;
+
+void check(bool passed, const std::string& name) {
+    if (!passed) failures++;
+    std::cout << (passed ? "PASS: " : "FAIL: ") << name << std::endl;
+}
+
+std::vector<Uint32> random_pixels() {
+    std::vector<Uint32> pixels(NUM_PIXELS);
+    for (Uint32& pixel : pixels) pixel = ((Uint32)(std::rand() & 0xFFFF) << 16) | (Uint32)(std::rand() & 0xFFFF);
+    // Include the extremes of alpha, where rounding errors would show:
+    pixels[0] = 0x00000000;
+    pixels[1] = 0xFFFFFFFF;
+    pixels[2] = 0x80FF7F01;
+    return pixels;
+}
+
+// Runs an operation at a SIMD level, on a copy of the pixels:
+template <typename Operation>
+std::vector<Uint32> run(FFG_SimdLevel level, const std::vector<Uint32>& pixels, Operation operation) {
+    std::vector<Uint32> result = pixels;
+    FFG_PixelOps::set_simd_level(level);
+    operation(result);
+    return result;
+}
+
+// Compares each SIMD level the CPU supports against the scalar version:
+template <typename Operation>
+void compare(const std::string& name, const std::vector<Uint32>& pixels, Operation operation) {
+    const std::vector<Uint32> expected = run(FFG_SIMD_SCALAR, pixels, operation);
+    for (FFG_SimdLevel level : LEVELS) {
+        if (FFG_PixelOps::set_simd_level(level) != level) {
+            std::cout << "SKIP: " << name << " (" << LEVEL_NAMES[level] << " not supported)" << std::endl;
+            continue;
+        }
+        check(run(level, pixels, operation) == expected, name + " (" + LEVEL_NAMES[level] + ")");
+    }
+}
+
+void test_known_values() {
+    FFG_PixelOps::set_simd_level(FFG_SIMD_SCALAR);
+    // Half alpha halves the color, rounding to nearest:
+    Uint32 pixel = 0x80FF8000;
+    FFG_PixelOps::premultiply(&pixel, 1, SDL_PIXELFORMAT_ARGB8888);
+    check(pixel == 0x80804000, "premultiply known value");
+    // A tint of 255 changes nothing, and a tint of 0 clears the channel:
+    pixel = 0x12345678;
+    FFG_PixelOps::tint(&pixel, 1, SDL_PIXELFORMAT_ARGB8888, 255, 0, 255, 255);
+    check(pixel == 0x12340078, "tint known value");
+    // Half red over opaque blue:
+    Uint32 source = 0x80FF0000;
+    pixel = 0xFF0000FF;
+    FFG_PixelOps::blend(&source, &pixel, 1, SDL_PIXELFORMAT_ARGB8888);
+    check(pixel == 0xFF80007F, "blend known value");
+    // Swapping red and blue, and filling alpha when the source lacks it:
+    pixel = 0x00112233;
+    FFG_PixelOps::convert(&pixel, &pixel, 1, SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_ABGR8888);
+    check(pixel == 0xFF332211, "convert known value");
+    // Formats without 8 bit channels are refused:
+    check(!FFG_PixelOps::supports(SDL_PIXELFORMAT_RGB565) && FFG_PixelOps::tint(&pixel, 1, SDL_PIXELFORMAT_RGB565, 0, 0, 0, 0), "unsupported format");
+}
+
+void test_against_scalar() {
+    const std::vector<Uint32> pixels = random_pixels();
+    const std::vector<Uint32> under = random_pixels();
+    for (int f = 0; f < NUM_FORMATS; f++) {
+        const Uint32 format = FORMATS[f];
+        const std::string format_name = SDL_GetPixelFormatName(format);
+        compare("tint " + format_name, pixels, [format](std::vector<Uint32>& p) {
+            FFG_PixelOps::tint(p.data(), p.size(), format, 200, 100, 50, 128);
+        });
+        compare("premultiply " + format_name, pixels, [format](std::vector<Uint32>& p) {
+            FFG_PixelOps::premultiply(p.data(), p.size(), format);
+        });
+        compare("blend " + format_name, under, [format, &pixels](std::vector<Uint32>& p) {
+            FFG_PixelOps::blend(pixels.data(), p.data(), p.size(), format);
+        });
+        for (int t = 0; t < NUM_FORMATS; t++) {
+            const Uint32 to = FORMATS[t];
+            compare("convert " + format_name + " to " + SDL_GetPixelFormatName(to), pixels, [format, to](std::vector<Uint32>& p) {
+                FFG_PixelOps::convert(p.data(), p.data(), p.size(), format, to);
+            });
+        }
+    }
+}
+
+void test_round_trip() {
+    const std::vector<Uint32> pixels = random_pixels();
+    std::vector<Uint32> converted(pixels.size());
+    std::vector<Uint32> back(pixels.size());
+    FFG_PixelOps::set_simd_level(FFG_SIMD_AVX2);
+    FFG_PixelOps::convert(pixels.data(), converted.data(), pixels.size(), SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ABGR8888);
+    FFG_PixelOps::convert(converted.data(), back.data(), pixels.size(), SDL_PIXELFORMAT_ABGR8888, SDL_PIXELFORMAT_ARGB8888);
+    check(back == pixels, "convert round trip");
+}
+
+int main(int argc, char **argv) {
+    std::srand(RANDOM_SEED);
+    const FFG_SimdLevel supported = FFG_PixelOps::simd_level();
+    std::cout << "Supported SIMD level: " << LEVEL_NAMES[supported] << std::endl;
+    test_known_values();
+    test_against_scalar();
+    test_round_trip();
+    FFG_PixelOps::set_simd_level(supported);
+    std::cout << failures << " failure(s)." << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "FFG.hpp"
+
+#define RANDOM_SEED 12345
+#define NUM_STEPS 20000
+// Smaller than the number of objects some queries find, to test truncation:
+#define MAX_RESULTS 16
+#define GUARD_ID 0xFFFFFFFF
+
+int failures = 0;
+
+void check(bool passed, const std::string& name) {
+    if (!passed) failures++;
+    std::cout << (passed ? "PASS: " : "FAIL: ") << name << std::endl;
+}
+
+int random_int(int low, int high) {
+    return low + std::rand() % (high - low + 1);
+}
+
+// Mostly small objects, with some large, empty and very large ones, partly
+// outside the quadtrees' worlds:
+FFG_Rect random_rect() {
+    FFG_Rect rect = { random_int(-300, 1300), random_int(-300, 1300), random_int(1, 64), random_int(1, 64) };
+    const int kind = std::rand() % 20;
+    if (kind < 3) {
+        rect.w = random_int(64, 600);
+        rect.h = random_int(64, 600);
+    } else if (kind < 5) {
+        if (std::rand() % 2) rect.w = 0; else rect.h = random_int(-5, 0);
+    } else if (kind < 6) {
+        rect.w = random_int(600, 5000);
+        rect.h = random_int(600, 5000);
+    }
+    return rect;
+}
+
+// The brute force versions of the queries, testing every object:
+class BruteForce {
+public:
+    std::vector<FFG_Rect> bounds;
+    std::vector<bool> used;
+    static bool empty(const FFG_Rect& b) {
+        return b.w <= 0 || b.h <= 0;
+    }
+    template <typename Match>
+    std::vector<unsigned int> find(Match match) const {
+        std::vector<unsigned int> found;
+        for (unsigned int id = 0; id < bounds.size(); id++) {
+            if (used[id] && !empty(bounds[id]) && match(bounds[id])) found.push_back(id);
+        }
+        return found;
+    }
+    std::vector<unsigned int> query_rect(const FFG_Rect& a) const {
+        if (empty(a)) return {};
+        return find([&a](const FFG_Rect& b) {
+            return b.x < a.x + a.w && a.x < b.x + b.w && b.y < a.y + a.h && a.y < b.y + b.h;
+        });
+    }
+    std::vector<unsigned int> query_point(int x, int y) const {
+        return find([x, y](const FFG_Rect& b) {
+            return x >= b.x && x < b.x + b.w && y >= b.y && y < b.y + b.h;
+        });
+    }
+    std::vector<unsigned int> query_radius(int x, int y, int radius) const {
+        if (radius < 0) return {};
+        return find([x, y, radius](const FFG_Rect& b) {
+            const long long dx = x - std::min(std::max(x, b.x), b.x + b.w - 1);
+            const long long dy = y - std::min(std::max(y, b.y), b.y + b.h - 1);
+            return dx * dx + dy * dy <= (long long)radius * radius;
+        });
+    }
+};
+
+// Compares a query's results against the brute force ones, first with room
+// for every result, then with a buffer too small for them:
+template <typename Query>
+bool matches(const std::vector<unsigned int>& expected, Query query) {
+    std::vector<unsigned int> results(expected.size() + 1, GUARD_ID);
+    const unsigned int count = query(results.data(), expected.size());
+    if (count != expected.size() || results.back() != GUARD_ID) return false;
+    results.pop_back();
+    std::sort(results.begin(), results.end());
+    if (results != expected) return false;
+    if (expected.size() <= MAX_RESULTS) return true;
+    results.assign(MAX_RESULTS + 1, GUARD_ID);
+    if (query(results.data(), MAX_RESULTS) != expected.size() || results.back() != GUARD_ID) return false;
+    // Each object is still reported at most once:
+    results.pop_back();
+    std::sort(results.begin(), results.end());
+    return std::adjacent_find(results.begin(), results.end()) == results.end() && std::includes(expected.begin(), expected.end(), results.begin(), results.end());
+}
+
+void test_index(const std::string& name, FFG_SpatialIndex& index) {
+    BruteForce brute;
+    int bad_ids = 0;
+    int bad_updates = 0;
+    int bad_rects = 0;
+    int bad_points = 0;
+    int bad_radii = 0;
+    unsigned int live = 0;
+    for (int step = 0; step < NUM_STEPS; step++) {
+        const int action = std::rand() % 10;
+        // Grow to a few hundred objects, then hover around that:
+        if (action < 2 || live < 50) {
+            const FFG_Rect rect = random_rect();
+            const unsigned int id = index.insert(rect);
+            if (id < brute.used.size() && brute.used[id]) bad_ids++;
+            if (id >= brute.bounds.size()) {
+                brute.bounds.resize(id + 1);
+                brute.used.resize(id + 1, false);
+            }
+            brute.bounds[id] = rect;
+            brute.used[id] = true;
+            live++;
+        } else if (action < 4) {
+            const unsigned int id = std::rand() % brute.bounds.size();
+            FFG_Rect rect = random_rect();
+            // Often a small step, as objects usually move:
+            if (brute.used[id] && std::rand() % 2) {
+                rect = brute.bounds[id];
+                rect.x += random_int(-40, 40);
+                rect.y += random_int(-40, 40);
+            }
+            if (index.move(id, rect) != !brute.used[id]) bad_updates++;
+            if (brute.used[id]) brute.bounds[id] = rect;
+        } else if (action < 5 && live > 300) {
+            const unsigned int id = std::rand() % brute.bounds.size();
+            if (index.remove(id) != !brute.used[id]) bad_updates++;
+            if (brute.used[id]) live--;
+            brute.used[id] = false;
+        } else if (action < 7) {
+            const FFG_Rect area = (std::rand() % 4) ? random_rect() : FFG_Rect { random_int(-2000, 0), random_int(-2000, 0), random_int(0, 5000), random_int(0, 5000) };
+            if (!matches(brute.query_rect(area), [&](unsigned int* results, unsigned int max) { return index.query_rect(area, results, max); })) bad_rects++;
+        } else if (action < 8) {
+            const int x = random_int(-300, 1300);
+            const int y = random_int(-300, 1300);
+            if (!matches(brute.query_point(x, y), [&](unsigned int* results, unsigned int max) { return index.query_point(x, y, results, max); })) bad_points++;
+        } else {
+            const int x = random_int(-300, 1300);
+            const int y = random_int(-300, 1300);
+            const int radius = random_int(-1, 300);
+            if (!matches(brute.query_radius(x, y, radius), [&](unsigned int* results, unsigned int max) { return index.query_radius(x, y, radius, results, max); })) bad_radii++;
+        }
+        if (index.size() != live) bad_updates++;
+    }
+    check(bad_ids == 0, name + " gives unused IDs");
+    check(bad_updates == 0, name + " moves and removes");
+    check(bad_rects == 0, name + " rect queries");
+    check(bad_points == 0, name + " point queries");
+    check(bad_radii == 0, name + " radius queries");
+    index.clear();
+    unsigned int found = index.query_rect({ -10000, -10000, 20000, 20000 }, nullptr, 0);
+    check(index.size() == 0 && found == 0, name + " clear");
+}
+
+int main(int argc, char **argv) {
+    std::srand(RANDOM_SEED);
+    FFG_SpatialGrid grid;
+    test_index("grid", grid);
+    // Few buckets, so cells collide and large objects and areas overflow:
+    FFG_SpatialGrid small_grid(32, 64);
+    test_index("small grid", small_grid);
+    FFG_QuadTree tree({ 0, 0, 1024, 1024 });
+    test_index("quadtree", tree);
+    // A world that does not divide evenly, and is offset from the origin:
+    FFG_QuadTree odd_tree({ -100, 50, 1000, 700 }, FFG_QUADTREE_MAX_DEPTH);
+    test_index("odd quadtree", odd_tree);
+    FFG_QuadTree root_tree({ 0, 0, 1024, 1024 }, 0);
+    test_index("root only quadtree", root_tree);
+    std::cout << failures << " failure(s)." << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,139 @@
+// Builds an FFG_Pack from files on disk. See FFG_Pack for the format.
+//
+// Usage:
+//     ffg_pack [--raw] [--lz4] <output> <file>...
+//
+// Each file is stored under its path as given, with '\' replaced by '/', so
+// run the tool from the directory the game's asset paths are relative to.
+//
+// With --raw, .png files are decoded and stored as raw images in ARGB8888, the
+// format most renderers use natively, so they load with no decoding. With
+// --lz4 as well, their pixels are compressed with LZ4. See FFG_RawImage.
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "FFG_Pack.hpp"
+#include "FFG_RawImage.hpp"
+
+struct PackEntry {
+    std::string name;
+    std::vector<char> bytes;
+    Uint64 hash;
+    Uint64 offset;
+};
+
+static void write_32(std::vector<char>& out, Uint64 at, Uint32 value) {
+    for (int i = 0; i < 4; i++) out[at + i] = (char)((value >> (8 * i)) & 0xFF);
+}
+
+static void write_64(std::vector<char>& out, Uint64 at, Uint64 value) {
+    write_32(out, at, (Uint32)value);
+    write_32(out, at + 4, (Uint32)(value >> 32));
+}
+
+static bool ends_with(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static bool convert_raw(const char* path, bool compress, std::vector<char>& bytes) {
+    SDL_Surface* loaded = IMG_Load(path);
+    if (!loaded) return true;
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(loaded);
+    if (!converted) return true;
+    std::vector<Uint8> raw;
+    const bool failed = FFG_RawImage::encode(converted, compress, raw);
+    SDL_FreeSurface(converted);
+    bytes.assign(raw.begin(), raw.end());
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    bool raw = false;
+    bool lz4 = false;
+    int first = 1;
+    for (; first < argc; first++) {
+        const std::string option = argv[first];
+        if (option == "--raw") {
+            raw = true;
+        } else if (option == "--lz4") {
+            lz4 = true;
+        } else {
+            break;
+        }
+    }
+    if (first >= argc) {
+        std::cerr << "Usage: ffg_pack [--raw] [--lz4] <output> <file>..." << std::endl;
+        return 1;
+    }
+    const char* output = argv[first];
+    // Read every file:
+    std::vector<PackEntry> entries;
+    for (int i = first + 1; i < argc; i++) {
+        PackEntry entry;
+        entry.name = argv[i];
+        for (char& c : entry.name) {
+            if (c == '\\') c = '/';
+        }
+        if (raw && ends_with(entry.name, ".png")) {
+            if (convert_raw(argv[i], lz4, entry.bytes)) {
+                std::cerr << "Failed to convert " << argv[i] << "." << std::endl;
+                return 1;
+            }
+        } else {
+            std::ifstream file(argv[i], std::ios::binary);
+            if (!file) {
+                std::cerr << "Failed to read " << argv[i] << "." << std::endl;
+                return 1;
+            }
+            entry.bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        entry.hash = FFG_Pack::hash(entry.name);
+        for (const PackEntry& other : entries) {
+            if (other.hash != entry.hash) continue;
+            std::cerr << (other.name == entry.name ? "Duplicate entry " : "Hash collision between ") << other.name << " and " << entry.name << "." << std::endl;
+            return 1;
+        }
+        entries.push_back(entry);
+    }
+    // Keep the table at most half full, so probes stay short:
+    Uint32 capacity = 1;
+    while (capacity < 2 * entries.size()) capacity *= 2;
+    // Lay out the data after the table:
+    Uint64 end = FFG_PACK_HEADER_SIZE + (Uint64)capacity * FFG_PACK_SLOT_SIZE;
+    for (PackEntry& entry : entries) {
+        end = (end + FFG_PACK_ALIGNMENT - 1) / FFG_PACK_ALIGNMENT * FFG_PACK_ALIGNMENT;
+        entry.offset = end;
+        end += entry.bytes.size();
+    }
+    std::vector<char> out(end, 0);
+    out[0] = FFG_PACK_MAGIC[0];
+    out[1] = FFG_PACK_MAGIC[1];
+    out[2] = FFG_PACK_MAGIC[2];
+    out[3] = FFG_PACK_MAGIC[3];
+    write_32(out, 4, FFG_PACK_VERSION);
+    write_32(out, 8, entries.size());
+    write_32(out, 12, capacity);
+    std::vector<bool> used(capacity, false);
+    for (const PackEntry& entry : entries) {
+        Uint32 slot = (Uint32)entry.hash & (capacity - 1);
+        while (used[slot]) slot = (slot + 1) & (capacity - 1);
+        used[slot] = true;
+        const Uint64 at = FFG_PACK_HEADER_SIZE + (Uint64)slot * FFG_PACK_SLOT_SIZE;
+        write_64(out, at, entry.hash);
+        write_64(out, at + 8, entry.offset);
+        write_64(out, at + 16, entry.bytes.size());
+        std::copy(entry.bytes.begin(), entry.bytes.end(), out.begin() + entry.offset);
+    }
+    std::ofstream file(output, std::ios::binary);
+    if (!file.write(out.data(), out.size())) {
+        std::cerr << "Failed to write " << output << "." << std::endl;
+        return 1;
+    }
+    std::cout << "Packed " << entries.size() << " files into " << output << "." << std::endl;
+    return 0;
+}